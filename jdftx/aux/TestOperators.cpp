@@ -17,20 +17,26 @@ You should have received a copy of the GNU General Public License
 along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 -------------------------------------------------------------------*/
 
+#include <electronic/Everything.h>
 #include <electronic/SpeciesInfo.h>
+#include <electronic/RealSpaceProjectors.h>
 #include <electronic/ColumnBundle.h>
+#include <electronic/SpeciesInfo_internal.h>
 #include <electronic/ExCorr_internal_GGA.h>
 #include <core/Util.h>
 #include <core/Operators.h>
+#include <core/ScalarFieldExpr.h>
 #include <core/ScalarFieldIO.h>
 #include <core/Coulomb.h>
 #include <core/LatticeUtils.h>
 #include <core/Random.h>
 #include <core/SphericalHarmonics.h>
 #include <core/Blip.h>
+#include <commands/parser.h>
 #include <fluid/SO3quad.h>
 #include <gsl/gsl_sf.h>
 #include <stdlib.h>
+#include <cfloat>
 
 class OperatorTest
 {	const GridInfo& gInfo;
@@ -317,11 +323,6 @@ void testYlmDeriv()
 
 void testVnlPrime()
 {
-	//Forward declaration from SpeciesInfo_internal.h:
-	void Vnl(int nbasis, int atomStride, int nAtoms, int l, int m, const vector3<> k, const vector3<int>* iGarr,
-		const matrix3<> G, const vector3<>* pos, const RadialFunctionG& VnlRadial, complex* Vnl,
-		const vector3<>* derivDir=0, const int stressDir=-1);
-	
 	vector3<> k(0.25, 0.1, 0.3);
 	vector3<int> iG(1, -1, 0);
 	matrix3<> R(3.,1.,0., -2.,4.,1., 0.,2.,5.);
@@ -349,6 +350,188 @@ void testVnlPrime()
 	}
 }
 
+//Compare separable structure-factor tables (used in Vnl, getSG and nAugment on the CPU) against direct sincos evaluation
+void testStructureFactors()
+{	//Random atoms in a skewed cell:
+	const int nAtoms = 256;
+	matrix3<> R(12.,1.,0., -2.,13.,1., 0.,2.,14.);
+	matrix3<> G = 2*M_PI*inv(R);
+	std::vector< vector3<> > pos(nAtoms);
+	for(vector3<>& p: pos) for(int dir=0; dir<3; dir++) p[dir] = Random::uniform(-0.5, 0.5);
+	vector3<> k(0.25, 0.1, 0.3);
+	//Sphere of G-vectors:
+	std::vector< vector3<int> > iGarr;
+	const int iGmax = 10;
+	for(int i0=-iGmax; i0<=iGmax; i0++)
+	for(int i1=-iGmax; i1<=iGmax; i1++)
+	for(int i2=-iGmax; i2<=iGmax; i2++)
+		if(i0*i0 + i1*i1 + i2*i2 <= iGmax*iGmax)
+			iGarr.push_back(vector3<int>(i0,i1,i2));
+	int nbasis = iGarr.size();
+	
+	//Projectors, their k-derivatives and stress components:
+	RadialFunctionG Vradial;
+	Vradial.init(2, 0.02, 20., RadialFunctionG::cusplessExpTilde, -8., 0.1);
+	vector3<> derivDir(0.7, 0.2, -0.5);
+	const vector3<> RTdir = (2*M_PI)*(derivDir * inv(G));
+	const char* modeName[3] = { "Vnl", "VnlPrime", "VnlStress" };
+	for(int mode=0; mode<3; mode++)
+	{	std::vector<complex> Vtable(nbasis*nAtoms), Vdirect(nbasis*nAtoms);
+		TIME("Tabulated", globalLog,
+			Vnl(nbasis, nbasis, nAtoms, 2, 1, k, iGarr.data(), G, pos.data(), Vradial, Vtable.data(), mode==1 ? &derivDir : 0, mode==2 ? 4 : -1);
+		)
+		TIME("Direct", globalLog,
+			switch(mode)
+			{	case 0: threadedLoop(Vnl_calc<2,1>, nbasis, nbasis, nAtoms, k, iGarr.data(), G, pos.data(), Vradial, Vdirect.data()); break;
+				case 1: threadedLoop(VnlPrime_calc<2,1>, nbasis, nbasis, nAtoms, k, iGarr.data(), G, pos.data(), Vradial, derivDir, RTdir, Vdirect.data()); break;
+				case 2: threadedLoop(VnlStress_calc<2,1>, nbasis, nbasis, nAtoms, k, iGarr.data(), G, pos.data(), Vradial, 1, 1, Vdirect.data()); break;
+			}
+		)
+		double errSq = 0., normSq = 0.;
+		for(size_t i=0; i<Vtable.size(); i++)
+		{	errSq += (Vtable[i]-Vdirect[i]).norm();
+			normSq += Vdirect[i].norm();
+		}
+		double err = sqrt(errSq/normSq);
+		logPrintf("%s relError: %le%s\n", modeName[mode], err, (err>1e-12 ? " ERR" : ""));
+	}
+	Vradial.free();
+	
+	//Structure factor on a grid:
+	vector3<int> S(48, 48, 56);
+	size_t nG = S[0]*S[1]*(S[2]/2+1);
+	std::vector<complex> SGtable(nG), SGdirect(nG);
+	TIME("Tabulated", globalLog,
+		getSG(S, nAtoms, pos.data(), 1., SGtable.data());
+	)
+	double errSq = 0., normSq = 0.;
+	size_t iStart=0, iStop=nG;
+	THREAD_halfGspaceLoop(
+		SGdirect[i] = getSG_calc(iG, nAtoms, pos.data());
+		errSq += (SGtable[i]-SGdirect[i]).norm();
+		normSq += SGdirect[i].norm();
+	)
+	double err = sqrt(errSq/normSq);
+	logPrintf("getSG relError: %le%s\n", err, (err>1e-12 ? " ERR" : ""));
+}
+
+//Set up two atoms of an ultrasoft species (several projectors per l) in a skewed cell at a general k-point, with random wavefunctions:
+void setupSpeciesTest(Everything& e)
+{	std::vector< std::pair<string,string> > input;
+	input.push_back(std::make_pair("lattice", "9. 1. 0.  -1. 10. 1.  0. 2. 11."));
+	input.push_back(std::make_pair("ion-species", "GBRV/$ID_pbe.uspp"));
+	input.push_back(std::make_pair("elec-cutoff", "20 100"));
+	input.push_back(std::make_pair("ion", "O 0.10 0.20 0.30 0"));
+	input.push_back(std::make_pair("ion", "O 0.35 0.30 0.25 0"));
+	input.push_back(std::make_pair("kpoint", "0.25 0.1 0.3 1."));
+	input.push_back(std::make_pair("symmetries", "none"));
+	input.push_back(std::make_pair("core-overlap-check", "none"));
+	parse(input, e);
+	e.eVars.initLCAO = false;
+	e.setup();
+}
+
+//Compare real-space projections (masked-function method) to reciprocal-space ones, and check their gradients by finite differences
+void testRealSpaceProjectors()
+{	Everything e; setupSpeciesTest(e);
+	SpeciesInfo& sp = *(e.iInfo.species[0]);
+	const ColumnBundle& C = e.eVars.C[0];
+	const RealSpaceProjectors* rsp = sp.getRealSpaceProjectors(*(C.basis->gInfo));
+	if(!rsp) { logPrintf("Real-space projectors unavailable for species %s.\n", sp.name.c_str()); return; }
+	std::vector<const RealSpaceProjectors*> rspArr(1, rsp);
+	
+	//Projections (differ from reciprocal space only by the masked filtering, expected ~1e-4 relative):
+	std::vector<matrix> VdagC; RealSpaceProjectors::project(C, rspArr, VdagC);
+	matrix VdagCref = (*sp.getV(C)) ^ C;
+	double err = nrm2(VdagC[0] - VdagCref) / nrm2(VdagCref);
+	logPrintf("RealSpaceProjectors::project relError: %le%s\n", err, (err>1e-3 ? " ERR" : ""));
+	
+	//Gradient of Re tr(H^ VdagC) w.r.t C from projectGrad (exact up to roundoff, since linear):
+	auto getE = [&](const ColumnBundle& Ccur, const matrix& H)
+	{	std::vector<matrix> VdagCcur; RealSpaceProjectors::project(Ccur, rspArr, VdagCcur);
+		return trace(dagger(H) * VdagCcur[0]).real();
+	};
+	matrix H(VdagC[0].nRows(), VdagC[0].nCols()); randomize(H);
+	ColumnBundle E_C = C.similar(); E_C.zero();
+	RealSpaceProjectors::projectGrad(rspArr, std::vector<matrix>(1, H), E_C);
+	ColumnBundle dC = C.similar(); randomize(dC);
+	const double h = 1e-3;
+	double dEnum = (getE(C + h*dC, H) - getE(C - h*dC, H)) / (2*h);
+	double dEana = trace(E_C ^ dC).real();
+	err = fabs(dEnum - dEana) / fabs(dEana);
+	logPrintf("RealSpaceProjectors::projectGrad relError: %le%s\n", err, (err>1e-10 ? " ERR" : ""));
+	
+	//Cartesian derivatives w.r.t. atom position (DVdagC = -d(VdagC)/dx, since projectors depend on r - x):
+	matrix DVdagC[3]; rsp->projectDeriv(C, DVdagC);
+	const int atom = 1, nProjAtom = rsp->nProjectors() / sp.atpos.size();
+	const vector3<> atpos0 = sp.atpos[atom];
+	double errSq = 0., normSq = 0.;
+	for(int k=0; k<3; k++)
+	{	matrix VdagCpm[2];
+		for(int iPM=0; iPM<2; iPM++)
+		{	vector3<> dx; dx[k] = (iPM ? h : -h);
+			sp.atpos[atom] = atpos0 + e.gInfo.invR * dx;
+			RealSpaceProjectors rspCur(sp, *(C.basis->gInfo), e.cntrl.realSpaceProjectorsRcut);
+			std::vector<matrix> VdagCcur; RealSpaceProjectors::project(C, std::vector<const RealSpaceProjectors*>(1, &rspCur), VdagCcur);
+			VdagCpm[iPM] = VdagCcur[0](atom*nProjAtom,(atom+1)*nProjAtom, 0,C.nCols());
+		}
+		matrix DVdagCnum = (-0.5/h) * (VdagCpm[1] - VdagCpm[0]);
+		matrix DVdagCana = DVdagC[k](atom*nProjAtom,(atom+1)*nProjAtom, 0,C.nCols());
+		errSq += pow(nrm2(DVdagCnum - DVdagCana), 2);
+		normSq += pow(nrm2(DVdagCana), 2);
+	}
+	sp.atpos[atom] = atpos0;
+	err = sqrt(errSq/normSq);
+	logPrintf("RealSpaceProjectors::projectDeriv relError: %le%s\n", err, (err>1e-4 ? " ERR" : ""));
+}
+
+//Compare real-space ultrasoft augmentation (masked-function method) to the reciprocal-space version:
+//the augmentation density, and the gradient propagation of a potential to the projections and forces
+void testRealSpaceAugmentation()
+{	Everything e; setupSpeciesTest(e);
+	//Spherical augmentation coefficients from the random wavefunctions:
+	std::vector<matrix> VdagC;
+	e.iInfo.augmentDensityInit();
+	e.iInfo.project(e.eVars.C[0], VdagC);
+	e.iInfo.augmentDensitySpherical(e.eInfo.qnums[0], e.eVars.F[0], VdagC);
+	//Random potential (plays the role of Vscloc):
+	ScalarFieldArray E_n; nullToZero(E_n, e.gInfo, e.eInfo.nDensities);
+	initRandomFlat(E_n);
+	
+	ScalarFieldArray n[2]; IonicGradient forces[2]; std::vector<matrix> HVdagC[2];
+	for(int iRS=0; iRS<2; iRS++) //reciprocal, real space
+	{	e.cntrl.realSpaceAugmentation = iRS;
+		nullToZero(n[iRS], e.gInfo, e.eInfo.nDensities);
+		e.iInfo.augmentDensityGrid(n[iRS]);
+		forces[iRS].init(e.iInfo);
+		e.iInfo.augmentDensityGridGrad(E_n, &forces[iRS]);
+		HVdagC[iRS].resize(VdagC.size());
+		for(unsigned sp=0; sp<VdagC.size(); sp++)
+			if(VdagC[sp]) HVdagC[iRS][sp] = zeroes(VdagC[sp].nRows(), VdagC[sp].nCols());
+		e.iInfo.augmentDensitySphericalGrad(e.eInfo.qnums[0], VdagC, HVdagC[iRS]);
+	}
+	
+	//Relative differences (expected ~1e-4 due to the masked filtering):
+	double errSq = 0., normSq = 0.;
+	for(unsigned s=0; s<n[0].size(); s++)
+	{	errSq += pow(nrm2(n[1][s] - n[0][s]), 2);
+		normSq += pow(nrm2(n[0][s]), 2);
+	}
+	double err = sqrt(errSq/normSq);
+	logPrintf("Real-space augmentDensityGrid relError: %le%s\n", err, (err>1e-3 ? " ERR" : ""));
+	errSq = 0.; normSq = 0.;
+	for(unsigned sp=0; sp<VdagC.size(); sp++)
+		if(VdagC[sp])
+		{	errSq += pow(nrm2(HVdagC[1][sp] - HVdagC[0][sp]), 2);
+			normSq += pow(nrm2(HVdagC[0][sp]), 2);
+		}
+	err = sqrt(errSq/normSq);
+	logPrintf("Real-space augmentDensityGridGrad (projections) relError: %le%s\n", err, (err>1e-3 ? " ERR" : ""));
+	IonicGradient forcesErr = forces[1] - forces[0];
+	err = sqrt(dot(forcesErr, forcesErr) / dot(forces[0], forces[0]));
+	logPrintf("Real-space augmentDensityGridGrad (forces) relError: %le%s\n", err, (err>1e-3 ? " ERR" : ""));
+}
+
 void fdtest2D(double F(double,double,double&,double&), const char* name)
 {	double A = 1.23856;
 	double B = 3.104262;
@@ -408,6 +591,144 @@ void testChangeGrid()
 	logPrintf("\n--------- x3 --------\n"); print(x3);
 }
 
+void testFieldExpr()
+{	GridInfo gInfo;
+	gInfo.S = vector3<int>(200, 200, 200);
+	gInfo.R = matrix3<>(10,10,10);
+	gInfo.initialize();
+	ScalarField E, Ecomb;
+	nullToZero(E, gInfo); initRandomFlat(E); E += 0.1;
+	nullToZero(Ecomb, gInfo); initRandomFlat(Ecomb);
+	E *= 2.; //check handling of pending scale factors
+	for(int iRep=0; iRep<3; iRep++)
+	{	double tStart = clock_us();
+		ScalarField y1 = inv(E) * (Ecomb + sqrt(Ecomb*Ecomb + 3.*E));
+		double tMid = clock_us();
+		ScalarField y2 = inv(lazy(E)) * (Ecomb + sqrt(lazy(Ecomb)*Ecomb + 3.*E));
+		double tStop = clock_us();
+		y1 -= lazy(y2) * 0.5; y1 -= 0.5*y2; //test updates
+		logPrintf("Unfused: %.1lf ms  Fused: %.1lf ms  Relative error: %le\n",
+			1e-3*(tMid-tStart), 1e-3*(tStop-tMid), nrm2(y1)/nrm2(y2));
+	}
+}
+
+#ifdef SIMD_ENABLED
+//Maximum error in ulps of vectorized elementary function fSimd relative to fScalar for arguments logarithmically distributed in [xMin,xMax]
+template<typename SimdFunc, typename ScalarFunc> double simdMaxUlpError(SimdFunc fSimd, ScalarFunc fScalar, double xMin, double xMax)
+{	const int W = simdDouble::width;
+	double x[W], f[W], maxErr = 0.;
+	for(int i=0; i<(1<<20); i++)
+	{	for(int j=0; j<W; j++) x[j] = xMin * pow(xMax/xMin, Random::uniform());
+		fSimd(simdDouble::load(x)).store(f);
+		for(int j=0; j<W; j++)
+		{	double fExact = fScalar(x[j]);
+			maxErr = std::max(maxErr, fabs(f[j]-fExact) / (fabs(fExact)*DBL_EPSILON));
+		}
+	}
+	return maxErr;
+}
+#endif
+
+//Compare vectorized and scalar evaluation of a spin-polarized GGA (templated over spinScaling version)
+template<GGA_Variant variant, bool spinScaling> void testXCsimd(const char* name)
+{
+	#ifdef SIMD_ENABLED
+	//Accuracy of elementary functions (pow error grows as |a log x| ulp due to rounding of a log x):
+	logPrintf("Max error [ulp]: exp(+/-x) x in [1e-3,700]: %.1lf %.1lf  log(x) x in [1e-300,1e300]: %.1lf\n",
+		simdMaxUlpError([](simdDouble x){ return exp(x); }, [](double x){ return exp(x); }, 1e-3, 700.),
+		simdMaxUlpError([](simdDouble x){ return exp(-x); }, [](double x){ return exp(-x); }, 1e-3, 700.),
+		simdMaxUlpError([](simdDouble x){ return log(x); }, [](double x){ return log(x); }, 1e-300, 1e300));
+	for(double a: { -1./3, 1./3, 4./3, 2. })
+		logPrintf("Max error [ulp]: pow(x,%+.3lf) x in [1e-12,1e4]: %.1lf\n", a,
+			simdMaxUlpError([a](simdDouble x){ return pow(x,a); }, [a](double x){ return pow(x,a); }, 1e-12, 1e4));
+	//Accuracy and timing of functional:
+	const int N = 1<<22;
+	std::vector<double> nData[2], sigmaData[3], E[2], E_n[2][2], E_sigma[2][3];
+	for(int s=0; s<2; s++) { nData[s].resize(N); for(double& x: nData[s]) x = pow(10., Random::uniform(-8., 1.)); }
+	for(int s=0; s<3; s++) { sigmaData[s].resize(N); for(double& x: sigmaData[s]) x = (s==1 ? 0.3 : 1.) * pow(10., Random::uniform(-8., 1.)); }
+	double tElapsed[2];
+	for(int iSimd=0; iSimd<2; iSimd++)
+	{	E[iSimd].assign(N, 0.);
+		array<const double*,2> n; array<double*,2> nGrad;
+		array<const double*,3> sigma; array<double*,3> sigmaGrad;
+		for(int s=0; s<2; s++) { n[s] = nData[s].data(); E_n[iSimd][s].assign(N, 0.); nGrad[s] = E_n[iSimd][s].data(); }
+		for(int s=0; s<3; s++) { sigma[s] = sigmaData[s].data(); E_sigma[iSimd][s].assign(N, 0.); sigmaGrad[s] = E_sigma[iSimd][s].data(); }
+		double tStart = clock_us();
+		if(iSimd) GGA_calc_simd<variant,spinScaling,2>::compute(0, N, n, sigma, E[iSimd].data(), nGrad, sigmaGrad, 1.);
+		else for(int i=0; i<N; i++) GGA_calc<variant,spinScaling,2>::compute(i, n, sigma, E[iSimd].data(), nGrad, sigmaGrad, 1.);
+		tElapsed[iSimd] = clock_us() - tStart;
+	}
+	double errE = 0., errEn = 0., normE = 0., normEn = 0.;
+	for(int i=0; i<N; i++)
+	{	errE += std::pow(E[1][i]-E[0][i], 2); normE += std::pow(E[0][i], 2);
+		errEn += std::pow(E_n[1][0][i]-E_n[0][0][i], 2); normEn += std::pow(E_n[0][0][i], 2);
+	}
+	double relErrE = sqrt(errE/normE), relErrEn = sqrt(errEn/normEn);
+	logPrintf("%s: scalar %.1lf ms  SIMD(%d) %.1lf ms  Relative error: E %le  E_n %le%s\n", name,
+		1e-3*tElapsed[0], simdDouble::width, 1e-3*tElapsed[1], relErrE, relErrEn, (std::max(relErrE,relErrEn)>1e-12 ? " ERR" : ""));
+	#else
+	logPrintf("%s: SIMD evaluation not available in this build.\n", name);
+	#endif
+}
+
+//Microbenchmark the eblas kernels used in density accumulation, getColumn/setColumn and symmetrization
+//against plain scalar loops (equivalent to their original implementations), both on a single thread
+void testEblas()
+{	suspendOperatorThreading();
+	const int N = 1<<20, nRepeat = 20, nSym = 8;
+	std::vector<complex> x(N), xC(N), z(N), zRef(N);
+	std::vector<double> y(N), yRef(N), yIm(N), yImRef(N);
+	std::vector<int> index(N), symmIndex(N);
+	for(int i=0; i<N; i++)
+	{	x[i] = Random::normalComplex();
+		xC[i] = Random::normalComplex();
+		index[i] = i;
+	}
+	for(int i=N-1; i>0; i--) std::swap(index[i], index[Random::uniformInt(i+1)]); //random permutation: worst-case access pattern
+	symmIndex = index;
+	auto report = [](const char* name, double tRef, double t, double err)
+	{	logPrintf("%-12s scalar: %7.2lf ms  eblas: %7.2lf ms  speedup: %.2lf  max error: %le\n",
+			name, 1e-3*tRef, 1e-3*t, tRef/t, err);
+	};
+	auto maxErr = [](const std::vector<double>& a, const std::vector<double>& b)
+	{	double err = 0.; for(size_t i=0; i<a.size(); i++) err = std::max(err, fabs(a[i]-b[i])); return err; };
+	auto maxErrC = [](const std::vector<complex>& a, const std::vector<complex>& b)
+	{	double err = 0.; for(size_t i=0; i<a.size(); i++) err = std::max(err, (a[i]-b[i]).abs()); return err; };
+	double t0, tRef, t;
+	//accumNorm:
+	t0 = clock_us(); for(int r=0; r<nRepeat; r++) for(int i=0; i<N; i++) yRef[i] += 0.5 * x[i].norm(); tRef = clock_us()-t0;
+	t0 = clock_us(); for(int r=0; r<nRepeat; r++) eblas_accumNorm(N, 0.5, x.data(), y.data()); t = clock_us()-t0;
+	report("accumNorm", tRef, t, maxErr(y, yRef));
+	//accumProd:
+	t0 = clock_us();
+	for(int r=0; r<nRepeat; r++) for(int i=0; i<N; i++) { complex zi = 0.5 * x[i] * xC[i].conj(); yRef[i] += zi.real(); yImRef[i] += zi.imag(); }
+	tRef = clock_us()-t0;
+	t0 = clock_us(); for(int r=0; r<nRepeat; r++) eblas_accumProd(N, 0.5, x.data(), xC.data(), y.data(), yIm.data()); t = clock_us()-t0;
+	report("accumProd", tRef, t, std::max(maxErr(y, yRef), maxErr(yIm, yImRef)));
+	//scatter:
+	t0 = clock_us(); for(int r=0; r<nRepeat; r++) for(int i=0; i<N; i++) zRef[index[i]] += 0.5 * x[i]; tRef = clock_us()-t0;
+	t0 = clock_us(); for(int r=0; r<nRepeat; r++) eblas_scatter_zdaxpy(N, 0.5, index.data(), x.data(), z.data()); t = clock_us()-t0;
+	report("scatter", tRef, t, maxErrC(z, zRef));
+	//gather:
+	t0 = clock_us(); for(int r=0; r<nRepeat; r++) for(int i=0; i<N; i++) zRef[i] += 0.5 * x[index[i]]; tRef = clock_us()-t0;
+	t0 = clock_us(); for(int r=0; r<nRepeat; r++) eblas_gather_zdaxpy(N, 0.5, index.data(), x.data(), z.data()); t = clock_us()-t0;
+	report("gather", tRef, t, maxErrC(z, zRef));
+	//symmetrize:
+	for(int i=0; i<N; i++) { y[i] = yRef[i] = x[i].real(); }
+	t0 = clock_us();
+	for(int r=0; r<nRepeat; r++)
+		for(int i=0; i<N/nSym; i++)
+		{	double ySum = 0.;
+			for(int j=0; j<nSym; j++) ySum += yRef[symmIndex[nSym*i+j]];
+			ySum *= (1./nSym);
+			for(int j=0; j<nSym; j++) yRef[symmIndex[nSym*i+j]] = ySum;
+		}
+	tRef = clock_us()-t0;
+	t0 = clock_us(); for(int r=0; r<nRepeat; r++) eblas_symmetrize(N/nSym, nSym, symmIndex.data(), y.data()); t = clock_us()-t0;
+	report("symmetrize", tRef, t, maxErr(y, yRef));
+	resumeOperatorThreading();
+}
+
 void testHugeFileIO()
 {	matrix M(15000,15000);
 	logPrintf("Testing huge file I/O with %lg GB.\n", pow(0.5,30)*(M.nData()*sizeof(complex)));
@@ -482,8 +803,14 @@ int main(int argc, char** argv)
 	//testYlmProd(); return 0;
 	//testYlmDeriv(); return 0;
 	//testVnlPrime(); return 0;
+	//testStructureFactors(); return 0;
+	//testRealSpaceProjectors(); return 0;
+	//testRealSpaceAugmentation(); return 0;
 	//fdtestGGAs(); return 0;
 	//testChangeGrid(); return 0;
+	//testFieldExpr(); return 0;
+	//testEblas(); return 0;
+	//testXCsimd<GGA_X_PBE,true>("PBE exchange"); testXCsimd<GGA_C_PBE,false>("PBE correlation"); return 0;
 	//testHugeFileIO(); return 0;
 	//testResample(); return 0;
 	testMatrixLinalg(); return 0;
@@ -586,6 +586,8 @@ enum VibrationsMember
 	VM_omegaMin,
 	VM_T,
 	VM_omegaResolution,
+	VM_processGroups,
+	VM_dfpt,
 	VM_Delim
 };
 
@@ -597,7 +599,9 @@ EnumStringMap<VibrationsMember> vibMap
 	VM_rotationSym, "rotationSym",
 	VM_omegaMin, "omegaMin",
 	VM_T, "T",
-	VM_omegaResolution, "omegaResolution"
+	VM_omegaResolution, "omegaResolution",
+	VM_processGroups, "processGroups",
+	VM_dfpt, "dfpt"
 );
 
 struct CommandVibrations : public Command
@@ -606,7 +610,8 @@ struct CommandVibrations : public Command
 	{
 		format = "<key1> <args1> ...";
 		comments =
-			"Calculate vibrational modes of the system using a finite difference method.\n"
+			"Calculate vibrational modes of the system using a finite difference method\n"
+			"(or linear response; see subcommand dfpt below).\n"
 			"Note that this command should typically be issued in a run with converged ionic\n"
 			"positions; ionic (and lattice) minimization are bypassed by the vibrations module.\n"
 			"\n"
@@ -624,6 +629,16 @@ struct CommandVibrations : public Command
 			"+ T <T>: temperature (in Kelvin) for free energy calculation (default: 298)\n"
 			"+ omegaResolution <omegaResolution>: resolution for detecting and reporting degeneracies\n"
 			"   in modes (default: 1e-4). Does not affect free energies and all modes are still printed.\n"
+			"+ processGroups yes|no: distribute the perturbed configurations over the process groups\n"
+			"   set by command-line option -G, each group starting from the converged unperturbed\n"
+			"   wavefunctions (default: no). Not available with exact exchange or fluids.\n"
+			"+ dfpt yes|no: compute the force matrix and dipole derivatives using linear response\n"
+			"   (density-functional perturbation theory \\cite DFPT) instead of finite differences,\n"
+			"   solving a Sternheimer equation for each symmetry-independent displacement (default: no).\n"
+			"   Supported for insulators (integer fillings) with norm-conserving pseudopotentials and\n"
+			"   semi-local functionals, without fluids, DFT+U or spin-orbit. The perturbations are at\n"
+			"   Gamma (in the unit cell); use the phonon code for finite wave-vectors. Options dr and\n"
+			"   centralDiff are not used in this mode.\n"
 			"\n"
 			"Note that for a periodic system with k-points, wave functions may be incompatible\n"
 			"with and without the vibrations command due to symmetry-breaking by the perturbations.\n"
@@ -648,6 +663,8 @@ struct CommandVibrations : public Command
 				case VM_omegaMin: pl.get(e.vibrations->omegaMin, 2e-4, "omegaMin", true); break;
 				case VM_T: pl.get(e.vibrations->T, 298., "T", true); e.vibrations->T *= Kelvin; break;
 				case VM_omegaResolution: pl.get(e.vibrations->omegaResolution, 1e-4, "omegaResolution", true); break;
+				case VM_processGroups: pl.get(e.vibrations->processGroups, false, boolMap, "processGroups", true); break;
+				case VM_dfpt: pl.get(e.vibrations->dfpt, false, boolMap, "dfpt", true); break;
 				case VM_Delim: return; //end of input
 			}
 		}
@@ -663,6 +680,8 @@ struct CommandVibrations : public Command
 		logPrintf("\\\n\tomegaMin %g", e.vibrations->omegaMin);
 		logPrintf("\\\n\tT %g", e.vibrations->T/Kelvin);
 		logPrintf("\\\n\tomegaResolution %g", e.vibrations->omegaResolution);
+		logPrintf("\\\n\tprocessGroups %s", boolMap.getString(e.vibrations->processGroups));
+		logPrintf("\\\n\tdfpt %s", boolMap.getString(e.vibrations->dfpt));
 	}
 }
 commandVibrations;
@@ -19,6 +19,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <commands/command.h>
 #include <electronic/Everything.h>
+#include <electronic/ResultCache.h>
 
 //! @file elec_misc.cpp Miscellaneous properties of the electronic system
 
@@ -235,6 +236,42 @@ commandFixElectronPotential;
 
 //-------------------------------------------------------------------------------------------------
 
+struct CommandBandBatch : public Command
+{
+	CommandBandBatch() : Command("band-batch", "jdftx/Electronic/Optimization")
+	{
+		format = "<batchSize> [<restart>=yes]";
+		comments =
+			"Stream a fixed-Hamiltonian (band structure) calculation in batches of <batchSize>\n"
+			"states per process, so that memory for wavefunctions scales with <batchSize> instead\n"
+			"of the number of states. Each batch is initialized with random wavefunctions (or from\n"
+			"neighbouring k-points, see elec-eigen-algo) and solved, and then\n"
+			"its eigenvalues, wavefunctions (if state is dumped at End) and band projections\n"
+			"(if bandProjections is dumped at End) are written to the end-of-run output files,\n"
+			"and its wavefunctions are freed before the next batch. Eigenvalues are always written.\n"
+			"+ <restart>: whether to resume from the last completed batch of a previous run with the\n"
+			"   same states, batch size and number of processes (recorded in the bandBatch dump file).\n"
+			"Only outputs that do not need all wavefunctions together may be dumped at End.";
+		
+		require("spintype");
+		forbid("wavefunction");
+		forbid("initial-state");
+	}
+
+	void process(ParamList& pl, Everything& e)
+	{	pl.get(e.cntrl.bandBatchSize, 0, "batchSize", true);
+		pl.get(e.cntrl.bandBatchRestart, true, boolMap, "restart");
+		if(e.cntrl.bandBatchSize <= 0) throw string("<batchSize> must be positive");
+	}
+
+	void printStatus(Everything& e, int iRep)
+	{	logPrintf("%d %s", e.cntrl.bandBatchSize, boolMap.getString(e.cntrl.bandBatchRestart));
+	}
+}
+commandBandBatch;
+
+//-------------------------------------------------------------------------------------------------
+
 struct CommandConvergeEmptyStates : public Command
 {
 	CommandConvergeEmptyStates() : Command("converge-empty-states", "jdftx/Electronic/Optimization")
@@ -280,27 +317,201 @@ commandWavefunctionDrag;
 
 //-------------------------------------------------------------------------------------------------
 
+struct CommandAdaptiveElecThreshold : public Command
+{
+	CommandAdaptiveElecThreshold() : Command("adaptive-elec-threshold", "jdftx/Ionic/Optimization")
+	{
+		format = "yes|no [<forceAccuracy>=0.1] [<maxThreshold>=1e-4]";
+		comments =
+			"Adapt the electronic convergence thresholds (energyDiffThreshold of electronic-minimize\n"
+			"and electronic-scf) to the force and stress residuals during ionic and lattice\n"
+			"optimization (no by default). Since force errors scale as the square root of the\n"
+			"electronic energy error, the threshold is set to 0.5 (<forceAccuracy> R)^2 (in Eh,\n"
+			"for the residual R in Eh/a0), where R is the smallest so far of the maximum force\n"
+			"on any unconstrained atom (and the stress residual in lattice minimization).\n"
+			"The threshold is bounded above by <maxThreshold> and below by the specified\n"
+			"electronic thresholds, and only ever tightens as the optimization proceeds.\n"
+			"The line minimizer does not reject steps based on energy changes within the\n"
+			"current threshold, and reverts to the specified thresholds before giving up.";
+	}
+
+	void process(ParamList& pl, Everything& e)
+	{	pl.get(e.cntrl.adaptiveElecThreshold, false, boolMap, "shouldAdapt", true);
+		pl.get(e.cntrl.adaptiveElecAccuracy, 0.1, "forceAccuracy");
+		pl.get(e.cntrl.adaptiveElecThresholdMax, 1e-4, "maxThreshold");
+		if(e.cntrl.adaptiveElecAccuracy <= 0.) throw string("<forceAccuracy> must be positive");
+		if(e.cntrl.adaptiveElecThresholdMax <= 0.) throw string("<maxThreshold> must be positive");
+	}
+
+	void printStatus(Everything& e, int iRep)
+	{	logPrintf("%s %lg %lg", boolMap.getString(e.cntrl.adaptiveElecThreshold), e.cntrl.adaptiveElecAccuracy, e.cntrl.adaptiveElecThresholdMax);
+	}
+}
+commandAdaptiveElecThreshold;
+
+//-------------------------------------------------------------------------------------------------
+
+EnumStringMap<bool> projectorPrecisionMap(false, "double", true, "single");
+
 struct CommandCacheProjectors : public Command
 {
 	CommandCacheProjectors() : Command("cache-projectors", "jdftx/Miscellaneous")
 	{
-		format = "yes|no";
+		format = "yes|no [<maxMemory>=1024] [<precision>=double]";
 		comments =
-			"Cache nonlocal-pseudopotential projectors (yes by default); turn off to save memory.";
+			"Cache nonlocal-pseudopotential projectors (yes by default); turn off to save memory.\n"
+			"+ <maxMemory>: memory budget in MB per process for the cache (0 => unlimited).\n"
+			"   When exceeded, the least-recently used projectors (across all species and\n"
+			"   k-points) are evicted and recomputed on demand.\n"
+			"+ <precision>: " + projectorPrecisionMap.optionList() + " precision for the cached projectors.\n"
+			"   Single precision halves the memory, at the expense of ~1e-7 relative errors\n"
+			"   in the projections and a conversion to double precision on each lookup.\n"
+			"Cache size and hit-rate statistics are reported at the end of the run.";
 	}
 
 	void process(ParamList& pl, Everything& e)
 	{	pl.get(e.cntrl.cacheProjectors, true, boolMap, "shouldCache", true);
+		pl.get(e.cntrl.cacheProjectorsMaxMemory, 1024., "maxMemory");
+		if(e.cntrl.cacheProjectorsMaxMemory < 0.) throw string("<maxMemory> must be non-negative");
+		pl.get(e.cntrl.cacheProjectorsSingle, false, projectorPrecisionMap, "precision");
 	}
 
 	void printStatus(Everything& e, int iRep)
-	{	logPrintf("%s", boolMap.getString(e.cntrl.cacheProjectors));
+	{	logPrintf("%s %lg %s", boolMap.getString(e.cntrl.cacheProjectors), e.cntrl.cacheProjectorsMaxMemory,
+			projectorPrecisionMap.getString(e.cntrl.cacheProjectorsSingle));
 	}
 }
 commandCacheProjectors;
 
 //-------------------------------------------------------------------------------------------------
 
+struct CommandResultCache : public Command
+{
+	CommandResultCache() : Command("result-cache", "jdftx/Miscellaneous")
+	{
+		format = "<directory> [<nearTolerance>=0] [<saveState>=yes]";
+		comments =
+			"Cache converged energies, forces and stress of each ionic geometry in <directory>,\n"
+			"which may be shared between runs with the same electronic input (eg. successive\n"
+			"runs of a workflow, restarted vibration or NEB calculations). Entries are keyed\n"
+			"by a hash of the lattice vectors, cutoffs, functional, k-points, fillings and\n"
+			"pseudopotential file contents, and of the atomic positions (rounded to 1e-8\n"
+			"in lattice coordinates). A geometry found in the cache, converged at least as\n"
+			"tightly as currently required, skips the electronic minimization entirely.\n"
+			"+ <nearTolerance>: if positive, initialize the electronic state from the nearest\n"
+			"   cached geometry with no atom displaced by more than this (in bohrs).\n"
+			"+ <saveState>: whether to store wavefunctions in the cache. This is required for\n"
+			"   <nearTolerance> and for any hits: without a stored state, cached results are recomputed.\n"
+			"Not supported with fluids. Note that input options not listed above (eg. electronic\n"
+			"pseudopotential modifications) are not part of the key: use a fresh directory\n"
+			"whenever these change.";
+	}
+
+	void process(ParamList& pl, Everything& e)
+	{	string dirname; double nearTolerance; bool saveState;
+		pl.get(dirname, string(), "directory", true);
+		pl.get(nearTolerance, 0., "nearTolerance");
+		pl.get(saveState, true, boolMap, "saveState");
+		if(nearTolerance < 0.) throw string("<nearTolerance> must be non-negative");
+		e.resultCache = std::make_shared<ResultCache>(dirname, nearTolerance, saveState);
+	}
+
+	void printStatus(Everything& e, int iRep)
+	{	logPrintf("%s %lg %s", e.resultCache->dirname.c_str(), e.resultCache->nearTolerance, boolMap.getString(e.resultCache->saveState));
+	}
+}
+commandResultCache;
+
+//-------------------------------------------------------------------------------------------------
+
+struct CommandMergeProjectors : public Command
+{
+	CommandMergeProjectors() : Command("merge-projectors", "jdftx/Miscellaneous")
+	{
+		format = "yes|no";
+		comments =
+			"Apply the nonlocal-pseudopotential projectors of all species together (no by default).\n"
+			"The projectors of all species at each k-point are concatenated into one set, so that\n"
+			"projections and overlap augmentation each need a single large matrix multiply that\n"
+			"reads the wavefunctions once, instead of one smaller multiply per species.\n"
+			"This is most effective for systems with many species. When projectors are cached,\n"
+			"the merged projectors are cached in addition to those of each species.\n"
+			"Ignored when real-space-projectors is enabled.";
+	}
+
+	void process(ParamList& pl, Everything& e)
+	{	pl.get(e.cntrl.mergeProjectors, false, boolMap, "shouldMerge", true);
+	}
+
+	void printStatus(Everything& e, int iRep)
+	{	logPrintf("%s", boolMap.getString(e.cntrl.mergeProjectors));
+	}
+}
+commandMergeProjectors;
+
+//-------------------------------------------------------------------------------------------------
+
+struct CommandRealSpaceProjectors : public Command
+{
+	CommandRealSpaceProjectors() : Command("real-space-projectors", "jdftx/Miscellaneous")
+	{
+		format = "yes|no [<rCutScale>=1.5]";
+		comments =
+			"Apply nonlocal-pseudopotential projectors in real space (no by default).\n"
+			"The projectors are filtered to the wavefunction grid using the masked-function\n"
+			"method, and stored on spheres of radius <rCutScale> times the extent of the\n"
+			"projectors around each atom. This reduces the cost of projections from\n"
+			"O(N^3) to O(N^2) for large systems, at the expense of a small filtering error.\n"
+			"Forces use derivatives of the same filtered projectors (consistent with the energy);\n"
+			"stress calculations (lattice minimization, barostats, stress output) are not supported.";
+	}
+
+	void process(ParamList& pl, Everything& e)
+	{	pl.get(e.cntrl.realSpaceProjectors, false, boolMap, "shouldUse", true);
+		pl.get(e.cntrl.realSpaceProjectorsRcut, 1.5, "rCutScale");
+		if(e.cntrl.realSpaceProjectorsRcut < 1.)
+			throw string("<rCutScale> must be >= 1");
+	}
+
+	void printStatus(Everything& e, int iRep)
+	{	logPrintf("%s %lg", boolMap.getString(e.cntrl.realSpaceProjectors), e.cntrl.realSpaceProjectorsRcut);
+	}
+}
+commandRealSpaceProjectors;
+
+//-------------------------------------------------------------------------------------------------
+
+struct CommandRealSpaceAugmentation : public Command
+{
+	CommandRealSpaceAugmentation() : Command("real-space-augmentation", "jdftx/Miscellaneous")
+	{
+		format = "yes|no [<rCutScale>=1.5]";
+		comments =
+			"Compute ultrasoft-pseudopotential augmentation densities and their gradients\n"
+			"in real space (no by default). The augmentation functions are filtered to the\n"
+			"density grid using the masked-function method, and evaluated only on spheres\n"
+			"of radius <rCutScale> times the extent of the augmentation functions around\n"
+			"each atom, instead of on the full reciprocal-space grid for every atom.\n"
+			"Forces use derivatives of the same filtered augmentation functions (consistent\n"
+			"with the energy); stress calculations (lattice minimization, barostats, stress\n"
+			"output) are not supported.";
+	}
+
+	void process(ParamList& pl, Everything& e)
+	{	pl.get(e.cntrl.realSpaceAugmentation, false, boolMap, "shouldUse", true);
+		pl.get(e.cntrl.realSpaceAugmentationRcut, 1.5, "rCutScale");
+		if(e.cntrl.realSpaceAugmentationRcut < 1.)
+			throw string("<rCutScale> must be >= 1");
+	}
+
+	void printStatus(Everything& e, int iRep)
+	{	logPrintf("%s %lg", boolMap.getString(e.cntrl.realSpaceAugmentation), e.cntrl.realSpaceAugmentationRcut);
+	}
+}
+commandRealSpaceAugmentation;
+
+//-------------------------------------------------------------------------------------------------
+
 struct CommandBasis : public Command
 {
 	CommandBasis() : Command("basis", "jdftx/Electronic/Parameters")
@@ -329,17 +540,23 @@ struct CommandElecEigenAlgo : public Command
 {
     CommandElecEigenAlgo() : Command("elec-eigen-algo", "jdftx/Electronic/Optimization")
 	{
-		format = "<algo>=" + elecEigenMap.optionList();
-		comments = "Selects eigenvalue algorithm for band-structure calculations or inner loop of SCF.";
+		format = "<algo>=" + elecEigenMap.optionList() + " [<neighborGuess>=no]";
+		comments = "Selects eigenvalue algorithm for band-structure calculations or inner loop of SCF.\n"
+			"+ <neighborGuess>: in band-structure (fixed Hamiltonian) calculations with Davidson,\n"
+			"   solve the k-points of each process in nearest-neighbour order, and start each one from\n"
+			"   the converged wavefunctions of the nearest k-point solved so far, instead of the\n"
+			"   initial (LCAO, random or read-in) wavefunctions. This substantially reduces iterations\n"
+			"   for dense k-point paths or meshes.";
 		hasDefault = true;
 	}
 
 	void process(ParamList& pl, Everything& e)
 	{	pl.get(e.cntrl.elecEigenAlgo, ElecEigenDavidson, elecEigenMap, "algo");
+		pl.get(e.cntrl.davidsonNeighborGuess, false, boolMap, "neighborGuess");
 	}
 
 	void printStatus(Everything& e, int iRep)
-	{	fputs(elecEigenMap.getString(e.cntrl.elecEigenAlgo), globalLog);
+	{	logPrintf("%s %s", elecEigenMap.getString(e.cntrl.elecEigenAlgo), boolMap.getString(e.cntrl.davidsonNeighborGuess));
 	}
 }
 commandElecEigenAlgo;
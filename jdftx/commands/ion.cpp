@@ -298,3 +298,32 @@ struct CommandCoreOverlapCheck : public Command
 	}
 }
 commandCoreOverlapCheck;
+
+
+struct CommandIncrementalLocalUpdate : public Command
+{
+	CommandIncrementalLocalUpdate() : Command("incremental-local-update", "jdftx/Ionic/Optimization")
+	{
+		format = "<fullInterval> [<maxMovedFraction>=0.25]";
+		comments = "Update the local pseudopotential, ionic charge and partial core densities incrementally\n"
+			"when only a few atoms move, by subtracting and adding only the contributions of moved atoms.\n"
+			"This reduces the per-step overhead of constrained or adsorbate-only relaxations.\n"
+			"+ <fullInterval>: perform a full recomputation after every <fullInterval> updates\n"
+			"   to control accumulated round-off error (0 disables incremental updates).\n"
+			"+ <maxMovedFraction>: perform a full recomputation if more than this fraction of atoms moved.\n"
+			"\n"
+			"A full recomputation is always performed when the lattice vectors change.";
+	}
+
+	void process(ParamList& pl, Everything& e)
+	{	pl.get(e.iInfo.localUpdateInterval, 0, "fullInterval", true);
+		if(e.iInfo.localUpdateInterval < 0) throw string("<fullInterval> must be non-negative");
+		pl.get(e.iInfo.localUpdateMaxMoved, 0.25, "maxMovedFraction");
+		if(e.iInfo.localUpdateMaxMoved < 0. || e.iInfo.localUpdateMaxMoved > 1.) throw string("<maxMovedFraction> must be in [0,1]");
+	}
+
+	void printStatus(Everything& e, int iRep)
+	{	logPrintf("%d %lg", e.iInfo.localUpdateInterval, e.iInfo.localUpdateMaxMoved);
+	}
+}
+commandIncrementalLocalUpdate;
@@ -30,6 +30,11 @@ EnumStringMap<IonicDynamicsParams::StatMethod> statMethodMap
 	IonicDynamicsParams::NoseHoover, "NoseHoover"
 );
 
+EnumStringMap<IonicDynamicsParams::FastForceModel> fastForceModelMap
+(	IonicDynamicsParams::PairPotential, "PairPotential",
+	IonicDynamicsParams::HarmonicBonds, "HarmonicBonds"
+);
+
 //An enum entry for each configurable option of IonicDynamicsParams
 enum IonicDynamicsParamsMember
 {	IDPM_dt,
@@ -43,6 +48,10 @@ enum IonicDynamicsParamsMember
 	IDPM_chainLengthT,
 	IDPM_chainLengthP,
 	IDPM_B0,
+	IDPM_nInnerSteps,
+	IDPM_fastForceModel,
+	IDPM_bondK,
+	IDPM_bondCutoff,
 	IDPM_Delim //!< delimiter to detect end of input
 };
 
@@ -57,7 +66,11 @@ EnumStringMap<IonicDynamicsParamsMember> idpmMap
 	IDPM_tDampP, "tDampP",
 	IDPM_chainLengthT, "chainLengthT",
 	IDPM_chainLengthP, "chainLengthP",
-	IDPM_B0, "B0"
+	IDPM_B0, "B0",
+	IDPM_nInnerSteps, "nInnerSteps",
+	IDPM_fastForceModel, "fastForceModel",
+	IDPM_bondK, "bondK",
+	IDPM_bondCutoff, "bondCutoff"
 );
 
 EnumStringMap<IonicDynamicsParamsMember> idpmDescMap
@@ -71,7 +84,11 @@ EnumStringMap<IonicDynamicsParamsMember> idpmDescMap
 	IDPM_tDampP, "barostat damping time [fs]",
 	IDPM_chainLengthT, "Nose-Hoover chain length for thermostat",
 	IDPM_chainLengthP, "Nose-Hoover chain length for barostat",
-	IDPM_B0, "Characteristic bulk modulus [bar] for Berendsen barostat (damping ~ B0 * tDampP)"
+	IDPM_B0, "Characteristic bulk modulus [bar] for Berendsen barostat (damping ~ B0 * tDampP)",
+	IDPM_nInnerSteps, "number of inner steps per time step dt using only the fast forces (default 1; > 1 => r-RESPA multiple time stepping)",
+	IDPM_fastForceModel, fastForceModelMap.optionList() + " (cheap reference model for fast forces in multiple time stepping)",
+	IDPM_bondK, "force constant of harmonic bonds [eV/A^2] for fastForceModel HarmonicBonds",
+	IDPM_bondCutoff, "atom pairs closer than this initially [A] are bonded for fastForceModel HarmonicBonds"
 );
 
 struct CommandIonicDynamics : public Command
@@ -89,7 +106,13 @@ struct CommandIonicDynamics : public Command
 		+ addDescriptions(idpmMap.optionList(), linkDescription(idpmMap, idpmDescMap))
 		+ "\n\nAny number of these key-value pairs may be specified in any order.\n\n"
 			"Note that nSteps must be non-zero to activate dynamics.\n"
-			"Default mode is NVE; specify statMethod to add a thermostat or barostat";
+			"Default mode is NVE; specify statMethod to add a thermostat or barostat.\n\n"
+			"With nInnerSteps > 1, the forces are split into fast forces from a cheap reference model\n"
+			"(Ewald + pair potentials for PairPotential, or harmonic bonds between initially close atom\n"
+			"pairs with their initial lengths as rest lengths for HarmonicBonds) integrated with time step\n"
+			"dt/nInnerSteps, and the remainder (DFT - fast) applied as impulses every dt (r-RESPA).\n"
+			"DFT forces are evaluated only once per dt, which can then typically be chosen 3-5x larger\n"
+			"than for plain velocity Verlet. Not supported in combination with a barostat.";
 	}
 
 	void process(ParamList& pl, Everything& e)
@@ -122,9 +145,21 @@ struct CommandIonicDynamics : public Command
 				case IDPM_chainLengthT: pl.get(idp.chainLengthT, 3, "chainLengthT", true); break;
 				case IDPM_chainLengthP: pl.get(idp.chainLengthP, 3, "chainLengthP", true); break;
 				case IDPM_B0: pl.get(idp.B0, nanVal, "B0", true); idp.B0 *= Bar; break;
+				case IDPM_nInnerSteps: pl.get(idp.nInnerSteps, 1, "nInnerSteps", true); break;
+				case IDPM_fastForceModel: pl.get(idp.fastForceModel, IonicDynamicsParams::PairPotential, fastForceModelMap, "fastForceModel", true); break;
+				case IDPM_bondK: pl.get(idp.bondK, 0., "bondK", true); idp.bondK *= eV/(Angstrom*Angstrom); break;
+				case IDPM_bondCutoff: pl.get(idp.bondCutoff, 0., "bondCutoff", true); idp.bondCutoff *= Angstrom; break;
 				case IDPM_Delim: 
 					if((not std::isnan(idp.P0)) and (not std::isnan(trace(idp.stress0))))
 						throw(string("Cannot specify both P0 (hydrostatic) and stress0 (anisotropic) barostats"));
+					if(idp.nInnerSteps < 1)
+						throw(string("nInnerSteps must be >= 1"));
+					if(idp.nInnerSteps > 1)
+					{	if(idp.statMethod!=IonicDynamicsParams::StatNone and ((not std::isnan(idp.P0)) or (not std::isnan(trace(idp.stress0)))))
+							throw(string("Multiple time stepping (nInnerSteps > 1) is not supported with a barostat"));
+						if(idp.fastForceModel==IonicDynamicsParams::HarmonicBonds and (idp.bondK<=0. or idp.bondCutoff<=0.))
+							throw(string("fastForceModel HarmonicBonds requires positive bondK and bondCutoff"));
+					}
 					return; //end of input
 			}
 		}
@@ -145,11 +180,89 @@ struct CommandIonicDynamics : public Command
 		logPrintf(" \\\n\tchainLengthT %d", idp.chainLengthT);
 		logPrintf(" \\\n\tchainLengthP %d", idp.chainLengthP);
 		logPrintf(" \\\n\tB0           %lg", idp.B0/Bar);
+		logPrintf(" \\\n\tnInnerSteps    %d", idp.nInnerSteps);
+		logPrintf(" \\\n\tfastForceModel %s", fastForceModelMap.getString(idp.fastForceModel));
+		logPrintf(" \\\n\tbondK          %lg", idp.bondK/(eV/(Angstrom*Angstrom)));
+		logPrintf(" \\\n\tbondCutoff     %lg", idp.bondCutoff/Angstrom);
 	}
 }
 commandIonicDynamics;
 
 
+//An enum entry for each configurable option of NEBparams
+enum NEBparamsMember
+{	NPM_nImages,
+	NPM_finalPositions,
+	NPM_springConstant,
+	NPM_climbing,
+	NPM_Delim //!< delimiter to detect end of input
+};
+
+EnumStringMap<NEBparamsMember> npmMap
+(	NPM_nImages, "nImages",
+	NPM_finalPositions, "finalPositions",
+	NPM_springConstant, "springConstant",
+	NPM_climbing, "climbing"
+);
+
+EnumStringMap<NEBparamsMember> npmDescMap
+(	NPM_nImages, "number of intermediate images (must be non-zero to activate NEB)",
+	NPM_finalPositions, "file containing ion commands specifying the final state",
+	NPM_springConstant, "spring constant between adjacent images [Eh/a0^2] (default 0.05)",
+	NPM_climbing, "yes|no: whether the highest-energy image climbs to the saddle point (default yes)"
+);
+
+struct CommandNEB : public Command
+{
+	CommandNEB() : Command("neb", "jdftx/Ionic/Optimization")
+	{	format = "<key1> <value1> <key2> <value2> ...";
+		comments = "Nudged elastic band calculation of the minimum energy path between the\n"
+			"initial state (specified in this input file) and a final state, controlled by keys:"
+			+ addDescriptions(npmMap.optionList(), linkDescription(npmMap, npmDescMap))
+			+ "\n\nAny number of these key-value pairs may be specified in any order.\n\n"
+			"The final state file contains ion commands (all other commands in it are ignored),\n"
+			"with the same atoms in the same order as this input file.\n"
+			"Images are linearly interpolated between the end points, and are optimized using\n"
+			"the parameters of command ionic-minimize (with line minimization forced to Relax).\n"
+			"Convergence is tested only on the RMS NEB force of all images (knormThreshold),\n"
+			"since the sum of image energies is not minimized along the band (energyDiffThreshold is ignored).\n"
+			"Each image is computed within one process group: use command-line option -G\n"
+			"to evaluate up to nImages images concurrently. The state of image i is dumped with\n"
+			"prefix neb.<i> added to the dump filenames, and is read back in from there when available.";
+	}
+
+	void process(ParamList& pl, Everything& e)
+	{	NEBparams& np = e.nebParams;
+		while(true)
+		{	NEBparamsMember key;
+			pl.get(key, NPM_Delim, npmMap, "key");
+			switch(key)
+			{	case NPM_nImages: pl.get(np.nImages, 0, "nImages", true); break;
+				case NPM_finalPositions: pl.get(np.finalPositionsFilename, string(), "finalPositions", true); break;
+				case NPM_springConstant: pl.get(np.springConstant, 0.05, "springConstant", true); break;
+				case NPM_climbing: pl.get(np.climbing, true, boolMap, "climbing", true); break;
+				case NPM_Delim:
+					if(np.nImages < 0) throw(string("nImages must be non-negative"));
+					if(np.nImages && !np.finalPositionsFilename.length())
+						throw(string("finalPositions must be specified for nudged elastic band calculations"));
+					if(np.springConstant <= 0.) throw(string("springConstant must be positive"));
+					return; //end of input
+			}
+		}
+	}
+
+	void printStatus(Everything& e, int iRep)
+	{	const NEBparams& np = e.nebParams;
+		logPrintf(" \\\n\tnImages        %d", np.nImages);
+		if(np.finalPositionsFilename.length())
+			logPrintf(" \\\n\tfinalPositions %s", np.finalPositionsFilename.c_str());
+		logPrintf(" \\\n\tspringConstant %lg", np.springConstant);
+		logPrintf(" \\\n\tclimbing       %s", boolMap.getString(np.climbing));
+	}
+}
+commandNEB;
+
+
 struct CommandLjOverride : public Command
 {
 	CommandLjOverride() : Command("lj-override", "jdftx/Ionic/Optimization")
@@ -24,7 +24,8 @@ EnumStringMap<MinimizeParams::DirectionUpdateScheme> dirUpdateMap
 	MinimizeParams::FletcherReeves, "FletcherReeves",
 	MinimizeParams::HestenesStiefel, "HestenesStiefel",
 	MinimizeParams::LBFGS, "L-BFGS",
-	MinimizeParams::SteepestDescent, "SteepestDescent"
+	MinimizeParams::SteepestDescent, "SteepestDescent",
+	MinimizeParams::FIRE, "FIRE"
 );
 
 EnumStringMap<MinimizeParams::LinminMethod> linminMap
@@ -81,7 +82,7 @@ EnumStringMap<MinimizeParamsMember> mpmDescMap
 	MPM_knormThreshold, "convergence threshold for gradient (preconditioned) norm",
 	MPM_energyDiffThreshold, "convergence threshold for energy difference between successive iterations",
 	MPM_nEnergyDiff, "number of iteration pairs that must satisfy energyDiffThreshold",
-	MPM_alphaTstart, "initial test step size (constant step-size factor for Relax linmin)",
+	MPM_alphaTstart, "initial test step size (constant step-size factor for Relax linmin, initial time step for FIRE)",
 	MPM_alphaTmin, "minimum test step size",
 	MPM_updateTestStepSize, boolMap.optionList() + ", whether test step size is updated",
 	MPM_alphaTreduceFactor, "step size reduction factor when energy increases in linmin",
@@ -179,6 +180,50 @@ struct CommandIonicMinimize : public CommandMinimize
 }
 commandIonicMinimize;
 
+EnumStringMap<IonicPreconditionerParams::Type> ionicPrecondTypeMap
+(	IonicPreconditionerParams::Diagonal, "Diagonal",
+	IonicPreconditionerParams::Exp, "Exp"
+);
+
+struct CommandIonicPreconditioner : public Command
+{	CommandIonicPreconditioner() : Command("ionic-preconditioner", "jdftx/Ionic/Optimization")
+	{	format = "<type>=" + ionicPrecondTypeMap.optionList() + " [<mu>=0.02] [<A>=3] [<rCutFactor>=2] [<stateFilename>]";
+		comments =
+			"Select preconditioner for ionic minimization:\n"
+			"+ Diagonal: scale gradient by the moveScale of each atom (default).\n"
+			"+ Exp: Hessian guess from the current positions \\cite PreconExp, with pair stiffness\n"
+			"   <mu> exp(-<A> (r/rNN - 1)) [Eh/a0^2] for neighbours within <rCutFactor>*rNN,\n"
+			"   where rNN is the nearest-neighbour distance. This usually reduces the number\n"
+			"   of ionic steps substantially for extended systems such as surface slabs.\n"
+			"   The stiffness is fitted during the run and saved to <stateFilename> (if specified),\n"
+			"   from where it is read back (overriding <mu>) when restarting the optimization.\n"
+			"\n"
+			"Note that with Exp, the preconditioned gradient has units of distance, so that\n"
+			"ionic-minimize alphaTstart = 1 (default) corresponds to a quasi-Newton step, and\n"
+			"knormThreshold applies to sqrt(g.inv(P).g / nDim) in Eh^(1/2).";
+		hasDefault = true;
+	}
+	
+	void process(ParamList& pl, Everything& e)
+	{	IonicPreconditionerParams& ipp = e.ionicPrecondParams;
+		pl.get(ipp.type, IonicPreconditionerParams::Diagonal, ionicPrecondTypeMap, "type");
+		pl.get(ipp.mu, 0.02, "mu");
+		pl.get(ipp.A, 3., "A");
+		pl.get(ipp.rCutFactor, 2., "rCutFactor");
+		pl.get(ipp.stateFilename, string(), "stateFilename");
+		if(ipp.mu <= 0.) throw string("<mu> must be positive");
+		if(ipp.A < 0.) throw string("<A> must be non-negative");
+		if(ipp.rCutFactor < 1.) throw string("<rCutFactor> must be at least 1");
+	}
+	
+	void printStatus(Everything& e, int iRep)
+	{	const IonicPreconditionerParams& ipp = e.ionicPrecondParams;
+		logPrintf("%s %lg %lg %lg", ionicPrecondTypeMap.getString(ipp.type), ipp.mu, ipp.A, ipp.rCutFactor);
+		if(ipp.stateFilename.length()) logPrintf(" %s", ipp.stateFilename.c_str());
+	}
+}
+commandIonicPreconditioner;
+
 struct CommandFluidMinimize : public CommandMinimize
 {	CommandFluidMinimize() : CommandMinimize("fluid", "jdftx/Fluid/Optimization")
 	{	require("fluid");
@@ -85,6 +85,27 @@ void eblas_zgemm(
 	#endif
 }
 
+void eblas_ztrmm_sub(size_t iMin, size_t iMax,
+	const CBLAS_SIDE Side, const CBLAS_UPLO Uplo, const CBLAS_TRANSPOSE TransA, const CBLAS_DIAG Diag, const int M, const int N,
+	const complex* alpha, const complex *A, const int lda, complex *B, const int ldb)
+{	//Split the dimension of B not involved in the triangular product:
+	if(Side==CblasRight)
+		cblas_ztrmm(CblasColMajor, Side, Uplo, TransA, Diag, iMax-iMin, N, alpha, A, lda, B+iMin, ldb);
+	else
+		cblas_ztrmm(CblasColMajor, Side, Uplo, TransA, Diag, M, iMax-iMin, alpha, A, lda, B+iMin*ldb, ldb);
+}
+void eblas_ztrmm(
+	const CBLAS_SIDE Side, const CBLAS_UPLO Uplo, const CBLAS_TRANSPOSE TransA, const CBLAS_DIAG Diag, const int M, const int N,
+	const complex& alpha, const complex *A, const int lda, complex *B, const int ldb)
+{
+	#ifdef THREADED_BLAS
+	cblas_ztrmm(CblasColMajor, Side, Uplo, TransA, Diag, M, N, &alpha, A, lda, B, ldb);
+	#else
+	threadLaunch(eblas_ztrmm_sub, (Side==CblasRight ? M : N),
+		Side, Uplo, TransA, Diag, M, N, &alpha, A, lda, B, ldb);
+	#endif
+}
+
 template<typename scalar, typename scalar2, typename Conjugator>
 void eblas_scatter_axpy_sub(size_t iStart, size_t iStop, scalar2 a, const int* index, const scalar* x, scalar* y, const scalar* w, const Conjugator& conjugator)
 {	for(size_t i=iStart; i<iStop; i++) y[index[i]] += a * conjugator(x,i, w,i);
@@ -104,19 +125,40 @@ DEFINE_SPARSE_AXPY(scatter,)
 DEFINE_SPARSE_AXPY(gather,)
 
 
-void eblas_accumNorm_sub(size_t iStart, size_t iStop, const double& a, const complex* x, double* y)
-{	for(size_t i=iStart; i<iStop; i++) y[i] += a * x[i].norm();
+//The dense accumulation loops below are compiled for several vector instruction sets,
+//and the version matching the CPU is selected at runtime (GCC function multi-versioning).
+//This is unnecessary when the entire build already targets the native CPU (CompileNative).
+#if defined(__GNUC__) && !defined(__clang__) && !defined(__INTEL_COMPILER) && defined(__x86_64__) && defined(__linux__) && !defined(__AVX2__)
+	#define EBLAS_MULTIVERSION __attribute__((target_clones("avx512f","avx2","default")))
+#else
+	#define EBLAS_MULTIVERSION
+#endif
+
+//Note: real and imaginary parts are accessed explicitly through non-aliasing pointers to enable vectorization,
+//with the arithmetic ordered exactly as in the corresponding complex operations (so that results are unchanged)
+EBLAS_MULTIVERSION void eblas_accumNorm_sub(size_t iStart, size_t iStop, double a, const complex* x, double* y)
+{	const double* __restrict__ xData = (const double*)x;
+	double* __restrict__ yData = y;
+	for(size_t i=iStart; i<iStop; i++)
+	{	double xRe = xData[2*i], xIm = xData[2*i+1];
+		yData[i] += a * (xRe*xRe + xIm*xIm);
+	}
 }
 void eblas_accumNorm(int N, const double& a, const complex* x, double* y)
 {	threadLaunch((N<100000) ? 1 : 0, //force single threaded for small problem sizes
 		eblas_accumNorm_sub, N, a, x, y);
 }
 
-void eblas_accumProd_sub(size_t iStart, size_t iStop, const double& a, const complex* xU, const complex* xC, double* yRe, double* yIm)
-{	for(size_t i=iStart; i<iStop; i++)
-	{	complex z = a * xU[i] * xC[i].conj();
-		yRe[i] += z.real();
-		yIm[i] += z.imag();
+EBLAS_MULTIVERSION void eblas_accumProd_sub(size_t iStart, size_t iStop, double a, const complex* xU, const complex* xC, double* yRe, double* yIm)
+{	const double* __restrict__ xUdata = (const double*)xU;
+	const double* __restrict__ xCdata = (const double*)xC;
+	double* __restrict__ yReData = yRe;
+	double* __restrict__ yImData = yIm;
+	for(size_t i=iStart; i<iStop; i++)
+	{	double aUre = a*xUdata[2*i], aUim = a*xUdata[2*i+1]; //a * xU
+		double cRe = xCdata[2*i], cIm = xCdata[2*i+1];
+		yReData[i] += aUre*cRe + aUim*cIm; //real part of (a xU) conj(xC)
+		yImData[i] += aUim*cRe - aUre*cIm; //imaginary part of (a xU) conj(xC)
 	}
 }
 void eblas_accumProd(int N, const double& a, const complex* xU, const complex* xC, double* yRe, double* yIm)
@@ -79,6 +79,14 @@ void eblas_zgemm_gpu(CBLAS_TRANSPOSE TransA, CBLAS_TRANSPOSE TransB, int M, int
 		(const double2*)&beta, (double2*)C, ldc);
 }
 
+void eblas_ztrmm_gpu(CBLAS_SIDE Side, CBLAS_UPLO Uplo, CBLAS_TRANSPOSE TransA, CBLAS_DIAG Diag, int M, int N,
+	const complex& alpha, const complex *A, const int lda, complex *B, const int ldb)
+{	cublasZtrmm(cublasHandle, (Side==CblasLeft ? CUBLAS_SIDE_LEFT : CUBLAS_SIDE_RIGHT),
+		(Uplo==CblasUpper ? CUBLAS_FILL_MODE_UPPER : CUBLAS_FILL_MODE_LOWER), cublasTranspose(TransA),
+		(Diag==CblasUnit ? CUBLAS_DIAG_UNIT : CUBLAS_DIAG_NON_UNIT), M, N,
+		(const double2*)&alpha, (const double2*)A, lda, (const double2*)B, ldb, (double2*)B, ldb); //in-place (output same as input)
+}
+
 template<typename scalar, typename scalar2, typename Conjugator> __global__ 
 void eblas_scatter_axpy_kernel(const int N, scalar2 a, const int* index, const scalar* x, scalar* y, const scalar* w, const Conjugator& conjugator)
 {	int i = kernelIndex1D();
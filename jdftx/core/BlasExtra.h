@@ -142,6 +142,16 @@ void eblas_zgemm_gpu(CBLAS_TRANSPOSE TransA, CBLAS_TRANSPOSE TransB, int M, int
 	const complex& beta, complex *C, const int ldc);
 #endif
 
+//! @brief Threaded in-place triangular matrix multiply (threaded wrapper around ztrmm)
+//! All the parameters have the same meaning as in cblas_ztrmm, except element order is always Column Major (FORTRAN order!)
+void eblas_ztrmm(CBLAS_SIDE Side, CBLAS_UPLO Uplo, CBLAS_TRANSPOSE TransA, CBLAS_DIAG Diag, int M, int N,
+	const complex& alpha, const complex *A, const int lda, complex *B, const int ldb);
+#ifdef GPU_ENABLED
+//! @brief Wrap cublasZtrmm to provide the same interface as eblas_ztrmm()
+void eblas_ztrmm_gpu(CBLAS_SIDE Side, CBLAS_UPLO Uplo, CBLAS_TRANSPOSE TransA, CBLAS_DIAG Diag, int M, int N,
+	const complex& alpha, const complex *A, const int lda, complex *B, const int ldb);
+#endif
+
 //Sparse<->dense vector operations:
 //! @brief Scatter y(index) += a * x
 //! @param Nindex Length of index array
@@ -284,6 +284,18 @@ void MPIUtil::fopenAppend(File& fp, const char* fname) const
 	#endif
 }
 
+void MPIUtil::fopenUpdate(File& fp, const char* fname) const
+{
+	#ifdef MPI_ENABLED
+	if(MPI_File_open(comm, (char*)fname, MPI_MODE_WRONLY|MPI_MODE_CREATE, MPI_INFO_NULL, &fp) != MPI_SUCCESS)
+	#else
+	fp = ::fopen(fname, "r+b");
+	if(!fp) fp = ::fopen(fname, "wb");
+	if(!fp)
+	#endif
+		 die("Error opening file '%s' for writing.\n", fname);
+}
+
 void MPIUtil::fclose(File& fp) const
 {
 	#ifdef MPI_ENABLED
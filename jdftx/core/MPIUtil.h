@@ -116,6 +116,10 @@ public:
 	void reduce(bool* data, size_t nData, ReduceOp op, int root=0, Request* request=0) const;  //!< specialization for bool which is not natively supported by MPI
 	template<typename T> void reduce(T& data, int& index, ReduceOp op, int root=0) const; //!< maximum / minimum with index location (MAXLOC / MINLOC modes); use op = ReduceMin or ReduceMax
 	
+	//Block-partitioned collectives (full arrays of nData*nProcesses() entries, with block iProcess() belonging to the current process):
+	template<typename T> void reduceScatter(const T* dataIn, T* dataOut, size_t nData, ReduceOp op, Request* request=0) const; //!< reduce full dataIn and store own block of result in dataOut (length nData)
+	template<typename T> void allGather(T* data, size_t nData, Request* request=0) const; //!< in-place gather of all blocks of data, given own block
+	
 	//File access (tiny subset of MPI-IO, using byte offsets alone, and made to closely resemble stdio):
 	#ifdef MPI_ENABLED
 	typedef MPI_File File;
@@ -125,6 +129,7 @@ public:
 	void fopenRead(File& fp, const char* fname, size_t fsizeExpected=0, const char* fsizeErrMsg=0) const; //!< open file for reading and optionally check file size
 	void fopenWrite(File& fp, const char* fname) const; //!< open file for writing
 	void fopenAppend(File& fp, const char* fname) const; //!< open file for appending to the end. Implied barrier on exit.
+	void fopenUpdate(File& fp, const char* fname) const; //!< open file for writing at arbitrary offsets, retaining existing contents (created if necessary)
 	void fclose(File& fp) const;
 	void fseek(File fp, long offset, int whence) const; //!< syntax consistent with fseek from stdio
 	void fread(void *ptr, size_t size, size_t nmemb, File fp) const;
@@ -371,6 +376,41 @@ template<typename T> void MPIUtil::reduce(T& data, int& index, MPIUtil::ReduceOp
 	#endif
 }
 
+template<typename T> void MPIUtil::reduceScatter(const T* dataIn, T* dataOut, size_t nData, MPIUtil::ReduceOp op, Request* request) const
+{	using namespace MPIUtilPrivate;
+	#ifdef MPI_ENABLED
+	if(nProcs>1)
+	{	
+		#if MPI_VERSION < 3
+		if(request) *request = MPI_REQUEST_NULL; //Non-blocking collective not supported (fall back to blocking version below)
+		#else
+		if(request)
+			MPI_Ireduce_scatter_block(dataIn, dataOut, DataType<T>::nElem*nData, DataType<T>::get(), mpiOp(op), comm, request);
+		else
+		#endif
+			MPI_Reduce_scatter_block(dataIn, dataOut, DataType<T>::nElem*nData, DataType<T>::get(), mpiOp(op), comm);
+		return;
+	}
+	#endif
+	std::copy(dataIn, dataIn+nData, dataOut); //single process: own block is the result
+}
+template<typename T> void MPIUtil::allGather(T* data, size_t nData, Request* request) const
+{	using namespace MPIUtilPrivate;
+	#ifdef MPI_ENABLED
+	if(nProcs>1)
+	{	
+		#if MPI_VERSION < 3
+		if(request) *request = MPI_REQUEST_NULL; //Non-blocking collective not supported (fall back to blocking version below)
+		#else
+		if(request)
+			MPI_Iallgather(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL, data, DataType<T>::nElem*nData, DataType<T>::get(), comm, request);
+		else
+		#endif
+			MPI_Allgather(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL, data, DataType<T>::nElem*nData, DataType<T>::get(), comm);
+	}
+	#endif
+}
+
 template<typename T> void MPIUtil::freadData(std::vector<T>& v, File fp) const
 {	fread(v.data(), sizeof(T), v.size(), fp);
 }
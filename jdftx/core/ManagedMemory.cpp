@@ -19,10 +19,16 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <core/ManagedMemory.h>
 #include <core/GpuUtil.h>
+#include <core/Thread.h>
 #include <fftw3.h>
 #include <mutex>
+#include <atomic>
 #include <map>
 #include <set>
+#include <unordered_map>
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
 
 //-------- Memory usage profiler ---------
 
@@ -99,13 +105,133 @@ namespace MemUsageReport
 
 namespace MemPool
 {
+	//Cache freed memory blocks by size class for reuse, avoiding system alloc/free calls (and page faults on first touch)
+	//for the temporaries that are repeatedly created and destroyed with identical sizes (ScalarFields on a given grid,
+	//ColumnBundles on a given basis etc.). Sizes are rounded up to a multiple of the cache line size (small blocks)
+	//or page size (large blocks), so that all objects of one grid / basis / band count share a size class.
+	//Free blocks are kept in a single mutex-guarded cache shared by all threads (threadLaunch starts new threads
+	//on each call, so thread-local caches would be cold and discarded with their threads).
+	//The total size of cached blocks is limited to memcacheSize; all calls pass through to MemSpace if it is zero.
+	//With threads pinned across several NUMA nodes, large blocks are additionally keyed by the node of their
+	//(first) page, and only handed out to threads running on that node, so that per-thread scratch stays socket-local.
+	//MemSpace is as described for MemPool below.
+	template<typename MemSpace> class MemCache
+	{	std::mutex lock; //for thread safety of shared cache
+		std::unordered_map<size_t, std::vector<void*>> shared; //key (size class and node) -> free blocks in shared cache
+		std::atomic<size_t> nBytesCached, nBytesCachedPeak; //current and peak size of cached blocks
+		std::atomic<size_t> nHits, nMisses, nOverflows; //allocation statistics
+		std::atomic<size_t> nBytesRequested, nBytesServed; //total requested and size-class-rounded allocation sizes
+		
+		static size_t sizeClass(size_t size)
+		{	const size_t lineSize = 64, pageSize = 4096;
+			const size_t granularity = (size < 16*pageSize) ? lineSize : pageSize;
+			return (size + granularity-1) & (~(granularity-1));
+		}
+		
+		//NUMA node of blocks (freed) and of requesting threads (allocated), used only for large blocks:
+		static const size_t numaMinSize = 65536;
+		static int blockNode(void* ptr, size_t size) { return (size>=numaMinSize && numaNodeCount()>1) ? MemSpace::nodeOf(ptr) : 0; }
+		static int threadNode(size_t size) { return (size>=numaMinSize && numaNodeCount()>1) ? MemSpace::nodeCurrent() : 0; }
+		static size_t sharedKey(size_t size, int node) { return size + (node & 63); } //size classes are multiples of 64
+		
+		static bool destroyed; //cache bypassed after destruction (for objects freed during static destruction)
+		
+		//Release all blocks in the shared cache to MemSpace:
+		void flush()
+		{	std::lock_guard<std::mutex> guard(lock);
+			for(auto& entry: shared)
+			{	for(void* ptr: entry.second) MemSpace::free(ptr);
+				nBytesCached -= (entry.first & ~size_t(63)) * entry.second.size();
+			}
+			shared.clear();
+		}
+		
+	public:
+		MemCache() : nBytesCached(0), nBytesCachedPeak(0), nHits(0), nMisses(0), nOverflows(0), nBytesRequested(0), nBytesServed(0) {}
+		~MemCache()
+		{	for(auto& entry: shared)
+				for(void* ptr: entry.second) MemSpace::free(ptr);
+			destroyed = true;
+		}
+		
+		void* alloc(size_t sizeRequested)
+		{	if(!memcacheSize || destroyed) //cache not in use
+			{	void* ptr = MemSpace::alloc(sizeRequested);
+				if(ptr) MemSpace::firstTouch(ptr, sizeRequested);
+				return ptr;
+			}
+			size_t size = sizeClass(sizeRequested);
+			int node = threadNode(size);
+			nBytesRequested += sizeRequested;
+			nBytesServed += size;
+			//Check shared cache:
+			{	std::lock_guard<std::mutex> guard(lock);
+				auto iter = shared.find(sharedKey(size, node));
+				if(iter != shared.end() && iter->second.size())
+				{	void* ptr = iter->second.back();
+					iter->second.pop_back();
+					nBytesCached -= size;
+					nHits++;
+					return ptr;
+				}
+			}
+			//Allocate new block:
+			nMisses++;
+			void* ptr = MemSpace::alloc(size);
+			if(!ptr)
+			{	flush(); //release cached blocks and retry
+				ptr = MemSpace::alloc(size);
+				if(!ptr) MemSpace::outOfMemory();
+			}
+			MemSpace::adviseLarge(ptr, size);
+			MemSpace::firstTouch(ptr, size);
+			return ptr;
+		}
+		
+		void free(void* ptr, size_t sizeRequested)
+		{	if(!memcacheSize || destroyed) { MemSpace::free(ptr); return; } //cache not in use
+			size_t size = sizeClass(sizeRequested);
+			int node = blockNode(ptr, size);
+			//Check capacity:
+			size_t nBytesNew = (nBytesCached += size);
+			if(nBytesNew > memcacheSize)
+			{	nBytesCached -= size;
+				nOverflows++;
+				MemSpace::free(ptr);
+				return;
+			}
+			size_t nBytesPeak = nBytesCachedPeak;
+			while(nBytesNew > nBytesPeak && !nBytesCachedPeak.compare_exchange_weak(nBytesPeak, nBytesNew));
+			//Add to shared cache:
+			std::lock_guard<std::mutex> guard(lock);
+			shared[sharedKey(size, node)].push_back(ptr);
+		}
+		
+		void printStats(const char* spaceName)
+		{	if(!memcacheSize) return;
+			size_t nAllocs = nHits + nMisses;
+			if(!nAllocs) return;
+			const double bytesToGB = 1./pow(1024.,3);
+			logPrintf("MEMCACHE: %s: %lu allocations, hit rate %.1lf%%, %lu overflows;"
+				" cached %.6lf GB (peak %.6lf GB); size-class fragmentation %.2lf%%\n", spaceName,
+				nAllocs, (100.*nHits)/nAllocs, size_t(nOverflows),
+				nBytesCached*bytesToGB, nBytesCachedPeak*bytesToGB, 100.*(1. - double(nBytesRequested)/nBytesServed));
+		}
+	};
+	
+	template<typename MemSpace> bool MemCache<MemSpace>::destroyed = false;
+	
 	//Pool memory allocations in a memory space abstracted by MemSpace
 	//MemSpace is a tag class with static functions:
 	// void* alloc(size_t);  //returns 0 when out of memory
 	// void free(void*);     //assumed to not fail
 	// void outOfMemory();   //exit with appropriate out of memory error
+	// void adviseLarge(void*, size_t); //optional hints to the system for (long-lived) cached blocks
+	// void firstTouch(void*, size_t); //place pages of a new block according to thread affinity (if applicable)
+	// int nodeOf(void*); int nodeCurrent(); //NUMA node of a block and of the calling thread (0 if not applicable)
 	template<typename MemSpace> class MemPool
 	{	uint8_t* pool; //pointer to entire pool of memory (allocated once)
+		MemCache<MemSpace> cache; //cache for allocations outside the pool
 		std::mutex lock; //for thread safety
 		//Allocated memory
 		std::map<size_t,size_t> used; //start -> stop
@@ -170,7 +296,7 @@ namespace MemPool
 		{	if(pool) MemSpace::free(pool);
 		}
 		void* alloc(size_t sizeRequested)
-		{	if(!mempoolSize) return MemSpace::alloc(sizeRequested); //pool not in use
+		{	if(!mempoolSize) return cache.alloc(sizeRequested); //pool not in use
 			lock.lock();
 			//Find size adjusted to chunk size:
 			const size_t chunkSize = 4096; //typical page size
@@ -181,9 +307,7 @@ namespace MemPool
 			if(ubound == holesBySize.end())
 			{	//No hole big enough left, so allocate externally:
 				lock.unlock();
-				void* ptr = MemSpace::alloc(sizeRequested);
-				if(!ptr) MemSpace::outOfMemory();
-				return ptr;
+				return cache.alloc(sizeRequested);
 			}
 			else
 			{	//Hole found, so allocate from it:
@@ -196,15 +320,15 @@ namespace MemPool
 				return (void*)(pool+start);
 			}
 		}
-		void free(void* ptr)
-		{	if(!mempoolSize) return MemSpace::free(ptr); //pool not in use
+		void free(void* ptr, size_t sizeRequested)
+		{	if(!mempoolSize) return cache.free(ptr, sizeRequested); //pool not in use
 			lock.lock();
 			//Find in used map:
 			size_t start = ((uint8_t*)ptr) - pool;
 			MapIter usedIter = used.find(start);
 			if(usedIter == used.end())
 			{	//Not found in used => allocated externally
-				MemSpace::free(ptr); //free externally
+				cache.free(ptr, sizeRequested); //free externally
 			}
 			else
 			{	//Found in used => allocated in pool
@@ -214,6 +338,7 @@ namespace MemPool
 			}
 			lock.unlock();
 		}
+		void printStats(const char* spaceName) { cache.printStats(spaceName); }
 	};
 	
 	//---- MemSpace classes for each memory space ----
@@ -226,12 +351,41 @@ namespace MemPool
 		}
 		static void free(void* ptr) { cudaFreeHost(ptr); }
 		static void outOfMemory() die_alone("Host memory allocation failed (out of pinned memory)\n");
+		static void adviseLarge(void* ptr, size_t size) {}
+		static void firstTouch(void* ptr, size_t size) {}
+		static int nodeOf(void* ptr) { return 0; }
+		static int nodeCurrent() { return 0; }
 	};
 	#else
 	struct MemSpaceCPU
 	{	static void* alloc(size_t size) { return fftw_malloc(size); }
 		static void free(void* ptr) { fftw_free(ptr); }
 		static void outOfMemory() die_alone("Memory allocation failed (out of memory)\n");
+		static void adviseLarge(void* ptr, size_t size)
+		{
+			#if defined(__linux__) && defined(MADV_HUGEPAGE)
+			//Request transparent huge pages for the 2MB-aligned interior of large blocks:
+			const size_t hugeSize = size_t(2)<<20;
+			if(size < 2*hugeSize) return;
+			size_t start = ((size_t(ptr) + hugeSize-1) / hugeSize) * hugeSize;
+			size_t stop = ((size_t(ptr) + size) / hugeSize) * hugeSize;
+			if(stop > start) madvise((void*)start, stop-start, MADV_HUGEPAGE);
+			#endif
+		}
+		static void firstTouch_sub(size_t iStart, size_t iStop, char* data)
+		{	const size_t pageSize = 4096;
+			for(size_t i=((iStart+pageSize-1)/pageSize)*pageSize; i<iStop; i+=pageSize)
+				data[i] = 0;
+		}
+		static void firstTouch(void* ptr, size_t size)
+		{	//With pinned threads, touch pages of large blocks with the same partitioning as threadLaunch over their
+			//elements, so that each page is placed on the NUMA node of the thread that will process it.
+			//(Within a thread, this places the whole block on that thread's node.)
+			if(!threadAffinity || size < (size_t(1)<<20)) return;
+			threadLaunch(firstTouch_sub, size, (char*)ptr);
+		}
+		static int nodeOf(void* ptr) { return numaNodeOf(ptr); }
+		static int nodeCurrent() { return numaNodeCurrent(); }
 	};
 	#endif
 	#ifdef GPU_ENABLED
@@ -247,6 +401,10 @@ namespace MemPool
 			cudaFree(ptr);
 		}
 		static void outOfMemory() die_alone("GPU memory allocation failed (out of memory)\n");
+		static void adviseLarge(void* ptr, size_t size) {}
+		static void firstTouch(void* ptr, size_t size) {}
+		static int nodeOf(void* ptr) { return 0; }
+		static int nodeCurrent() { return 0; }
 	};
 	#endif
 	
@@ -262,6 +420,10 @@ namespace MemPool
 
 void ManagedMemoryBase::reportUsage()
 {	MemUsageReport::manager(MemUsageReport::Print);
+	MemPool::CPU().printStats("CPU");
+	#ifdef GPU_ENABLED
+	MemPool::GPU().printStats("GPU");
+	#endif
 }
 
 //Free memory
@@ -270,12 +432,12 @@ void ManagedMemoryBase::memFree()
 	if(onGpu)
 	{
 		#ifdef GPU_ENABLED
-		MemPool::GPU().free(c);
+		MemPool::GPU().free(c, nBytes);
 		#else
 		assert(!"onGpu=true without GPU_ENABLED"); //Should never get here!
 		#endif
 	}
-	else MemPool::CPU().free(c);
+	else MemPool::CPU().free(c, nBytes);
 	MemUsageReport::manager(MemUsageReport::Remove, category, nBytes);
 	onGpu = false;
 	c = 0;
@@ -318,7 +480,7 @@ void ManagedMemoryBase::toCpu() const
 	ManagedMemoryBase& me = *((ManagedMemoryBase*)this);
 	void* cCpu = MemPool::CPU().alloc(nBytes);
 	cudaMemcpy(cCpu, me.c, nBytes, cudaMemcpyDeviceToHost);
-	MemPool::GPU().free(me.c); //Free GPU mem
+	MemPool::GPU().free(me.c, nBytes); //Free GPU mem
 	me.c = cCpu; //Make c a cpu pointer
 	me.onGpu = false;
 #endif
@@ -332,7 +494,7 @@ void ManagedMemoryBase::toGpu() const
 	ManagedMemoryBase& me = *((ManagedMemoryBase*)this);
 	void* cGpu = MemPool::GPU().alloc(nBytes);
 	cudaMemcpy(cGpu, me.c, nBytes, cudaMemcpyHostToDevice);
-	MemPool::CPU().free(me.c); //Free CPU mem
+	MemPool::CPU().free(me.c, nBytes); //Free CPU mem
 	me.c = cGpu; //Make c a gpu pointer
 	me.onGpu = true;
 #else
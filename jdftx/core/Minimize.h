@@ -65,9 +65,19 @@ template<typename Vector> struct Minimizable
 	//! Override to return maximum safe step size along a given direction. Steps can be arbitrarily large by default.
 	virtual double safeStepSize(const Vector& dir) const { return DBL_MAX; }
 	
+	//! Override to return the accuracy of the values returned by compute (eg. if it involves an inexact inner minimization).
+	//! Line minimizers do not reject steps on the basis of energy changes within this tolerance.
+	virtual double computeTolerance() const { return 0.; }
+	
+	//! Override to make subsequent values returned by compute more accurate; return whether that was possible.
+	//! Called when a step fails along the gradient direction, before giving up on the minimization.
+	virtual bool tightenComputeTolerance() { return false; }
+	
 	//! Minimize this objective function with algorithm controlled by params and return the minimized value
 	double minimize(const MinimizeParams& params);
 	
+	bool converged; //!< whether the most recent minimize() met a convergence criterion (rather than stopping at nIterations or on failure)
+	
 	//! Checks the consistency of the value and gradient returned by compute.
 	//! params is used primarily to control output
 	void fdTest(const MinimizeParams& params);
@@ -76,6 +86,7 @@ private:
 	typedef bool (*Linmin)(Minimizable<Vector>&, const MinimizeParams&, const Vector&, double, double&, double&, Vector&, Vector&);
 	Linmin getLinmin(const MinimizeParams& params) const; //!< Return function pointer to appropriate linmin method based on MinimizeParams
 	double lBFGS(const MinimizeParams& params); //!< limited memory BFGS implementation (differs sufficiently from CG to be justify a separate implementation)
+	double fire(const MinimizeParams& params); //!< fast inertial relaxation engine (damped dynamics without line minimization)
 };
 
 /** Interface (abstract base class) for linear conjugate gradients template which
@@ -117,10 +128,13 @@ public:
 
 #include <core/Minimize_linmin.h>
 #include <core/Minimize_lBFGS.h>
+#include <core/Minimize_FIRE.h>
 
 template<typename Vector> double Minimizable<Vector>::minimize(const MinimizeParams& p)
-{	if(p.fdTest) fdTest(p); // finite difference test
+{	converged = false;
+	if(p.fdTest) fdTest(p); // finite difference test
 	if(p.dirUpdateScheme == MinimizeParams::LBFGS) return lBFGS(p);
+	if(p.dirUpdateScheme == MinimizeParams::FIRE) return fire(p);
 	
 	Vector g, gPrev, Kg; //current, previous and preconditioned gradients
 	double E = sync(compute(&g, &Kg)); //get initial energy and gradient
@@ -181,7 +195,8 @@ template<typename Vector> double Minimizable<Vector>::minimize(const MinimizePar
 				case MinimizeParams::PolakRibiere:    beta = (gKNorm-dotgPrevKg)/gKNormPrev; break;
 				case MinimizeParams::HestenesStiefel: beta = (gKNorm-dotgPrevKg)/(dotgd-sync(dot(d,gPrev))); break;
 				case MinimizeParams::SteepestDescent: beta = 0.0; break;
-				case MinimizeParams::LBFGS: break; //Should never encounter since LBFGS handled separately; just to eliminate compiler warnings
+				case MinimizeParams::LBFGS: //Should never encounter since LBFGS and FIRE handled separately; just to eliminate compiler warnings
+				case MinimizeParams::FIRE: break;
 			}
 			if(beta<0.0)
 			{	fprintf(p.fpLog, "\n%sEncountered beta<0, resetting CG.", p.linePrefix);
@@ -192,12 +207,12 @@ template<typename Vector> double Minimizable<Vector>::minimize(const MinimizePar
 		fprintf(p.fpLog, "\n"); fflush(p.fpLog);
 		if(sqrt(gKNorm/p.nDim) < p.knormThreshold)
 		{	fprintf(p.fpLog, "%sConverged (|grad|_K<%le).\n", p.linePrefix, p.knormThreshold);
-			fflush(p.fpLog); return E;
+			fflush(p.fpLog); converged = true; return E;
 		}
 		if(ediffCheck.checkConvergence(E))
 		{	fprintf(p.fpLog, "%sConverged (|Delta %s|<%le for %d iters).\n",
 				p.linePrefix, p.energyLabel, p.energyDiffThreshold, p.nEnergyDiff);
-			fflush(p.fpLog); return E;
+			fflush(p.fpLog); converged = true; return E;
 		}
 		if(!std::isfinite(gKNorm))
 		{	fprintf(p.fpLog, "%s|grad|_K=%le. Stopping ...\n", p.linePrefix, gKNorm);
@@ -236,6 +251,13 @@ template<typename Vector> double Minimizable<Vector>::minimize(const MinimizePar
 				fflush(p.fpLog);
 				forceGradDirection = true; //reset search direction
 			}
+			else if(tightenComputeTolerance())
+			{	//Failed along the gradient direction, possibly due to inaccurate energies:
+				fprintf(p.fpLog, "%s\tStep failed along negative gradient direction: retrying with tighter inner convergence.\n", p.linePrefix);
+				fflush(p.fpLog);
+				E = sync(compute(&g, &Kg));
+				forceGradDirection = true; //reset search direction
+			}
 			else
 			{	//Failed along the gradient direction
 				fprintf(p.fpLog, "%s\tStep failed along negative gradient direction.\n", p.linePrefix);
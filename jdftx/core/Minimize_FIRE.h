@@ -0,0 +1,137 @@
+/*-------------------------------------------------------------------
+Copyright 2026 JDFTx contributors
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+
+#ifndef JDFTX_CORE_MINIMIZE_FIRE_H
+#define JDFTX_CORE_MINIMIZE_FIRE_H
+
+//! @addtogroup Algorithms
+//! @{
+
+//! Fast inertial relaxation engine (FIRE) following \cite FIRE, using the preconditioned gradient as the force.
+//! The initial time step is alphaTstart, and is allowed to grow up to 10 times that value.
+//! Robust for rough starting points, since it requires no line minimization (only finite energies).
+template<typename Vector> double Minimizable<Vector>::fire(const MinimizeParams& p)
+{	//Standard parameters from the reference:
+	const int nMin = 5; //number of downhill steps before accelerating
+	const double fInc = 1.1, fDec = 0.5; //time step increase and decrease factors
+	const double aStart = 0.1, fA = 0.99; //initial velocity-mixing parameter and its decay factor
+	const double dtMax = 10.*p.alphaTstart; //maximum time step
+	
+	Vector g, Kg; //gradient and preconditioned gradient
+	double E = sync(compute(&g, &Kg)); //get initial energy and gradient
+	EdiffCheck ediffCheck(p.nEnergyDiff, p.energyDiffThreshold); //list of past energies
+	
+	Vector v = clone(Kg); v *= 0.; //velocity
+	bool vZero = true; //whether v is zero (initially and after a reset)
+	double dt = p.alphaTstart, a = aStart;
+	int nPositive = 0; //number of successive steps with positive power
+	
+	//Iterate until convergence, max iteration count or kill signal
+	int iter=0;
+	for(iter=0; !killFlag; iter++)
+	{	
+		if(report(iter)) //optional reporting/processing
+		{	E = sync(compute(&g, &Kg)); //update energy and gradient if state was modified
+			fprintf(p.fpLog, "%s\tState modified externally: resetting velocity.\n", p.linePrefix);
+			fflush(p.fpLog);
+			v *= 0.;
+			vZero = true;
+		}
+		
+		double gKnorm = sync(dot(g,Kg));
+		fprintf(p.fpLog, "%sIter: %3d  %s: ", p.linePrefix, iter, p.energyLabel);
+		fprintf(p.fpLog, p.energyFormat, E);
+		fprintf(p.fpLog, "  |grad|_K: %10.3le  dt: %10.3le  t[s]: %9.2lf\n", sqrt(gKnorm/p.nDim), dt, clock_sec());
+		fflush(p.fpLog);
+		
+		//Check stopping conditions:
+		if(sqrt(gKnorm/p.nDim) < p.knormThreshold)
+		{	fprintf(p.fpLog, "%sConverged (|grad|_K<%le).\n", p.linePrefix, p.knormThreshold);
+			fflush(p.fpLog); converged = true; return E;
+		}
+		if(ediffCheck.checkConvergence(E))
+		{	fprintf(p.fpLog, "%sConverged (|Delta %s|<%le for %d iters).\n",
+				p.linePrefix, p.energyLabel, p.energyDiffThreshold, p.nEnergyDiff);
+			fflush(p.fpLog); converged = true; return E;
+		}
+		if(!std::isfinite(gKnorm))
+		{	fprintf(p.fpLog, "%s|grad|_K=%le. Stopping ...\n", p.linePrefix, gKnorm);
+			fflush(p.fpLog); return E;
+		}
+		if(!std::isfinite(E))
+		{	fprintf(p.fpLog, "%sE=%le. Stopping ...\n", p.linePrefix, E);
+			fflush(p.fpLog); return E;
+		}
+		if(iter>=p.nIterations) break;
+		
+		//Force (negative preconditioned gradient) and power:
+		Vector F = clone(Kg); F *= -1.;
+		constrain(F);
+		if(!vZero) //power test only once moving (v is zero initially and after a reset)
+		{	double power = -sync(dot(g,v));
+			if(power > 0.)
+			{	//Mix velocity towards force direction:
+				double vNorm = sqrt(sync(dot(v,v))), FNorm = sqrt(sync(dot(F,F)));
+				v *= (1.-a);
+				if(FNorm) axpy(a*vNorm/FNorm, F, v);
+				if(++nPositive > nMin)
+				{	dt = std::min(dt*fInc, dtMax);
+					a *= fA;
+				}
+			}
+			else
+			{	//Going uphill: stop and slow down:
+				v *= 0.;
+				dt *= fDec;
+				a = aStart;
+				nPositive = 0;
+			}
+		}
+		if(dt < p.alphaTmin)
+		{	fprintf(p.fpLog, "%sTime step below threshold %le. Stopping ...\n", p.linePrefix, p.alphaTmin);
+			fflush(p.fpLog); return E;
+		}
+		
+		//Semi-implicit Euler step:
+		axpy(dt, F, v);
+		constrain(v);
+		vZero = false;
+		double dtStep = std::min(dt, safeStepSize(v));
+		step(v, dtStep);
+		E = sync(compute(&g, &Kg));
+		if(!std::isfinite(E))
+		{	//Undo step and restart with smaller time step:
+			fprintf(p.fpLog, "%s\tStep failed with %s = %le: undoing step and reducing time step.\n", p.linePrefix, p.energyLabel, E);
+			fflush(p.fpLog);
+			step(v, -dtStep);
+			E = sync(compute(&g, &Kg));
+			v *= 0.;
+			vZero = true;
+			dt *= fDec;
+			a = aStart;
+			nPositive = 0;
+		}
+	}
+	fprintf(p.fpLog, "%sNone of the convergence criteria satisfied after %d iterations.\n", p.linePrefix, iter);
+	return E;
+}
+
+//! @}
+#endif //JDFTX_CORE_MINIMIZE_FIRE_H
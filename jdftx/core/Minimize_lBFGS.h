@@ -73,12 +73,12 @@ template<typename Vector> double Minimizable<Vector>::lBFGS(const MinimizeParams
 		fprintf(p.fpLog, "\n"); fflush(p.fpLog);
 		if(sqrt(gKnorm/p.nDim) < p.knormThreshold)
 		{	fprintf(p.fpLog, "%sConverged (|grad|_K<%le).\n", p.linePrefix, p.knormThreshold);
-			fflush(p.fpLog); return E;
+			fflush(p.fpLog); converged = true; return E;
 		}
 		if(ediffCheck.checkConvergence(E))
 		{	fprintf(p.fpLog, "%sConverged (|Delta %s|<%le for %d iters).\n",
 				p.linePrefix, p.energyLabel, p.energyDiffThreshold, p.nEnergyDiff);
-			fflush(p.fpLog); return E;
+			fflush(p.fpLog); converged = true; return E;
 		}
 		if(!std::isfinite(gKnorm))
 		{	fprintf(p.fpLog, "%s|grad|_K=%le. Stopping ...\n", p.linePrefix, gKnorm);
@@ -128,6 +128,13 @@ template<typename Vector> double Minimizable<Vector>::lBFGS(const MinimizeParams
 				linminTest = 0.;
 				continue;
 			}
+			else if(tightenComputeTolerance())
+			{	//Failed along the gradient direction, possibly due to inaccurate energies:
+				fprintf(p.fpLog, "%s\tStep failed along negative gradient direction: retrying with tighter inner convergence.\n", p.linePrefix);
+				fflush(p.fpLog);
+				E = sync(compute(&g, &Kg));
+				continue;
+			}
 			else
 			{	//Failed along the gradient direction
 				fprintf(p.fpLog, "%s\tStep failed along negative gradient direction.\n", p.linePrefix);
@@ -56,6 +56,7 @@ namespace MinimizeLinmin
 	{
 		double alphaPrev = 0.0; //the progress made so far along d
 		double Eorig = E;
+		double Etol = obj.computeTolerance(); //energy increases smaller than this are not resolvable
 		double gdotd = obj.sync(dot(g,d)); //directional derivative at starting point
 		if(gdotd >= 0.0)
 		{	fprintf(p.fpLog, "%s\tBad step direction: g.d > 0.\n", p.linePrefix); fflush(p.fpLog);
@@ -124,7 +125,7 @@ namespace MinimizeLinmin
 					p.linePrefix, p.energyLabel, E, alpha); fflush(p.fpLog);
 				continue;
 			}
-			if(E > Eorig)
+			if(E > Eorig + Etol)
 			{	alpha *= p.alphaTreduceFactor;
 				fprintf(p.fpLog, "%s\tStep increased %s by %le, reducing alpha to %le.\n",
 					p.linePrefix, p.energyLabel, E-Eorig, alpha); fflush(p.fpLog);
@@ -133,7 +134,7 @@ namespace MinimizeLinmin
 			//Step successful:
 			break;
 		}
-		if(!std::isfinite(E) || E>Eorig)
+		if(!std::isfinite(E) || E>Eorig+Etol)
 		{	fprintf(p.fpLog, "%s\tStep failed to reduce %s after %d attempts. Quitting step.\n",
 				p.linePrefix, p.energyLabel, p.nAlphaAdjustMax); fflush(p.fpLog);
 			return false;
@@ -155,6 +156,7 @@ namespace MinimizeLinmin
 			return false;
 		}
 		double E0 = Eprev, gdotd0 =gdotdPrev; //Always use initial energy and gradient for Wolfe test (even if part of line search has been committed)
+		double Etol = obj.computeTolerance(); //energy increases smaller than this are not resolvable
 		
 		alpha = alphaT; //this is the initial tentative step
 		double alphaPrev = 0; //alpha of the other point in the cubic interval
@@ -202,7 +204,7 @@ namespace MinimizeLinmin
 			}
 			double alphaNew = alphaPrev + tMin*(alpha-alphaPrev);
 			//Check if we're done (Wolfe conditions):
-			if(E <= E0 + p.wolfeEnergy*alpha*gdotd0 && gdotd >= p.wolfeGradient*gdotd0)
+			if(E <= E0 + p.wolfeEnergy*alpha*gdotd0 + Etol && gdotd >= p.wolfeGradient*gdotd0)
 			{	if(p.updateTestStepSize) alphaT = alphaNew; //save computed optimum step size for next time
 				return true;
 			}
@@ -213,7 +215,7 @@ namespace MinimizeLinmin
 			alpha = alphaNew; //set the alpha chosen above as the other endpoint for the next cubic
 		}
 		//Check if current state is invalid or worse than starting point:
-		if(!std::isfinite(E) || E>E0) return false; //minimize will roll back to the last known good state
+		if(!std::isfinite(E) || E>E0+Etol) return false; //minimize will roll back to the last known good state
 		else return true;
 	}
 }
@@ -42,6 +42,8 @@ public:
 	//! @return Energy at final cycle
 	double minimize(double Eprev=+DBL_MAX, std::vector<string> extraNames=std::vector<string>(), std::vector<double> extraThresh=std::vector<double>());
 	
+	bool converged; //!< whether the most recent minimize() met a convergence criterion (rather than stopping at nIterations or on failure)
+	
 	void loadState(const char* filename); //!< Load the state from a single binary file
 	void saveState(const char* filename) const; //!< Save the state to a single binary file
 	void clearState(); //!< remove past variables and residuals
@@ -116,6 +118,7 @@ template<typename Variable> Pulay<Variable>::Pulay(const PulayParams& pp)
 
 template<typename Variable> double Pulay<Variable>::minimize(double Eprev, std::vector<string> extraNames, std::vector<double> extraThresh)
 {
+	converged = false;
 	double E = sync(Eprev); Eprev = 0.;
 	double dE = E-Eprev;
 	assert(extraNames.size()==extraThresh.size());
@@ -173,7 +176,6 @@ template<typename Variable> double Pulay<Variable>::minimize(double Eprev, std::
 		{	fprintf(pp.fpLog, "%sE=%le. Stopping ...\n\n", pp.linePrefix, E);
 			return E;
 		}
-		bool converged = false;
 		if(!converged && ediffCheck.checkConvergence(E))
 		{	fprintf(pp.fpLog, "%sConverged (|Delta E|<%le for 2 iters).\n\n", pp.linePrefix, pp.energyDiffThreshold);
 			converged = true;
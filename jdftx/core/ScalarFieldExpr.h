@@ -0,0 +1,247 @@
+/*-------------------------------------------------------------------
+Copyright 2026 JDFTx contributors
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#ifndef JDFTX_CORE_SCALARFIELDEXPR_H
+#define JDFTX_CORE_SCALARFIELDEXPR_H
+
+//! @addtogroup Operators
+//! @{
+
+/** @file ScalarFieldExpr.h
+@brief Lazy (fused) elementwise arithmetic on scalar fields
+
+Each of the operators in Operators.h makes a full pass over the grid and allocates
+a new field for its result, so that a chain of elementwise operations makes several
+passes and allocations. Wrapping an operand in lazy() instead builds an expression
+(analogous to scaled<T> for pending scale factors) from the same operators, which is
+evaluated in a single threaded pass over the grid when it is converted to a field,
+or accumulated into an existing field using +=, -= or *=. For example:
+
+	ScalarField y = inv(lazy(E)) * (a + sqrt(lazy(b)*b + 3.*E));
+
+allocates only y. Expressions hold references to their input fields, and may be
+stored (eg. with auto) and reused in other expressions before evaluation.
+In GPU builds, expressions are evaluated using the regular (unfused) operators.
+*/
+
+#include <core/Operators.h>
+#include <core/Thread.h>
+#include <utility>
+
+//! Base class of all lazy field expressions (curiously recurring template pattern)
+template<typename E> struct FieldExpr
+{	const E& self() const { return static_cast<const E&>(*this); } //!< cast to the actual expression type
+};
+
+template<typename E> typename E::FieldType evaluate(const FieldExpr<E>& expr); //!< Evaluate expression in a single pass (into a new field)
+
+//! Field operand of a lazy field expression
+template<typename T> struct FieldExprLeaf : public FieldExpr<FieldExprLeaf<T>>
+{	typedef std::shared_ptr<T> FieldType; //!< type of field resulting from evaluation
+	typedef typename T::DataType ValueType; //!< type of each element
+
+	FieldExprLeaf(const FieldType& X) : X(X), data(0), scale(X->scale)
+	{
+		#ifndef GPU_ENABLED
+		data = ((const T&)(*X)).data(false);
+		#endif
+	}
+	inline ValueType operator()(size_t i) const { return scale * data[i]; }
+	const GridInfo* gInfo() const { return &X->gInfo; }
+	size_t nElem() const { return X->nElem; }
+	const FieldType& materialize() const { return X; }
+	operator FieldType() const { return clone(X); }
+private:
+	FieldType X;
+	const ValueType* data;
+	double scale;
+};
+
+//! Constant operand of a lazy field expression
+struct FieldExprConst : public FieldExpr<FieldExprConst>
+{	typedef double FieldType;
+	typedef double ValueType;
+
+	FieldExprConst(double c) : c(c) {}
+	inline double operator()(size_t i) const { return c; }
+	const GridInfo* gInfo() const { return 0; }
+	size_t nElem() const { return 0; }
+	double materialize() const { return c; }
+private:
+	double c;
+};
+
+//! Elementwise unary function Op applied to lazy field expression E
+template<typename Op, typename E> struct FieldExprUnary : public FieldExpr<FieldExprUnary<Op,E>>
+{	typedef decltype(std::declval<Op>()(std::declval<typename E::FieldType>())) FieldType;
+	typedef decltype(std::declval<Op>()(std::declval<typename E::ValueType>())) ValueType;
+
+	FieldExprUnary(const Op& op, const E& a) : op(op), a(a) {}
+	inline ValueType operator()(size_t i) const { return op(a(i)); }
+	const GridInfo* gInfo() const { return a.gInfo(); }
+	size_t nElem() const { return a.nElem(); }
+	FieldType materialize() const { return op(a.materialize()); }
+	operator FieldType() const { return evaluate(*this); }
+private:
+	Op op;
+	E a;
+};
+
+//! Elementwise binary operator Op applied to lazy field expressions E1 and E2
+template<typename Op, typename E1, typename E2> struct FieldExprBinary : public FieldExpr<FieldExprBinary<Op,E1,E2>>
+{	typedef decltype(std::declval<Op>()(std::declval<typename E1::FieldType>(), std::declval<typename E2::FieldType>())) FieldType;
+	typedef decltype(std::declval<Op>()(std::declval<typename E1::ValueType>(), std::declval<typename E2::ValueType>())) ValueType;
+
+	FieldExprBinary(const E1& a, const E2& b) : a(a), b(b) {}
+	inline ValueType operator()(size_t i) const { return Op()(a(i), b(i)); }
+	const GridInfo* gInfo() const { return a.gInfo() ? a.gInfo() : b.gInfo(); }
+	size_t nElem() const { return a.gInfo() ? a.nElem() : b.nElem(); }
+	FieldType materialize() const { return Op()(a.materialize(), b.materialize()); }
+	operator FieldType() const { return evaluate(*this); }
+private:
+	E1 a;
+	E2 b;
+};
+
+//! Start a lazy field expression with field X
+template<typename T> FieldExprLeaf<T> lazy(const std::shared_ptr<T>& X) { return FieldExprLeaf<T>(X); }
+
+//! @}
+
+//!@cond
+
+//Operations applicable both to elements and to fields (the latter, and update(), for evaluation in GPU mode):
+struct FieldOpAdd
+{	template<typename A, typename B> auto operator()(const A& a, const B& b) const -> decltype(a+b) { return a+b; }
+	template<typename A, typename B> static void update(A& a, const B& b) { a += b; }
+};
+struct FieldOpSub
+{	template<typename A, typename B> auto operator()(const A& a, const B& b) const -> decltype(a-b) { return a-b; }
+	template<typename A, typename B> static void update(A& a, const B& b) { a -= b; }
+};
+struct FieldOpMul
+{	template<typename A, typename B> auto operator()(const A& a, const B& b) const -> decltype(a*b) { return a*b; }
+	template<typename A, typename B> static void update(A& a, const B& b) { a *= b; }
+};
+struct FieldOpDiv
+{	template<typename A, typename B> auto operator()(const A& a, const B& b) const -> decltype(a/b) { return a/b; }
+	ScalarField operator()(const ScalarField& a, const ScalarField& b) const { return a * inv(b); }
+	ScalarField operator()(const ScalarField& a, double b) const { return a * (1./b); }
+	ScalarField operator()(double a, const ScalarField& b) const { return a * inv(b); }
+	complexScalarField operator()(const complexScalarField& a, const ScalarField& b) const { return a * inv(b); }
+	complexScalarField operator()(const complexScalarField& a, double b) const { return a * (1./b); }
+};
+struct FieldOpNeg { template<typename A> auto operator()(const A& a) const -> decltype(-a) { return -a; } };
+#define DECLARE_FieldOp(name, func) \
+	struct FieldOp##name \
+	{	double operator()(double x) const { return func(x); } \
+		ScalarField operator()(const ScalarField& x) const { return func(x); } \
+	};
+DECLARE_FieldOp(Exp, exp)
+DECLARE_FieldOp(Log, log)
+DECLARE_FieldOp(Sqrt, sqrt)
+#undef DECLARE_FieldOp
+struct FieldOpInv
+{	double operator()(double x) const { return 1./x; }
+	ScalarField operator()(const ScalarField& x) const { return inv(x); }
+};
+struct FieldOpPow
+{	double alpha;
+	double operator()(double x) const { return pow(x, alpha); }
+	ScalarField operator()(const ScalarField& x) const { return pow(x, alpha); }
+};
+
+//Binary operators between expressions, fields and scalars:
+#define DECLARE_FieldExprBinary(op, Op) \
+	template<typename E1, typename E2> FieldExprBinary<Op,E1,E2> operator op(const FieldExpr<E1>& a, const FieldExpr<E2>& b) \
+	{	return FieldExprBinary<Op,E1,E2>(a.self(), b.self()); \
+	} \
+	template<typename E, typename T> FieldExprBinary<Op,E,FieldExprLeaf<T>> operator op(const FieldExpr<E>& a, const std::shared_ptr<T>& b) \
+	{	return FieldExprBinary<Op,E,FieldExprLeaf<T>>(a.self(), FieldExprLeaf<T>(b)); \
+	} \
+	template<typename T, typename E> FieldExprBinary<Op,FieldExprLeaf<T>,E> operator op(const std::shared_ptr<T>& a, const FieldExpr<E>& b) \
+	{	return FieldExprBinary<Op,FieldExprLeaf<T>,E>(FieldExprLeaf<T>(a), b.self()); \
+	} \
+	template<typename E> FieldExprBinary<Op,E,FieldExprConst> operator op(const FieldExpr<E>& a, double b) \
+	{	return FieldExprBinary<Op,E,FieldExprConst>(a.self(), FieldExprConst(b)); \
+	} \
+	template<typename E> FieldExprBinary<Op,FieldExprConst,E> operator op(double a, const FieldExpr<E>& b) \
+	{	return FieldExprBinary<Op,FieldExprConst,E>(FieldExprConst(a), b.self()); \
+	}
+DECLARE_FieldExprBinary(+, FieldOpAdd)
+DECLARE_FieldExprBinary(-, FieldOpSub)
+DECLARE_FieldExprBinary(*, FieldOpMul)
+DECLARE_FieldExprBinary(/, FieldOpDiv)
+#undef DECLARE_FieldExprBinary
+
+//Elementwise functions of expressions:
+template<typename E> FieldExprUnary<FieldOpNeg,E> operator-(const FieldExpr<E>& a) { return FieldExprUnary<FieldOpNeg,E>(FieldOpNeg(), a.self()); }
+template<typename E> FieldExprUnary<FieldOpExp,E> exp(const FieldExpr<E>& a) { return FieldExprUnary<FieldOpExp,E>(FieldOpExp(), a.self()); }
+template<typename E> FieldExprUnary<FieldOpLog,E> log(const FieldExpr<E>& a) { return FieldExprUnary<FieldOpLog,E>(FieldOpLog(), a.self()); }
+template<typename E> FieldExprUnary<FieldOpSqrt,E> sqrt(const FieldExpr<E>& a) { return FieldExprUnary<FieldOpSqrt,E>(FieldOpSqrt(), a.self()); }
+template<typename E> FieldExprUnary<FieldOpInv,E> inv(const FieldExpr<E>& a) { return FieldExprUnary<FieldOpInv,E>(FieldOpInv(), a.self()); }
+template<typename E> FieldExprUnary<FieldOpPow,E> pow(const FieldExpr<E>& a, double alpha) { return FieldExprUnary<FieldOpPow,E>(FieldOpPow{alpha}, a.self()); }
+
+//Single-pass evaluation and update:
+template<typename E> void evaluate_sub(size_t iStart, size_t iStop, const E* expr, typename E::ValueType* out)
+{	for(size_t i=iStart; i<iStop; i++) out[i] = (*expr)(i);
+}
+template<typename Op, typename E, typename ValueType> void evaluateUpdate_sub(size_t iStart, size_t iStop, const E* expr, double outScale, ValueType* out)
+{	for(size_t i=iStart; i<iStop; i++) out[i] = Op()(outScale * out[i], (*expr)(i));
+}
+
+template<typename E> typename E::FieldType evaluate(const FieldExpr<E>& exprBase)
+{	const E& expr = exprBase.self();
+	#ifdef GPU_ENABLED
+	return expr.materialize();
+	#else
+	typedef typename E::FieldType::element_type FieldData;
+	typename E::FieldType out = FieldData::alloc(*expr.gInfo());
+	threadLaunch(evaluate_sub<E>, expr.nElem(), &expr, out->data(false));
+	return out;
+	#endif
+}
+
+template<typename Op, typename T, typename E> std::shared_ptr<T>& evaluateUpdate(std::shared_ptr<T>& X, const FieldExpr<E>& exprBase)
+{	const E& expr = exprBase.self();
+	assert(X);
+	#ifdef GPU_ENABLED
+	Op::update(X, expr.materialize());
+	#else
+	assert(X->nElem == int(expr.nElem()));
+	//Absorb scale factor of X during the update (since X may also be an operand in expr with its scale factor pending):
+	threadLaunch(evaluateUpdate_sub<Op,E,typename T::DataType>, expr.nElem(), &expr, X->scale, X->data(false));
+	X->scale = 1.;
+	#endif
+	return X;
+}
+template<typename T, typename E> std::shared_ptr<T>& operator+=(std::shared_ptr<T>& X, const FieldExpr<E>& expr)
+{	if(!X) { X = evaluate(expr); return X; } //null fields are treated as zero
+	return evaluateUpdate<FieldOpAdd>(X, expr);
+}
+template<typename T, typename E> std::shared_ptr<T>& operator-=(std::shared_ptr<T>& X, const FieldExpr<E>& expr)
+{	if(!X) { X = evaluate(-expr); return X; } //null fields are treated as zero
+	return evaluateUpdate<FieldOpSub>(X, expr);
+}
+template<typename T, typename E> std::shared_ptr<T>& operator*=(std::shared_ptr<T>& X, const FieldExpr<E>& expr)
+{	return evaluateUpdate<FieldOpMul>(X, expr);
+}
+
+//!@endcond
+#endif //JDFTX_CORE_SCALARFIELDEXPR_H
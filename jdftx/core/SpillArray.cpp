@@ -0,0 +1,118 @@
+/*-------------------------------------------------------------------
+Copyright 2026 JDFTx contributors
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+
+#include <core/SpillArray.h>
+#include <core/Util.h>
+#include <mutex>
+#include <list>
+#include <cstdlib>
+#include <sys/mman.h>
+
+struct SpillArray::Storage
+{	//Book-keeping of in-memory arrays, in order of allocation:
+	static std::mutex lock;
+	static size_t memoryLimit; //limit on in-memory bytes (0 = unlimited)
+	static size_t nBytesResident; //current in-memory bytes
+	static string scratchDir;
+	static std::list<Storage*> resident; //in-memory arrays, oldest first
+	
+	double* ptr;
+	size_t nBytes;
+	bool spilled; //whether ptr is mapped from a scratch file
+	std::list<Storage*>::iterator residentIter; //location in resident list (if not spilled)
+	
+	Storage(size_t n) : ptr(0), nBytes(n*sizeof(double)), spilled(false)
+	{	if(!nBytes) return;
+		ptr = (double*)malloc(nBytes);
+		if(!ptr) die_alone("Memory allocation failed (out of memory)\n");
+		std::lock_guard<std::mutex> guard(lock);
+		residentIter = resident.insert(resident.end(), this);
+		nBytesResident += nBytes;
+		//Spill oldest arrays (other than this one) if over the limit:
+		while(memoryLimit && nBytesResident > memoryLimit && resident.front() != this)
+			if(!resident.front()->spill()) break;
+	}
+	
+	~Storage()
+	{	if(!nBytes) return;
+		if(spilled) munmap(ptr, nBytes);
+		else
+		{	free(ptr);
+			std::lock_guard<std::mutex> guard(lock);
+			resident.erase(residentIter);
+			nBytesResident -= nBytes;
+		}
+	}
+	
+	//Move data to a scratch file (called with registry lock held); return false on failure
+	bool spill()
+	{	string fname = scratchDir + "/jdftx-spill-XXXXXX";
+		int fd = mkstemp(&fname[0]);
+		if(fd < 0) return false;
+		unlink(fname.c_str()); //file is removed once unmapped
+		void* mapped = MAP_FAILED;
+		if(ftruncate(fd, nBytes) == 0)
+			mapped = mmap(0, nBytes, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+		close(fd); //mapping persists
+		if(mapped == MAP_FAILED) return false;
+		memcpy(mapped, ptr, nBytes);
+		free(ptr);
+		ptr = (double*)mapped;
+		spilled = true;
+		resident.erase(residentIter);
+		nBytesResident -= nBytes;
+		return true;
+	}
+};
+std::mutex SpillArray::Storage::lock;
+size_t SpillArray::Storage::memoryLimit = 0;
+size_t SpillArray::Storage::nBytesResident = 0;
+string SpillArray::Storage::scratchDir;
+std::list<SpillArray::Storage*> SpillArray::Storage::resident;
+
+SpillArray::SpillArray(size_t n) : n(n), storage(new Storage(n)) {}
+SpillArray::SpillArray(const SpillArray& other) : n(other.n), storage(new Storage(other.n)) { if(n) memcpy(data(), other.data(), n*sizeof(double)); }
+SpillArray::SpillArray(SpillArray&& other) : n(other.n), storage(std::move(other.storage)) { other.n = 0; }
+SpillArray::~SpillArray() {}
+
+SpillArray& SpillArray::operator=(const SpillArray& other)
+{	if(this != &other) *this = SpillArray(other);
+	return *this;
+}
+
+SpillArray& SpillArray::operator=(SpillArray&& other)
+{	std::swap(n, other.n);
+	std::swap(storage, other.storage);
+	return *this;
+}
+
+double* SpillArray::data() { return storage ? storage->ptr : 0; }
+const double* SpillArray::data() const { return storage ? storage->ptr : 0; }
+void SpillArray::zero() { if(n) memset(data(), 0, n*sizeof(double)); }
+
+void SpillArray::setMemoryLimit(size_t nBytes, string scratchDir)
+{	std::lock_guard<std::mutex> guard(Storage::lock);
+	Storage::memoryLimit = nBytes;
+	if(!scratchDir.length())
+	{	const char* tmpdir = getenv("TMPDIR");
+		scratchDir = tmpdir ? tmpdir : "/tmp";
+	}
+	Storage::scratchDir = scratchDir;
+}
@@ -0,0 +1,64 @@
+/*-------------------------------------------------------------------
+Copyright 2026 JDFTx contributors
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#ifndef JDFTX_CORE_SPILLARRAY_H
+#define JDFTX_CORE_SPILLARRAY_H
+
+#include <core/string.h>
+#include <memory>
+
+//! @addtogroup Utilities
+//! @{
+
+/**
+@brief Array of doubles that may be spilled to a memory-mapped scratch file
+
+Intended for long histories of large vectors (eg. Pulay mixing), only a few of which are
+accessed at a time. Arrays are allocated in memory, but whenever the total size of in-memory
+arrays exceeds the limit set by setMemoryLimit(), the oldest arrays are moved to (unlinked)
+scratch files mapped into memory, which the system pages in and out as needed.
+Copies are deep, while moves are cheap.
+*/
+class SpillArray
+{
+public:
+	SpillArray(size_t n=0); //!< allocate (uninitialized) array of length n
+	SpillArray(const SpillArray&);
+	SpillArray(SpillArray&&);
+	SpillArray& operator=(const SpillArray&);
+	SpillArray& operator=(SpillArray&&);
+	~SpillArray();
+	
+	size_t size() const { return n; } //!< number of elements
+	double* data(); //!< pointer to data (in memory, or mapped from the scratch file)
+	const double* data() const; //!< pointer to data (in memory, or mapped from the scratch file)
+	void zero(); //!< set all elements to zero
+	
+	//! Set the limit on the total bytes of arrays held in memory (0 = unlimited),
+	//! and the directory for scratch files (default: $TMPDIR, or else /tmp)
+	static void setMemoryLimit(size_t nBytes, string scratchDir=string());
+	
+private:
+	size_t n; //!< number of elements
+	struct Storage;
+	std::unique_ptr<Storage> storage; //!< heap-allocated so that its address is fixed (tracked for spilling)
+};
+
+//! @}
+#endif //JDFTX_CORE_SPILLARRAY_H
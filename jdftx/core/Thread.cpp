@@ -26,6 +26,14 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #if defined(MKL_PROVIDES_BLAS) || defined(MKL_PROVIDES_FFT)
 #include <mkl.h>
 #endif
+#if defined(__linux__)
+#include <sched.h>
+#include <pthread.h>
+#include <dirent.h>
+#include <sys/syscall.h>
+#endif
+#include <algorithm>
+#include <set>
 
 int getPhysicalCores()
 {	FILE* pp = popen("awk '$1==\"physical\" && $2==\"id\" && !ID[$4] { PROCS++; ID[$4]=1; } $1=\"cpu\" && $2==\"cores\" { CORES=$4; }  END { print PROCS*CORES }' /proc/cpuinfo 2>/dev/null", "r");
@@ -62,3 +70,195 @@ void resumeOperatorThreading()
 	#endif
 	#endif
 }
+
+
+//---------- Thread affinity ----------
+
+bool threadAffinity = false;
+
+namespace ThreadAffinity
+{	struct Cpu { int id, node, socket, core; };
+	std::vector<Cpu> topology; //all online logical CPUs of this host
+	std::vector<int> cpuNode; //NUMA node of each logical CPU (indexed by id)
+	std::vector<int> cpus; //logical CPU for each thread index (cycled if more threads than entries)
+	std::vector<int> homeCpus; //cores of this process on the NUMA node of cpus[0] (for the calling thread)
+	int nNodes = 1; //number of NUMA nodes spanned by cpus
+	
+	#if defined(__linux__)
+	int readInt(const char* fmt, int i, int defaultValue)
+	{	char fname[256]; sprintf(fname, fmt, i);
+		FILE* fp = fopen(fname, "r");
+		if(!fp) return defaultValue;
+		int result = defaultValue;
+		if(fscanf(fp, "%d", &result) != 1) result = defaultValue;
+		fclose(fp);
+		return result;
+	}
+	
+	//Parse a kernel cpu list such as "0-31,64-95"
+	std::vector<int> readCpuList(const char* fname)
+	{	std::vector<int> result;
+		FILE* fp = fopen(fname, "r");
+		if(!fp) return result;
+		int start, stop; char sep;
+		while(fscanf(fp, "%d", &start) == 1)
+		{	stop = start;
+			if(fscanf(fp, "%c", &sep)==1 && sep=='-')
+			{	if(fscanf(fp, "%d", &stop) != 1) break;
+				if(fscanf(fp, "%c", &sep) != 1) sep = 0;
+			}
+			for(int i=start; i<=stop; i++) result.push_back(i);
+			if(sep != ',') break;
+		}
+		fclose(fp);
+		return result;
+	}
+	
+	void readTopology()
+	{	int nCpus = sysconf(_SC_NPROCESSORS_CONF);
+		cpuNode.assign(nCpus, 0);
+		DIR* dir = opendir("/sys/devices/system/node");
+		if(dir)
+		{	while(struct dirent* entry = readdir(dir))
+			{	int iNode;
+				if(sscanf(entry->d_name, "node%d", &iNode) != 1) continue;
+				char fname[256]; sprintf(fname, "/sys/devices/system/node/node%d/cpulist", iNode);
+				for(int id: readCpuList(fname))
+					if(id < nCpus) cpuNode[id] = iNode;
+			}
+			closedir(dir);
+		}
+		for(int id: readCpuList("/sys/devices/system/cpu/online"))
+		{	Cpu cpu;
+			cpu.id = id;
+			cpu.node = (id < nCpus) ? cpuNode[id] : 0;
+			cpu.socket = readInt("/sys/devices/system/cpu/cpu%d/topology/physical_package_id", id, 0);
+			cpu.core = readInt("/sys/devices/system/cpu/cpu%d/topology/core_id", id, id);
+			topology.push_back(cpu);
+		}
+	}
+	
+	void bind(const std::vector<int>& ids)
+	{	cpu_set_t mask; CPU_ZERO(&mask);
+		for(int id: ids) CPU_SET(id, &mask);
+		pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask);
+	}
+	#endif
+	
+	//Compact description of a set of CPUs such as "0-31,64-95"
+	string cpuRanges(std::vector<int> ids)
+	{	std::sort(ids.begin(), ids.end());
+		ostringstream oss;
+		for(size_t i=0; i<ids.size();)
+		{	size_t j = i;
+			while(j+1<ids.size() && ids[j+1]==ids[j]+1) j++;
+			if(i) oss << ',';
+			oss << ids[i]; if(j>i) oss << '-' << ids[j];
+			i = j+1;
+		}
+		return oss.str();
+	}
+}
+
+string initThreadAffinity(int iSibling, int nSiblings)
+{	using namespace ThreadAffinity;
+	#if defined(__linux__)
+	readTopology();
+	//Select the cores available to this process:
+	cpu_set_t mask; CPU_ZERO(&mask);
+	if(sched_getaffinity(0, sizeof(mask), &mask) != 0) return string();
+	std::vector<Cpu> allowed;
+	for(const Cpu& cpu: topology)
+		if(CPU_ISSET(cpu.id, &mask))
+			allowed.push_back(cpu);
+	if(!allowed.size()) return string();
+	//Order by NUMA node, socket and core, with the first hardware thread of each core before the others:
+	std::sort(allowed.begin(), allowed.end(), [](const Cpu& a, const Cpu& b)
+	{	if(a.node != b.node) return a.node < b.node;
+		if(a.socket != b.socket) return a.socket < b.socket;
+		if(a.core != b.core) return a.core < b.core;
+		return a.id < b.id;
+	});
+	std::vector<Cpu> primary, secondary; //first and subsequent hardware threads of each core
+	for(size_t i=0; i<allowed.size(); i++)
+	{	bool first = !i || allowed[i].socket!=allowed[i-1].socket || allowed[i].core!=allowed[i-1].core;
+		(first ? primary : secondary).push_back(allowed[i]);
+	}
+	//Divide cores contiguously between processes on this host, unless the launcher already restricted them:
+	if(nSiblings>1 && allowed.size()==topology.size())
+	{	size_t start = (primary.size()*iSibling)/nSiblings, stop = (primary.size()*(iSibling+1))/nSiblings;
+		primary = std::vector<Cpu>(primary.begin()+start, primary.begin()+std::max(stop,start+1));
+	}
+	//Assign threads to cores (hardware threads of the same cores only after all cores are used):
+	cpus.clear();
+	std::set<int> nodes;
+	for(const Cpu& cpu: primary) { cpus.push_back(cpu.id); nodes.insert(cpu.node); }
+	std::set<int> primaryCores; for(const Cpu& cpu: primary) primaryCores.insert(cpu.socket*65536 + cpu.core);
+	for(const Cpu& cpu: secondary)
+		if(primaryCores.count(cpu.socket*65536 + cpu.core))
+			cpus.push_back(cpu.id);
+	nNodes = nodes.size();
+	homeCpus.clear();
+	for(const Cpu& cpu: primary)
+		if(cpu.node == primary[0].node)
+			homeCpus.push_back(cpu.id);
+	threadAffinity = true;
+	bind(homeCpus);
+	//Description:
+	std::vector<int> used(cpus.begin(), cpus.begin()+std::min(cpus.size(), size_t(std::max(1,nProcsAvailable))));
+	ostringstream oss;
+	oss << "cpus " << cpuRanges(used) << " on node";
+	if(nNodes>1) oss << 's';
+	std::set<int> usedNodes; for(int id: used) usedNodes.insert(cpuNode[id]);
+	for(int iNode: usedNodes) oss << ' ' << iNode;
+	return oss.str();
+	#else
+	return string();
+	#endif
+}
+
+void bindThread(int iThread)
+{	using namespace ThreadAffinity;
+	#if defined(__linux__)
+	if(threadAffinity && cpus.size())
+		bind(std::vector<int>(1, cpus[iThread % cpus.size()]));
+	#endif
+}
+
+string threadTopologySummary()
+{	using namespace ThreadAffinity;
+	std::set<int> nodes, sockets, cores;
+	for(const Cpu& cpu: topology)
+	{	nodes.insert(cpu.node);
+		sockets.insert(cpu.socket);
+		cores.insert(cpu.socket*65536 + cpu.core);
+	}
+	ostringstream oss;
+	oss << nodes.size() << " NUMA nodes, " << sockets.size() << " sockets, "
+		<< cores.size() << " cores, " << topology.size() << " hardware threads per host";
+	return oss.str();
+}
+
+int numaNodeCount()
+{	return threadAffinity ? ThreadAffinity::nNodes : 1;
+}
+
+int numaNodeCurrent()
+{	using namespace ThreadAffinity;
+	#if defined(__linux__)
+	int id = sched_getcpu();
+	if(id>=0 && id<int(cpuNode.size())) return cpuNode[id];
+	#endif
+	return 0;
+}
+
+int numaNodeOf(const void* ptr)
+{
+	#if defined(__linux__) && defined(SYS_get_mempolicy)
+	const unsigned long MPOL_F_NODE = 1, MPOL_F_ADDR = 2; //from numaif.h (avoids libnuma dependency)
+	int node = 0;
+	if(syscall(SYS_get_mempolicy, &node, 0, 0, ptr, MPOL_F_NODE | MPOL_F_ADDR) == 0)
+		return node;
+	#endif
+	return 0;
+}
@@ -47,6 +47,28 @@ bool shouldThreadOperators();
 void suspendOperatorThreading(); //!< call from multi-threaded top-level code to disable threading within operators called from a parallel section
 void resumeOperatorThreading(); //!< call after a parallel section in top-level code to resume threading within subsequent operator calls
 
+/**
+@brief Optional pinning of threads to cores
+
+When enabled (by environment variable JDFTX_THREAD_AFFINITY=yes), thread iThread of each
+threadLaunch is pinned to a fixed core, cycling through the cores assigned to this process
+ordered by NUMA node, so that data first touched by a thread within a given threadLaunch
+partition stays on the memory of the socket that subsequently operates on it.
+The calling thread (which always executes the first partition) is bound to the cores of
+this process on the NUMA node of the first core, so that serial code stays socket-local.
+*/
+extern bool threadAffinity;
+
+//! Set up the list of cores for this process from the topology in /sys and the current affinity mask
+//! (divided between nSiblings processes on the same host, unless the process was already bound by the launcher),
+//! bind the calling thread and set threadAffinity. Returns a description of the chosen cores for reporting.
+string initThreadAffinity(int iSibling, int nSiblings);
+void bindThread(int iThread); //!< pin calling thread to the core for thread index iThread (no-op unless threadAffinity)
+string threadTopologySummary(); //!< description of the host topology (NUMA nodes, sockets and cores)
+int numaNodeCount(); //!< number of NUMA nodes among the cores of this process (1 unless threadAffinity)
+int numaNodeCurrent(); //!< NUMA node of the core the calling thread is running on
+int numaNodeOf(const void* ptr); //!< NUMA node of the memory page containing ptr (0 if unknown or not yet touched)
+
 
 /**
 @brief A simple utility for running muliple threads
@@ -114,15 +136,23 @@ double threadedAccumulate(Callable* func, size_t nIter, Args... args);
 //##########################
 //! @cond
 
+template<typename Callable,typename ... Args>
+void threadLaunch_bound(int iThread, Callable* func, size_t i1, size_t i2, Args... args)
+{	bindThread(iThread);
+	(*func)(i1, i2, args...);
+}
+
 template<typename Callable,typename ... Args>
 void threadLaunch(int nThreads, Callable* func, size_t nJobs, Args... args)
 {	if(nThreads<=0) nThreads = shouldThreadOperators() ? nProcsAvailable : 1;
 	if(nThreads>1) suspendOperatorThreading(); //Prevent func and anything it calls from launching nested threads
 	std::thread** tArr = new std::thread*[nThreads-1];
-	for(int t=0; t<nThreads; t++)
+	for(int t=nThreads-1; t>=0; t--) //calling thread handles t=0 (last, after launching the others)
 	{	size_t i1 = (nJobs>0 ? (  t   * nJobs)/nThreads : t);
 		size_t i2 = (nJobs>0 ? ((t+1) * nJobs)/nThreads : nThreads);
-		if(t<nThreads-1) tArr[t] = new std::thread(func, i1, i2, args...);
+		if(t>0) tArr[t-1] = threadAffinity
+			? new std::thread(threadLaunch_bound<Callable,Args...>, t, func, i1, i2, args...)
+			: new std::thread(func, i1, i2, args...);
 		else (*func)(i1, i2, args...);
 	}
 	for(int t=0; t<nThreads-1; t++)
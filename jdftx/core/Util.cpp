@@ -35,7 +35,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <config.h> //This file is generated during build based on Git hash etc.
 
 InitParams::InitParams(const char* description, class Everything* e)
-: description(description), e(e), packageName(0), versionString(0), versionHash(0)
+: description(description), e(e), allowFarm(false), packageName(0), versionString(0), versionHash(0)
 {
 }
 
@@ -73,6 +73,8 @@ void printUsage(const char *name, const InitParams& ip)
 	logPrintf("\t-c --cores              number of cores per process (ignored when launched using SLURM)\n");
 	logPrintf("\t-G --nGroups            number of MPI process groups (default or 0 => each process in own group of size 1)\n");
 	logPrintf("\t-s --skip-defaults      skip printing status of default commands issued automatically.\n");
+	if(ip.allowFarm)
+		logPrintf("\t-F --farm <filename>    task-farm mode: run each input file listed in <filename> within a process group\n");
 	logPrintf("\n");
 }
 
@@ -152,6 +154,7 @@ MPIUtil* mpiGroupHead = 0;
 bool mpiDebugLog = false;
 bool manualThreadCount = false;
 size_t mempoolSize = 0;
+size_t memcacheSize = 0;
 static double startTime_us; //Time at which system was initialized in microseconds
 const char* argv0 = 0;
 uint32_t crc32(const string& s); //CRC32 checksum for a string (implemented below)
@@ -273,6 +276,18 @@ void initSystem(int argc, char** argv, const InitParams* ip)
 	}
 	resumeOperatorThreading(); //if necessary, this informs MKL of the thread count
 	
+	//Pin threads to cores if requested:
+	const char* threadAffinityStr = getenv("JDFTX_THREAD_AFFINITY");
+	if(threadAffinityStr && (string(threadAffinityStr)=="yes" || string(threadAffinityStr)=="1"))
+	{	string cpuDesc = initThreadAffinity(mpiHost.iProcess(), mpiHost.nProcesses());
+		if(!cpuDesc.length()) cpuDesc = "not pinned (topology unavailable)";
+		logPrintf("Thread affinity: %s\n", threadTopologySummary().c_str());
+		int cpuDescSum = abs(int(crc32(cpuDesc))); //group processes with identical placement
+		MPIUtil mpiCpus(0,0, MPIUtil::ProcDivision(mpiWorld, 0, cpuDescSum));
+		MPIUtil mpiCpusHead(0,0, MPIUtil::ProcDivision(mpiWorld, 0, mpiCpus.iProcess()));
+		printProcessDistribution("Threads pinned to", cpuDesc, &mpiCpus, &mpiCpusHead);
+	}
+	
 	//Print total resources used by run:
 	{	int nProcsTot = nProcsAvailable; mpiWorld->allReduce(nProcsTot, MPIUtil::ReduceSum);
 		double nGPUsTot = nGPUs; mpiWorld->allReduce(nGPUsTot, MPIUtil::ReduceSum);
@@ -292,12 +307,36 @@ void initSystem(int argc, char** argv, const InitParams* ip)
 			logPrintf("Could not determine memory pool size from JDFTX_MEMPOOL_SIZE=\"%s\".\n", mempoolSizeStr);
 	}
 	
+	//Memory cache size:
+	const char* memcacheSizeStr = getenv("JDFTX_MEMCACHE_SIZE");
+	if(memcacheSizeStr)
+	{	int memcacheSizeMB;
+		if(sscanf(memcacheSizeStr, "%d", &memcacheSizeMB)==1 && memcacheSizeMB>=0)
+		{	memcacheSize = ((size_t)memcacheSizeMB) << 20; //convert to bytes
+			logPrintf("Memory cache size: %d MB (per process)\n", memcacheSizeMB);
+		}
+		else
+			logPrintf("Could not determine memory cache size from JDFTX_MEMCACHE_SIZE=\"%s\".\n", memcacheSizeStr);
+	}
+	
 	//Add citations to the code for all calculations:
 	Citations::add("Software package",
 		"R. Sundararaman, K. Letchworth-Weaver, K.A. Schwarz, D. Gunceler, Y. Ozhabes and T.A. Arias, "
 		"'JDFTx: software for joint density-functional theory', SoftwareX 6, 278 (2017)");
 }
 
+void setInputBasename(const string& inputFilename)
+{	inputBasename = inputFilename;
+	//Remove extension:
+	size_t lastDot = inputBasename.find_last_of(".");
+	if(lastDot != string::npos)
+		inputBasename = inputBasename.substr(0, lastDot); //Remove extension
+	//Remove leading path:
+	size_t lastSlash = inputBasename.find_last_of("\\/");
+	if(lastSlash != string::npos)
+		inputBasename = inputBasename.substr(lastSlash+1);
+}
+
 void initSystemCmdline(int argc, char** argv, InitParams& ip)
 {
 	mpiWorld = new MPIUtil(argc, argv);
@@ -318,10 +357,11 @@ void initSystemCmdline(int argc, char** argv, InitParams& ip)
 			{"nGroups", required_argument, 0, 'G'},
 			{"skip-defaults", no_argument, 0, 's'},
 			{"write-manual", required_argument, 0, 'w'},
+			{"farm", required_argument, 0, 'F'},
 			{0, 0, 0, 0}
 		};
 	while (1)
-	{	int c = getopt_long(argc, argv, "hvi:o:dtmnc:G:sw:", long_options, 0);
+	{	int c = getopt_long(argc, argv, "hvi:o:dtmnc:G:sw:F:", long_options, 0);
 		if (c == -1) break; //end of options
 		#define RUN_HEAD(code) if(mpiWorld->isHead()) { code } delete mpiWorld;
 		switch (c)
@@ -353,6 +393,11 @@ void initSystemCmdline(int argc, char** argv, InitParams& ip)
 			}
 			case 's': ip.printDefaults=false; break;
 			case 'w': RUN_HEAD( if(ip.e) writeCommandManual(*ip.e, optarg); ) exit(0);
+			case 'F':
+			{	if(!ip.allowFarm) { RUN_HEAD( printUsage(argv[0], ip); ) exit(1); }
+				ip.farmManifest.assign(optarg);
+				break;
+			}
 			default: RUN_HEAD( printUsage(argv[0], ip); ) exit(1);
 		}
 		#undef RUN_HEAD
@@ -369,16 +414,7 @@ void initSystemCmdline(int argc, char** argv, InitParams& ip)
 	
 	//Set input base name if necessary:
 	if(ip.inputFilename.length())
-	{	inputBasename = ip.inputFilename;
-		//Remove extension:
-		size_t lastDot = inputBasename.find_last_of(".");
-		if(lastDot != string::npos)
-			inputBasename = inputBasename.substr(0, lastDot); //Remove extension
-		//Remove leading path:
-		size_t lastSlash = inputBasename.find_last_of("\\/");
-		if(lastSlash != string::npos)
-			inputBasename = inputBasename.substr(lastSlash+1);
-	}
+		setInputBasename(ip.inputFilename);
 	
 	//Print banners, setup threads, GPUs and signal handlers
 	initSystem(argc, argv, &ip);
@@ -418,8 +454,8 @@ void finalizeSystem(bool successful)
 	#ifdef ENABLE_PROFILING
 	stopWatchManager();
 	logPrintf("\n");
-	ManagedMemoryBase::reportUsage();
 	#endif
+	ManagedMemoryBase::reportUsage();
 	
 	if(!mpiWorld->isHead())
 	{	if(mpiDebugLog) fclose(globalLog);
@@ -45,17 +45,20 @@ extern MPIUtil* mpiGroup; //!< MPI within current group of processes
 extern MPIUtil* mpiGroupHead; //!< MPI across equal ranks in each group
 extern bool mpiDebugLog; //!< If true, all processes output to seperate debug log files, otherwise only head process outputs (set before calling initSystem())
 extern size_t mempoolSize; //!< If non-zero, size of memory pool managed internally by JDFTx
+extern size_t memcacheSize; //!< If non-zero, maximum size of freed memory blocks cached for reuse by JDFTx (used when mempoolSize is zero, or the pool is exhausted)
 
 //! Parameters used for common initialization functions
 struct InitParams
 {	//Input parameters:
 	const char* description; //!< description of program used when printing usage
 	class Everything* e; //!< pointer to use when calling template
+	bool allowFarm; //!< whether the program supports task-farm mode (command-line option -F)
 	InitParams(const char* description=0, class Everything* e=0);
 	//Output parameters retrieved from command-line:
 	string inputFilename; //!< name of input file
 	bool dryRun; //!< whether this is a dry run
 	bool printDefaults; //!< whether to print default commands
+	string farmManifest; //!< file listing input files to run in task-farm mode (empty if not in farm mode)
 	//Optional parameters useful when calling from outside JDFTx:
 	const char* packageName; //!< package name dispalyed in banner
 	const char* versionString; //!< version string displayed in banner
@@ -65,6 +68,7 @@ void printVersionBanner(const InitParams* ip=0); //!< Print package name, versio
 void initSystem(int argc, char** argv, const InitParams* ip=0); //!< Init MPI (if not already done), print banner, set up threads (play nice with job schedulers), GPU and signal handlers
 void initSystemCmdline(int argc, char** argv, InitParams& ip); //!< initSystem along with commandline options
 void finalizeSystem(bool successful=true); //!< Clean-up corresponding to initSystem(), final messages (depending on successful) and clean-up MPI
+void setInputBasename(const string& inputFilename); //!< set inputBasename from an input filename (removing path and extension)
 
 //----------------- Profiling --------------------------
 
@@ -222,7 +222,9 @@ matrix invsqrt(const matrix& A, matrix* Aevecs=0, diagMatrix* Aeigs=0, bool* isS
 
 //! Compute matrix that orthonormalizes hermitian matrix A using Cholesky decomposition (effectively the Gram-Schmidt scheme).
 //! This is a potentially much faster alternative to invsqrt, applicable when the transformation does not have to be symmetric.
-matrix orthoMatrix(const matrix& A);
+//! Falls back to invsqrt when A is too ill-conditioned for a stable Cholesky factorization.
+//! If isUpperTriangular is non-null, it is set to whether the result is upper triangular (i.e. the Cholesky path was used).
+matrix orthoMatrix(const matrix& A, bool* isUpperTriangular=0);
 
 //! Compute cis(A) = exp(iota A) and optionally the eigensystem of A (if non-null)
 matrix cis(const matrix& A, matrix* Aevecs=0, diagMatrix* Aeigs=0);
@@ -385,8 +385,9 @@ diagMatrix inv(const diagMatrix& A)
 }
 
 //Compute Cholesky decomposition: helper for invApply and orthoMatrix
-matrix cholesky(const matrix& A, bool upper)
-{
+//If notPositive is non-null, set it (instead of stack-tracing) when A is not positive definite
+matrix cholesky(const matrix& A, bool upper, bool* notPositive=0)
+{	if(notPositive) *notPositive = false;
 	//Check dimensions:
 	assert(A.nCols()==A.nRows());
 	int N = A.nRows();
@@ -414,6 +415,7 @@ matrix cholesky(const matrix& A, bool upper)
 		cusolverDnZpotrf(cusolverHandle, uplo, N, (double2*)Acopy.dataPref(), N, work.dataPref(), lwork, infoArr.dataPref());
 		int info = infoArr.data()[0];
 		if(info<0) { logPrintf("Argument# %d to CuSolver Cholesky routine Zpotrf is invalid.\n", -info); stackTraceExit(1); }
+		if(info>0 && notPositive) { *notPositive = true; return Acopy; }
 		if(info>0) { logPrintf("Matrix not positive-definite at leading minor# %d in CuSolver Cholesky routine Zpotrf.\n", info); stackTraceExit(1); }
 		return Acopy;
 	}
@@ -422,6 +424,7 @@ matrix cholesky(const matrix& A, bool upper)
 	int info = 0;
 	zpotrf_(&uplo, &N, Acopy.data(), &N, &info);
 	if(info<0) { logPrintf("Argument# %d to LAPACK Cholesky routine ZPOTRF is invalid.\n", -info); stackTraceExit(1); }
+	if(info>0 && notPositive) { *notPositive = true; return Acopy; }
 	if(info>0) { logPrintf("Matrix not positive-definite at leading minor# %d in LAPACK Cholesky routine ZPOTRF.\n", info); stackTraceExit(1); }
 	return Acopy;
 }
@@ -467,13 +470,38 @@ void zeroLowerTriangular_gpu(int N, complex* data); //implemented in matrixOpera
 #endif
 void zeroLowerTriangular(int N, complex* data); //implemented in matrixOperators.cpp
 
-matrix orthoMatrix(const matrix& A)
+matrix orthoMatrix(const matrix& A, bool* isUpperTriangular)
 {	static StopWatch watch("orthoMatrix(matrix)");
 	watch.start();
 	
 	//Cholesky decomposition:
-	matrix U = cholesky(A, true); //upper-triangular Cholesky factor
+	bool notPositive = false;
+	matrix U = cholesky(A, true, &notPositive); //upper-triangular Cholesky factor
 	int N = A.nRows();
+	if(!notPositive)
+	{	//Estimate condition number from the diagonal of the factor (a lower bound):
+		const complex* Udata = U.data();
+		double UdiagMin = DBL_MAX, UdiagMax = 0.;
+		for(int i=0; i<N; i++)
+		{	double Udiag = Udata[U.index(i,i)].real();
+			UdiagMin = std::min(UdiagMin, Udiag);
+			UdiagMax = std::max(UdiagMax, Udiag);
+		}
+		const double conditionMax = 1e10; //loss of orthonormality in Cholesky scales as this times machine precision
+		if(UdiagMin*UdiagMin*conditionMax < UdiagMax*UdiagMax) notPositive = true;
+	}
+	if(notPositive)
+	{	//Fall back to symmetric orthonormalization (diagonalization is stable for near-singular A):
+		static bool warned = false;
+		if(!warned)
+		{	logPrintf("WARNING: orthoMatrix falling back to symmetric orthonormalization for near-singular overlap.\n");
+			warned = true;
+		}
+		if(isUpperTriangular) *isUpperTriangular = false;
+		watch.stop();
+		return invsqrt(A);
+	}
+	if(isUpperTriangular) *isUpperTriangular = true;
 	callPref(zeroLowerTriangular)(N, U.dataPref());
 
 	//Invert triangular matrix in place:
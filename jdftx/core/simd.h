@@ -0,0 +1,183 @@
+/*-------------------------------------------------------------------
+Copyright 2026 JDFTx contributors
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#ifndef JDFTX_CORE_SIMD_H
+#define JDFTX_CORE_SIMD_H
+
+//! @addtogroup Utilities
+//! @{
+
+/** @file simd.h
+@brief Portable SIMD vector of doubles with vectorized elementary functions
+
+simdDouble wraps a compiler vector type (GCC / Clang vector extensions) whose width
+matches the widest vector instruction set enabled at compile time (AVX-512, AVX or SSE2).
+It supports the usual arithmetic operators (also mixed with scalars), so that templates
+written for a scalar type T can be instantiated with T = simdDouble to process simdDouble::width
+points at once. Branches must be replaced by select(), or by uniform branches using all() / any().
+The elementary functions exp and log are evaluated with polynomial approximations with
+maximum errors of 1 and 2.2 ulp respectively for normal (not denormal) arguments.
+pow(x,a) is computed as exp(a log x), so its relative error grows with |a log x| due to the
+rounding of a log x: about |a log x| ulp in the worst case, e.g. up to 25 ulp (5e-15) for
+pow(x,4/3) with x in [1e-12,1e4], and up to ~700 ulp (1.6e-13) over the full double range.
+(Measured by testXCsimd in aux/TestOperators.cpp.)
+These errors are well below the convergence thresholds of the self-consistent calculations,
+and testXCsimd checks that vectorized and scalar functional evaluations agree to within 1e-12 (relative).
+SIMD_ENABLED is defined only if this is available (not on GPU compilers or unsupported compilers);
+the CPU exchange-correlation kernels use it when built with the EnableVectorXC CMake option (default ON).
+Only the LDA and GGA kernels with templated evaluators (LDA_evalT, GGA_evalT) are vectorized. Meta-GGAs
+(TPSS, revTPSS) are not: their per-point branches on z, tau cutoffs and spin-channel energies (ec > ecUp)
+would diverge across lanes. Nor is Fex_ScalarEOS: its one equation-of-state evaluation per grid point
+is negligible next to the convolutions (FFTs) of each evaluation, and Tao-Mason needs a vectorized atan.
+*/
+
+#if defined(__GNUC__) && !defined(__CUDACC__)
+#define SIMD_ENABLED
+
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+
+#if defined(__AVX512F__)
+	#define SIMD_WIDTH 8
+#elif defined(__AVX__)
+	#define SIMD_WIDTH 4
+#else
+	#define SIMD_WIDTH 2
+#endif
+
+//! Mask resulting from comparisons of simdDouble's (each lane is all ones for true, and zero for false)
+struct simdMask
+{	typedef int64_t Vec __attribute__((vector_size(8*SIMD_WIDTH)));
+	Vec m;
+	simdMask(Vec m) : m(m) {}
+	simdMask operator&&(const simdMask& other) const { return simdMask(m & other.m); }
+	simdMask operator||(const simdMask& other) const { return simdMask(m | other.m); }
+	simdMask operator!() const { return simdMask(~m); }
+};
+
+//! SIMD vector of doubles
+struct simdDouble
+{	typedef double Vec __attribute__((vector_size(8*SIMD_WIDTH)));
+	static const int width = SIMD_WIDTH; //!< number of lanes
+	Vec v;
+
+	simdDouble() {}
+	simdDouble(Vec v) : v(v) {}
+	simdDouble(double x) { v = Vec{} + x; } //!< broadcast scalar to all lanes
+	static simdDouble load(const double* p) { simdDouble r; memcpy(&r.v, p, sizeof(Vec)); return r; } //!< load width elements from p (need not be aligned)
+	void store(double* p) const { memcpy(p, &v, sizeof(Vec)); } //!< store width elements to p (need not be aligned)
+	double operator[](int j) const { return v[j]; }
+
+	simdDouble& operator+=(const simdDouble& other) { v += other.v; return *this; }
+	simdDouble& operator-=(const simdDouble& other) { v -= other.v; return *this; }
+	simdDouble& operator*=(const simdDouble& other) { v *= other.v; return *this; }
+	simdDouble& operator/=(const simdDouble& other) { v /= other.v; return *this; }
+};
+
+//Arithmetic (non-template so that scalar arguments of any numeric type convert automatically):
+inline simdDouble operator-(const simdDouble& a) { return simdDouble(-a.v); }
+#define SIMD_BINARY_OP(op) \
+	inline simdDouble operator op(const simdDouble& a, const simdDouble& b) { return simdDouble(a.v op b.v); } \
+	inline simdDouble operator op(const simdDouble& a, double b) { return simdDouble(a.v op b); } \
+	inline simdDouble operator op(double a, const simdDouble& b) { return simdDouble(a op b.v); }
+SIMD_BINARY_OP(+)
+SIMD_BINARY_OP(-)
+SIMD_BINARY_OP(*)
+SIMD_BINARY_OP(/)
+#undef SIMD_BINARY_OP
+
+//Comparisons:
+#define SIMD_COMPARE_OP(op) \
+	inline simdMask operator op(const simdDouble& a, const simdDouble& b) { return simdMask(a.v op b.v); } \
+	inline simdMask operator op(const simdDouble& a, double b) { return simdMask(a.v op simdDouble(b).v); } \
+	inline simdMask operator op(double a, const simdDouble& b) { return simdMask(simdDouble(a).v op b.v); }
+SIMD_COMPARE_OP(<)
+SIMD_COMPARE_OP(>)
+SIMD_COMPARE_OP(<=)
+SIMD_COMPARE_OP(>=)
+SIMD_COMPARE_OP(==)
+SIMD_COMPARE_OP(!=)
+#undef SIMD_COMPARE_OP
+
+//! Lane-wise select: a where mask is true, and b otherwise
+inline simdDouble select(const simdMask& mask, const simdDouble& a, const simdDouble& b)
+{	return simdDouble((simdDouble::Vec)((mask.m & (simdMask::Vec)a.v) | (~mask.m & (simdMask::Vec)b.v)));
+}
+inline double select(bool mask, double a, double b) { return mask ? a : b; } //!< scalar version of select (for generic code)
+inline bool any(const simdMask& mask) { for(int j=0; j<SIMD_WIDTH; j++) if(mask.m[j]) return true; return false; } //!< whether mask is true in any lane
+inline bool all(const simdMask& mask) { for(int j=0; j<SIMD_WIDTH; j++) if(!mask.m[j]) return false; return true; } //!< whether mask is true in all lanes
+inline bool any(bool mask) { return mask; } //!< scalar version of any (for generic code)
+inline bool all(bool mask) { return mask; } //!< scalar version of all (for generic code)
+
+//Elementary functions:
+inline simdDouble sqrt(const simdDouble& x)
+{	simdDouble r;
+	for(int j=0; j<SIMD_WIDTH; j++) r.v[j] = std::sqrt(x.v[j]);
+	return r;
+}
+
+inline simdDouble exp(const simdDouble& x)
+{	//Range reduction x = n log(2) + r with |r| <= log(2)/2:
+	const double magic = 6755399441055744.; //1.5*2^52: adding this rounds to the nearest integer, and stores it in the low bits
+	simdDouble xc = select(x < -708.39, -708.39, select(x > 709.78, 709.78, x));
+	simdDouble nMagic = xc * 1.4426950408889634 + magic;
+	simdDouble n = nMagic - magic;
+	simdDouble r = (xc - n*6.93145751953125e-1) - n*1.42860682030941723212e-6; //log(2) split into exact and remainder parts
+	//Taylor series (error < 1e-17 for |r| <= log(2)/2):
+	simdDouble p = 1./6227020800;
+	const double c[] = { 1./479001600, 1./39916800, 1./3628800, 1./362880, 1./40320, 1./5040, 1./720, 1./120, 1./24, 1./6, 1./2, 1., 1. };
+	for(double ci: c) p = p*r + ci;
+	//Scale by 2^n:
+	simdMask::Vec twoPowN = (((simdMask::Vec)nMagic.v - (simdMask::Vec)simdDouble(magic).v) + 1023) << 52;
+	simdDouble result = p * simdDouble((simdDouble::Vec)twoPowN);
+	result = select(x < -708.39, 0., result);
+	return select(x > 709.78, INFINITY, result);
+}
+
+inline simdDouble log(const simdDouble& x)
+{	//Split x = 2^e m with sqrt(1/2) <= m < sqrt(2):
+	simdMask::Vec bits = (simdMask::Vec)x.v;
+	simdMask::Vec e = ((bits >> 52) & 0x7ff) - 1023;
+	simdDouble m((simdDouble::Vec)((bits & 0x000fffffffffffffL) | 0x3ff0000000000000L)); //in [1,2)
+	simdMask big = (m > M_SQRT2);
+	m = select(big, 0.5*m, m);
+	e -= big.m; //increment exponent where m was halved
+	const double magic = 6755399441055744.;
+	simdDouble eDbl = simdDouble((simdDouble::Vec)(e + (simdMask::Vec)simdDouble(magic).v)) - magic;
+	//Series log(m) = 2 atanh(s) with s = (m-1)/(m+1), |s| <= 0.172 (error < 1e-18):
+	simdDouble s = (m-1.)/(m+1.), s2 = s*s;
+	simdDouble p = 1./21;
+	const double c[] = { 1./19, 1./17, 1./15, 1./13, 1./11, 1./9, 1./7, 1./5, 1./3, 1. };
+	for(double ci: c) p = p*s2 + ci;
+	simdDouble result = eDbl*6.93145751953125e-1 + ((2.*s)*p + eDbl*1.42860682030941723212e-6);
+	//Special cases:
+	result = select(x == 0., -INFINITY, result);
+	result = select(x < 0., NAN, result);
+	return select(x == INFINITY, INFINITY, result);
+}
+
+//! Power function for non-negative x (relative error ~ |a log x| ulp; see above)
+inline simdDouble pow(const simdDouble& x, double a)
+{	return exp(a * log(x));
+}
+
+//! @}
+#endif //SIMD_ENABLED
+#endif //JDFTX_CORE_SIMD_H
@@ -25,6 +25,14 @@ BandDavidson::BandDavidson(Everything& e, int q): e(e), eVars(e.eVars), eInfo(e.
 {	assert(e.cntrl.fixed_H); // Check whether the electron Hamiltonian is fixed
 }
 
+void BandDavidson::initFromNeighbor(const ColumnBundle& Cneighbor)
+{	//Keep periodic parts of the Bloch functions (coefficients of common G-vectors):
+	ColumnBundle& C = eVars.C[q];
+	C = switchBasis(Cneighbor, e.basis[q]);
+	C.qnum = &eInfo.qnums[q];
+	eVars.orthonormalize(q);
+}
+
 void BandDavidson::minimize(bool isInner)
 {	//Use the same working set as the CG minimizer:
 	ColumnBundle& C = eVars.C[q];
@@ -24,6 +24,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/Minimize.h>
 
 class Everything;
+class ColumnBundle;
 
 //! @addtogroup ElecSystem
 //! @{
@@ -34,6 +35,7 @@ class BandDavidson
 public:
 	BandDavidson(Everything& e, int q); //!< Construct Davidson eigenvalue solver for quantum number q
 	void minimize(bool isInner); //!< Converge eigenproblem with tolerance set by e.elecMinParams
+	void initFromNeighbor(const ColumnBundle& Cneighbor); //!< Set initial guess to converged wavefunctions of a nearby k-point (mapped to the current basis and orthonormalized)
 	
 private:
 	Everything& e;
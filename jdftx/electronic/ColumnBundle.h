@@ -136,6 +136,7 @@ ColumnBundle operator+(const ColumnBundleMatrixProduct &XM1, const ColumnBundleM
 ColumnBundle operator-(const ColumnBundleMatrixProduct &XM1, const ColumnBundleMatrixProduct &XM2);
 
 ColumnBundle operator*(const scaled<ColumnBundle>&, const diagMatrix&);
+void multiplyUpperTriangular(ColumnBundle& Y, const matrix& U); //!< Y = Y * U in place for upper-triangular U (eg. from orthoMatrix), at half the cost of a general product
 matrix operator^(const scaled<ColumnBundle>&, const scaled<ColumnBundle>&); //!< inner product
 vector3<matrix> spinOverlap(const scaled<ColumnBundle> &sY); //!< spin-resolved inner product for a spinorial ColumnBundle
 
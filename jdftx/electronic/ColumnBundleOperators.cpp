@@ -113,6 +113,16 @@ ColumnBundle operator-(const ColumnBundleMatrixProduct &XM1, const ColumnBundleM
 	return result;
 }
 
+void multiplyUpperTriangular(ColumnBundle& Y, const matrix& U)
+{	static StopWatch watch("Y*U");
+	watch.start();
+	assert(Y.nCols()==U.nRows());
+	assert(U.nRows()==U.nCols());
+	callPref(eblas_ztrmm)(CblasRight, CblasUpper, CblasNoTrans, CblasNonUnit, Y.colLength(), Y.nCols(),
+		1., U.dataPref(), U.nRows(), Y.dataPref(), Y.colLength());
+	watch.stop();
+}
+
 ColumnBundle operator*(const scaled<ColumnBundle> &sY, const diagMatrix& d)
 {	const ColumnBundle& Y = sY.data;
 	assert(Y.nCols()==d.nRows());
@@ -517,7 +527,7 @@ void diagouterI_sub(int iThread, int nThreads, const diagMatrix *F, const Column
 	int colStop  = ((iThread+1) * X->nCols())/nThreads;
 	
 	ScalarFieldArray& nLocal = (*nSub)[iThread];
-	nullToZero(nLocal, *(X->basis->gInfo)); //sets to zero
+	nullToZero(nLocal, *(X->basis->gInfo)); //sets to zero (allocated within this thread, so that it is socket-local when threads are pinned)
 	int nDensities = nLocal.size();
 	if(nDensities==1) //Note that nDensities==2 below will also enter this branch sinc eonly one component is non-zero
 	{	int nSpinor = X->spinorLength();
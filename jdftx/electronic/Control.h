@@ -39,17 +39,30 @@ class Control
 {
 public:
 	bool fixed_H; //!< fixed Hamiltonian (band structure) mode for electronic sector
+	int bandBatchSize; //!< number of states per process solved, written and freed together in fixed_H mode (0 => all states at once)
+	bool bandBatchRestart; //!< whether to resume a batched fixed_H calculation from the last completed batch
 	bool cacheProjectors; //!< whether to cache nonlocal projectors
+	double cacheProjectorsMaxMemory; //!< memory budget for cached projectors per process in MB (default 1024; 0 => unlimited)
+	bool cacheProjectorsSingle; //!< whether to store cached projectors in single precision
+	bool mergeProjectors; //!< whether to apply the projectors of all species together (one GEMM per k-point)
+	bool realSpaceProjectors; //!< whether to apply nonlocal projectors in real space (masked-function method)
+	double realSpaceProjectorsRcut; //!< real-space projector sphere radius in units of the extent of the projectors
+	bool realSpaceAugmentation; //!< whether to compute ultrasoft augmentation densities in real space (masked-function method)
+	double realSpaceAugmentationRcut; //!< real-space augmentation sphere radius in units of the extent of the augmentation functions
 	double davidsonBandRatio; //!< ratio of number of Davidson working bands to actual bands in system (>= 1)
 	int exxBlockSize; //!< number of bands per FFT block used in exact exchange
 	int nOuterVxx; //!< number of outer loop iterations used to converge ACE representation of exact exchange operator
 	
 	ElecEigenAlgo elecEigenAlgo; //!< Eigenvalue algorithm
+	bool davidsonNeighborGuess; //!< whether to initialize Davidson in fixed_H calculations from the nearest converged k-point (solving k-points in nearest-neighbour order)
 	BasisKdep basisKdep; //!< k-dependence of basis
 	double Ecut, EcutRho; //!< energy cutoff for electrons and charge density grid (EcutRho=0 => EcutRho = 4 Ecut)
 	
 	bool dragWavefunctions; //!< whether to drag wavefunctions using atomic orbital projections on ionic steps
 	vector3<> lattMoveScale; //!< preconditioning factor for each lattice vector during lattice minimization
+	bool adaptiveElecThreshold; //!< whether to loosen electronic convergence thresholds according to the force / stress residuals during geometry optimization
+	double adaptiveElecAccuracy; //!< target accuracy of forces relative to the smallest residual so far (for adaptiveElecThreshold)
+	double adaptiveElecThresholdMax; //!< maximum electronic energy-difference threshold (for adaptiveElecThreshold)
 	
 	int fluidGummel_nIterations; //!< max iterations of the fluid<->electron self-consistency loop
 	double fluidGummel_Atol; //!< stopping free-energy tolerance for the fluid<->electron self-consistency loop
@@ -67,9 +80,11 @@ public:
 	bool dumpOnly; //!< run a single-electronic-point energy evaluation and process the end dump
 	
 	Control()
-	:	fixed_H(false),
-		cacheProjectors(true), davidsonBandRatio(1.1), exxBlockSize(16), nOuterVxx(20),
-		elecEigenAlgo(ElecEigenDavidson), basisKdep(BasisKpointDep), Ecut(0), EcutRho(0), dragWavefunctions(true),
+	:	fixed_H(false), bandBatchSize(0), bandBatchRestart(true),
+		cacheProjectors(true), cacheProjectorsMaxMemory(1024.), cacheProjectorsSingle(false), mergeProjectors(false), realSpaceProjectors(false), realSpaceProjectorsRcut(1.5),
+		realSpaceAugmentation(false), realSpaceAugmentationRcut(1.5), davidsonBandRatio(1.1), exxBlockSize(16), nOuterVxx(20),
+		elecEigenAlgo(ElecEigenDavidson), davidsonNeighborGuess(false), basisKdep(BasisKpointDep), Ecut(0), EcutRho(0), dragWavefunctions(true),
+		adaptiveElecThreshold(false), adaptiveElecAccuracy(0.1), adaptiveElecThresholdMax(1e-4),
 		fluidGummel_nIterations(10), fluidGummel_Atol(1e-5),
 		shouldPrintEigsFillings(false), shouldPrintEcomponents(false), shouldPrintMuSearch(false), shouldPrintKpointsBasis(false),
 		subspaceRotationFactor(1.), subspaceRotationAdjust(true), scf(false), convergeEmptyStates(false), dumpOnly(false)
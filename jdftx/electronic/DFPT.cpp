@@ -0,0 +1,343 @@
+/*-------------------------------------------------------------------
+Copyright 2026 JDFTx contributors
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#include <electronic/DFPT.h>
+#include <electronic/Everything.h>
+#include <electronic/ResultCache.h>
+#include <core/ScalarFieldIO.h>
+
+inline void setDFPTkernels(int i, double Gsq, double GminSq, double mixFraction,
+	double qKerkerSq, double qMetricSq, double* kerkerMix, double* diisMetric)
+{	double GsqReg = std::max(Gsq, GminSq); //regularize to avoid G=0 issues
+	kerkerMix[i] = mixFraction * (qKerkerSq ? GsqReg/(GsqReg + qKerkerSq) : 1.);
+	diisMetric[i] = qMetricSq ? (GsqReg + qMetricSq)/GsqReg : 1.; //metric for density mixing
+}
+
+//Sternheimer equation P_c (H - eps_n O) P_c dC_n = -P_c dV C_n for all occupied bands n of one state
+//(P_c is Hermitian for norm-conserving pseudopotentials, and the operator is positive definite in the conduction subspace)
+struct Sternheimer : public LinearSolvable<ColumnBundle>
+{	const DFPT& dfpt;
+	int q;
+	double KErollover;
+
+	Sternheimer(const DFPT& dfpt, int q) : dfpt(dfpt), q(q)
+	{	const ColumnBundle& C = dfpt.C[q];
+		KErollover = -trace(C ^ L(C)).real() / C.nCols(); //twice the mean kinetic energy of occupied bands
+	}
+
+	ColumnBundle hessian(const ColumnBundle& X) const
+	{	ColumnBundle PX = dfpt.projectConduction(q, X);
+		return dfpt.projectConduction(q, dfpt.applyH(q, PX) - O(PX) * dfpt.eigs[q]);
+	}
+
+	ColumnBundle precondition(const ColumnBundle& X) const
+	{	ColumnBundle KX = dfpt.projectConduction(q, X);
+		precond_inv_kinetic(KX, KErollover);
+		return dfpt.projectConduction(q, KX);
+	}
+};
+
+DFPT::DFPT(Everything& e) : Pulay<ScalarFieldArray>(mixParams), e(e), mixParams(e.scfParams),
+	kerkerMix(e.gInfo), diisMetric(e.gInfo), h(1e-4), nIterCG(0)
+{	checkCompatibility(e);
+	const ElecInfo& eInfo = e.eInfo;
+
+	//Mixing parameters for the density response:
+	mixParams.fpLog = globalLog;
+	mixParams.linePrefix = "\tDFPT: ";
+	mixParams.energyLabel = "|dn|";
+	mixParams.energyFormat = "%.6le";
+	mixParams.energyDiffThreshold = 0.; //converge on the residual of the density response alone
+	double GminSq = DBL_MAX;
+	{	vector3<int> iG;
+		for(iG[0]=-1; iG[0]<=1; iG[0]++)
+		for(iG[1]=-1; iG[1]<=1; iG[1]++)
+		for(iG[2]=-1; iG[2]<=1; iG[2]++)
+			if(iG.length_squared()) //except G==0
+				GminSq = std::min(GminSq, e.gInfo.GGT.metric_length_squared(iG));
+	}
+	applyFuncGsq(e.gInfo, setDFPTkernels, GminSq, mixParams.mixFraction,
+		pow(e.scfParams.qKerker,2), pow(mixParams.qMetric,2), kerkerMix.data(), diisMetric.data());
+
+	//Occupied eigenstates:
+	C.resize(eInfo.nStates);
+	eigs.resize(eInfo.nStates);
+	dVnlC.resize(eInfo.nStates);
+	dC.resize(eInfo.nStates);
+	bool fillingsOk = true;
+	for(int q=eInfo.qStart; q<eInfo.qStop; q++)
+	{	const diagMatrix& Fq = e.eVars.F[q];
+		int nOcc = 0;
+		while(nOcc<eInfo.nBands && Fq[nOcc]>0.5) nOcc++;
+		for(int b=0; b<eInfo.nBands; b++)
+			if(fabs(Fq[b] - (b<nOcc ? 1. : 0.)) > 1e-6)
+				fillingsOk = false;
+		if(!nOcc) continue; //no occupied states (and hence no response) at this q
+		//Diagonalize the Hamiltonian within the occupied subspace:
+		ColumnBundle Cq = e.eVars.C[q].getSub(0, nOcc);
+		matrix Hsub = Cq ^ applyH(q, Cq), Hsub_evecs;
+		Hsub.diagonalize(Hsub_evecs, eigs[q]);
+		C[q] = Cq * Hsub_evecs;
+	}
+	mpiWorld->allReduce(fillingsOk, MPIUtil::ReduceLAnd);
+	if(!fillingsOk)
+		die("Linear-response (DFPT) vibrations require integer fillings with the occupied bands first (insulators only).\n");
+}
+
+void DFPT::checkCompatibility(const Everything& e)
+{	const char* reason = 0;
+	if(e.exCorr.exxFactor()) reason = "exact exchange";
+	if(e.exCorr.needsKEdensity()) reason = "meta-GGA functionals";
+	if(e.exCorr.orbitalDep) reason = "orbital-dependent functionals";
+	if(e.eInfo.hasU) reason = "DFT+U";
+	if(e.eInfo.isNoncollinear()) reason = "noncollinear or spin-orbit calculations";
+	if(e.eInfo.fillingsUpdate != ElecInfo::FillingsConst) reason = "smearing (use fixed integer fillings for insulators)";
+	if(e.eVars.fluidParams.fluidType != FluidNone) reason = "fluids";
+	if(e.iInfo.ljOverride) reason = "the Lennard-Jones override";
+	if(e.cntrl.realSpaceProjectors) reason = "real-space projectors";
+	if(e.symm.mode != SymmetriesNone) reason = "symmetries";
+	for(auto sp: e.iInfo.species)
+		if(sp->isUltrasoft()) reason = "ultrasoft pseudopotentials";
+	if(reason) die("Linear-response (DFPT) vibrations are not supported with %s.\n", reason);
+}
+
+IonicGradient DFPT::gradDerivative(unsigned s, unsigned a, vector3<> n, ScalarFieldArray& dnOut)
+{	static StopWatch watch("DFPT"); watch.start();
+	const ElecInfo& eInfo = e.eInfo;
+	ElecVars& eVars = e.eVars;
+	atpos0 = e.iInfo.species[s]->atpos[a];
+	setBarePerturbation(s, a, n);
+
+	//Solve for the self-consistent linear response:
+	for(int q=eInfo.qStart; q<eInfo.qStop; q++)
+		if(C[q])
+		{	dC[q] = C[q].similar();
+			dC[q].zero();
+		}
+	dn.clear();
+	nullToZero(dn, e.gInfo, eVars.n.size());
+	clearState();
+	minimize(0.);
+	dnOut = clone(dn);
+
+	//Force derivative by symmetric difference along the first-order path of positions, wavefunctions and density:
+	ScalarFieldArray n0 = eVars.n;
+	std::vector<ColumnBundle> C0(eInfo.nStates);
+	std::vector< std::vector<matrix> > VdagC0(eInfo.nStates);
+	for(int q=eInfo.qStart; q<eInfo.qStop; q++)
+	{	C0[q] = eVars.C[q];
+		VdagC0[q] = eVars.VdagC[q];
+	}
+	IonicGradient grad[2];
+	for(int iSign=0; iSign<2; iSign++)
+	{	double sign = iSign ? -1. : +1.;
+		setDisplacement(s, a, (sign*h)*n);
+		eVars.n = clone(n0);
+		::axpy(sign*h, dn, eVars.n);
+		for(int q=eInfo.qStart; q<eInfo.qStop; q++)
+			if(C[q])
+			{	eVars.C[q] = clone(C0[q]);
+				eVars.C[q].setSub(0, C[q] + (sign*h)*dC[q]);
+				eVars.VdagC[q].clear();
+				e.iInfo.project(eVars.C[q], eVars.VdagC[q]);
+			}
+		e.iInfo.ionicEnergyAndGrad();
+		grad[iSign] = -e.gInfo.invRT * e.iInfo.forces;
+	}
+
+	//Restore ground state:
+	setDisplacement(s, a, vector3<>());
+	eVars.n = n0;
+	for(int q=eInfo.qStart; q<eInfo.qStop; q++)
+	{	eVars.C[q] = C0[q];
+		eVars.VdagC[q] = VdagC0[q];
+	}
+	watch.stop();
+	return (grad[0] - grad[1]) * (0.5/h);
+}
+
+ColumnBundle DFPT::applyH(int q, const ColumnBundle& X) const
+{	const IonInfo& iInfo = e.iInfo;
+	ColumnBundle HX = Idag_DiagV_I(X, e.eVars.Vscloc); //local potential
+	HX += (-0.5) * L(X); //kinetic
+	std::vector<matrix> VdagX, HVdagX(iInfo.species.size());
+	iInfo.project(X, VdagX);
+	iInfo.EnlAndGrad(e.eInfo.qnums[q], diagMatrix(X.nCols(), 1.), VdagX, HVdagX); //nonlocal
+	iInfo.projectGrad(HVdagX, X, HX);
+	return HX;
+}
+
+ColumnBundle DFPT::projectConduction(int q, const ColumnBundle& X) const
+{	ColumnBundle PX = clone(X);
+	PX -= C[q] * (C[q] ^ O(X));
+	return PX;
+}
+
+ScalarFieldArray DFPT::getdVscloc() const
+{	const ElecVars& eVars = e.eVars;
+	int nDensities = dn.size();
+	//Exchange-correlation kernel by symmetric difference along the response of the XC density:
+	ScalarFieldArray nXC = eVars.get_nXC(), dnXC = clone(dn);
+	if(dnCore)
+	{	int nSpins = std::min(nDensities, 2);
+		for(int s=0; s<nSpins; s++)
+			dnXC[s] += (1./nSpins) * dnCore;
+	}
+	ScalarFieldArray VxcPlus(nDensities), VxcMinus(nDensities);
+	e.exCorr(nXC + h*dnXC, &VxcPlus);
+	e.exCorr(nXC - h*dnXC, &VxcMinus);
+	ScalarFieldArray dVxc = (0.5/h) * (VxcPlus - VxcMinus);
+	//Bare local and Hartree contributions:
+	ScalarFieldTilde dVsclocTilde = dVlocps + (*e.coulomb)(J(nDensities==1 ? dn[0] : dn[0]+dn[1]));
+	//Collect with the normalization of ElecVars::Vscloc:
+	ScalarFieldArray dVscloc(nDensities);
+	for(int s=0; s<nDensities; s++)
+	{	dVscloc[s] = JdagOJ(dVxc[s]);
+		if(s<2) dVscloc[s] += Jdag(O(dVsclocTilde), true);
+	}
+	return dVscloc;
+}
+
+ScalarFieldArray DFPT::getDensity(int sign) const
+{	ScalarFieldArray density(e.eVars.n.size());
+	for(int q=e.eInfo.qStart; q<e.eInfo.qStop; q++)
+		if(C[q])
+			density += e.eInfo.qnums[q].weight * diagouterI(diagMatrix(C[q].nCols(), 1.), C[q] + (sign*h)*dC[q], density.size(), &e.gInfo);
+	e.symm.reduceSymmetrize(density); //Sum over processes
+	return density;
+}
+
+void DFPT::setBarePerturbation(unsigned s, unsigned a, vector3<> n)
+{	//Local pseudopotential and partial core by symmetric difference of the ion-dependent local quantities:
+	setDisplacement(s, a, h*n);
+	ScalarFieldTilde VlocpsPlus = e.iInfo.Vlocps;
+	ScalarField nCorePlus = e.iInfo.nCore;
+	setDisplacement(s, a, -h*n);
+	dVlocps = (0.5/h) * (VlocpsPlus - e.iInfo.Vlocps);
+	dnCore = nCorePlus ? (0.5/h) * (nCorePlus - e.iInfo.nCore) : 0;
+	setDisplacement(s, a, vector3<>());
+
+	//Nonlocal pseudopotential analytically from the projector derivatives of the displaced atom:
+	const SpeciesInfo& sp = *(e.iInfo.species[s]);
+	int nProj = sp.MnlAll.nRows(); //projectors per atom
+	for(int q=e.eInfo.qStart; q<e.eInfo.qStop; q++)
+		if(C[q])
+		{	if(!nProj) //purely local pseudopotential
+			{	dVnlC[q] = C[q].similar();
+				dVnlC[q].zero();
+				continue;
+			}
+			ColumnBundle V = sp.getV(C[q])->getSub(a*nProj, (a+1)*nProj);
+			ColumnBundle dV = V.similar(); dV.zero(); //derivative of projectors with atom position along n
+			for(int k=0; k<3; k++)
+				if(n[k]) ::axpy(-n[k], D(V,k), dV);
+			dVnlC[q] = dV * (sp.MnlAll * (V ^ C[q]));
+			dVnlC[q] += V * (sp.MnlAll * (dV ^ C[q]));
+		}
+}
+
+void DFPT::setDisplacement(unsigned s, unsigned a, vector3<> dx)
+{	SpeciesInfo& sp = *(e.iInfo.species[s]);
+	sp.atpos[a] = atpos0 + e.gInfo.invR * dx;
+	sp.sync_atpos();
+	e.iInfo.update(e.ener);
+}
+
+//---- Interface to Pulay ----
+
+double DFPT::sync(double x) const
+{	mpiWorld->bcast(x);
+	return x;
+}
+
+double DFPT::cycle(double dEprev, std::vector<double>& extraValues)
+{	//Solve Sternheimer equations in the current self-consistent potential:
+	ScalarFieldArray dVscloc = getdVscloc();
+	MinimizeParams mp;
+	mp.fpLog = nullLog;
+	mp.nIterations = 100;
+	nIterCG = 0;
+	for(int q=e.eInfo.qStart; q<e.eInfo.qStop; q++)
+		if(C[q])
+		{	ColumnBundle rhs = Idag_DiagV_I(C[q], dVscloc);
+			rhs += dVnlC[q];
+			rhs = projectConduction(q, rhs);
+			rhs *= -1.;
+			Sternheimer sternheimer(*this, q);
+			sternheimer.state = dC[q]; //start from previous cycle
+			double rhsNorm = sqrt(fabs(::dot(rhs, sternheimer.precondition(rhs))));
+			if(!rhsNorm) { dC[q].zero(); continue; } //no response at this q
+			mp.knormThreshold = 1e-6 * rhsNorm; //relative tolerance
+			nIterCG += sternheimer.solve(rhs, mp);
+			dC[q] = sternheimer.state;
+		}
+	mpiWorld->allReduce(nIterCG, MPIUtil::ReduceSum);
+
+	//Update density response:
+	dn = getDensity(+1);
+	dn -= getDensity(-1);
+	dn *= 0.5/h;
+	return sqrt(dot(dn, dn));
+}
+
+void DFPT::report(int iter)
+{	logPrintf("%s\tSternheimer CG iterations (all states): %d\n", mixParams.linePrefix, nIterCG);
+}
+
+void DFPT::axpy(double alpha, const ScalarFieldArray& X, ScalarFieldArray& Y) const
+{	Y.resize(e.eVars.n.size());
+	::axpy(alpha, X, Y);
+}
+
+double DFPT::dot(const ScalarFieldArray& X, const ScalarFieldArray& Y) const
+{	return e.gInfo.dV * ::dot(X, Y);
+}
+
+size_t DFPT::variableSize() const
+{	return e.gInfo.nr * e.eVars.n.size() * sizeof(double);
+}
+
+void DFPT::readVariable(ScalarFieldArray& v, FILE* fp) const
+{	nullToZero(v, e.gInfo, e.eVars.n.size());
+	for(ScalarField& X: v) loadRawBinary(X, fp);
+}
+
+void DFPT::writeVariable(const ScalarFieldArray& v, FILE* fp) const
+{	for(const ScalarField& X: v) saveRawBinary(X, fp);
+}
+
+ScalarFieldArray DFPT::getVariable() const
+{	return clone(dn);
+}
+
+void DFPT::setVariable(const ScalarFieldArray& v)
+{	dn = clone(v);
+}
+
+ScalarFieldArray DFPT::precondition(const ScalarFieldArray& v) const
+{	ScalarFieldArray Kv(v.size());
+	for(size_t s=0; s<v.size(); s++) Kv[s] = I(kerkerMix * J(v[s]));
+	return Kv;
+}
+
+ScalarFieldArray DFPT::applyMetric(const ScalarFieldArray& v) const
+{	ScalarFieldArray Mv(v.size());
+	for(size_t s=0; s<v.size(); s++) Mv[s] = I(diisMetric * J(v[s]));
+	return Mv;
+}
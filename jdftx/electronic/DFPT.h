@@ -0,0 +1,97 @@
+/*-------------------------------------------------------------------
+Copyright 2026 JDFTx contributors
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#ifndef JDFTX_ELECTRONIC_DFPT_H
+#define JDFTX_ELECTRONIC_DFPT_H
+
+#include <electronic/IonicMinimizer.h>
+#include <electronic/ColumnBundle.h>
+#include <core/PulayParams.h>
+#include <core/Pulay.h>
+
+//! @addtogroup Output
+//! @{
+//! @file DFPT.h Class DFPT
+
+/**
+Density-functional perturbation theory for Gamma-point (unit cell) ionic displacements.
+For each atomic displacement, the first-order change of the occupied wavefunctions is obtained
+from the Sternheimer equation (solved by preconditioned CG within the conduction subspace),
+and the first-order density response is made self-consistent using Pulay mixing (SCF parameters)
+of the density response. The derivative of the forces with respect to the displacement is then
+obtained as a symmetric difference of the existing force calculation (IonInfo::ionicEnergyAndGrad)
+along the first-order path of positions, wavefunctions and density, so that all force terms
+(Ewald, pair potentials, partial cores etc.) are included consistently.
+Supported for insulators (integer fillings) with norm-conserving pseudopotentials and
+semi-local functionals, without fluids, DFT+U or spinors; the calculation must not use symmetries
+(which is automatically the case within the vibrations module).
+*/
+class DFPT : public Pulay<ScalarFieldArray>
+{
+public:
+	DFPT(Everything& e); //!< set up occupied eigenstates of the converged electronic state
+	static void checkCompatibility(const Everything& e); //!< exit with an error if the calculation is not supported by DFPT
+
+	//! Return the derivative of the Cartesian energy gradient (i.e. negative forces) of all atoms, and retrieve the
+	//! first-order (spin) density response dn, for a unit Cartesian displacement n of atom a of species s.
+	IonicGradient gradDerivative(unsigned s, unsigned a, vector3<> n, ScalarFieldArray& dn);
+
+protected:
+	//---- Interface to Pulay ----
+	double sync(double x) const;
+	double cycle(double dEprev, std::vector<double>& extraValues);
+	void report(int iter);
+	void axpy(double alpha, const ScalarFieldArray& X, ScalarFieldArray& Y) const;
+	double dot(const ScalarFieldArray& X, const ScalarFieldArray& Y) const;
+	size_t variableSize() const;
+	void readVariable(ScalarFieldArray&, FILE*) const;
+	void writeVariable(const ScalarFieldArray&, FILE*) const;
+	ScalarFieldArray getVariable() const;
+	void setVariable(const ScalarFieldArray&);
+	ScalarFieldArray precondition(const ScalarFieldArray&) const;
+	ScalarFieldArray applyMetric(const ScalarFieldArray&) const;
+
+private:
+	Everything& e;
+	PulayParams mixParams; //!< mixing parameters for the density response (from SCFparams)
+	RealKernel kerkerMix, diisMetric; //!< Kerker preconditioner and DIIS metric for the density response
+	const double h; //!< symmetric-difference step (atom displacement in bohrs) for the bare local perturbation, XC kernel and force derivative
+	std::vector<ColumnBundle> C; //!< occupied eigenstates of the ground state (local states only; null if none occupied)
+	std::vector<diagMatrix> eigs; //!< corresponding eigenvalues
+
+	//Current perturbation:
+	vector3<> atpos0; //!< unperturbed lattice coordinates of the displaced atom
+	ScalarFieldTilde dVlocps; //!< bare change in local pseudopotential
+	ScalarField dnCore; //!< bare change in partial core density (if any)
+	std::vector<ColumnBundle> dVnlC; //!< bare change in nonlocal pseudopotential acting on C
+	std::vector<ColumnBundle> dC; //!< first-order change of C (within the conduction subspace)
+	ScalarFieldArray dn; //!< first-order density response
+	int nIterCG; //!< Sternheimer CG iterations in current cycle (for reporting)
+
+	ColumnBundle applyH(int q, const ColumnBundle& X) const; //!< ground-state Kohn-Sham Hamiltonian acting on X
+	ColumnBundle projectConduction(int q, const ColumnBundle& X) const; //!< remove occupied-subspace component of X
+	ScalarFieldArray getdVscloc() const; //!< self-consistent change in local potential (in Vscloc normalization) for current dn
+	ScalarFieldArray getDensity(int sign) const; //!< (spin) density of C + sign*h*dC (summed over processes)
+	void setBarePerturbation(unsigned s, unsigned a, vector3<> n); //!< set dVlocps, dnCore and dVnlC for current perturbation
+	void setDisplacement(unsigned s, unsigned a, vector3<> dx); //!< displace atom from atpos0 by Cartesian dx and update ion-dependent quantities
+	friend struct Sternheimer;
+};
+
+//! @}
+#endif //JDFTX_ELECTRONIC_DFPT_H
@@ -61,6 +61,22 @@ void Dump::setup(const Everything& everything)
 			}
 			default:; //No action necessary (needed only to suppress compiler warnings)
 		}
+	
+	//Batched band structure calculations only keep eigenvalues of all states at the end:
+	if(everything.cntrl.bandBatchSize)
+		for(auto dumpPair: *this)
+			if(dumpPair.first==DumpFreq_End)
+				switch(dumpPair.second)
+				{	case DumpNone: case DumpState: case DumpIonicPositions: case DumpLattice: case DumpIonicDensity:
+					case DumpElecDensity: case DumpCoreDensity: case DumpVlocps: case DumpVscloc:
+					case DumpBandEigs: case DumpBandProjections: case DumpEigStats: case DumpFillings:
+					case DumpEcomponents: case DumpSymmetries: case DumpKpoints: case DumpGvectors:
+						break;
+					default:
+						die("Only State, IonicPositions, Lattice, IonicDensity, ElecDensity, CoreDensity, Vlocps, Vscloc,\n"
+							"BandEigs, BandProjections, EigStats, Fillings, Ecomponents, Symmetries, Kpoints and Gvectors\n"
+							"may be dumped at End with band-batch (other outputs need all wavefunctions together).\n");
+				}
 }
 
 
@@ -140,9 +156,13 @@ void Dump::operator()(DumpFrequency freq, int iter)
 	if(ShouldDump(State))
 	{
 		//Dump wave functions
-		StartDump("wfns")
-		eInfo.write(eVars.C, fname.c_str());
-		EndDump
+		if(e->cntrl.bandBatchSize)
+			logPrintf("Wavefunctions were written in batches to '%s'.\n", getFilename("wfns").c_str());
+		else
+		{	StartDump("wfns")
+			eInfo.write(eVars.C, fname.c_str());
+			EndDump
+		}
 		
 		if(hasFluid)
 		{	//Dump state of fluid:
@@ -285,14 +305,24 @@ void Dump::operator()(DumpFrequency freq, int iter)
 				fprintf(fp, "\n");
 			}
 		}
+		FILE* fpBatch = 0; //projections written in batches (see bandMinimizeBatched), if any
+		string fnameBatch = getFilename("bandProjectionsBatch");
+		if(e->cntrl.bandBatchSize && mpiWorld->isHead())
+		{	fpBatch = fopen(fnameBatch.c_str(), "rb");
+			if(!fpBatch) die_alone("Error opening file '%s' for reading.\n", fnameBatch.c_str());
+		}
 		for(int q=0; q<eInfo.nStates; q++)
 		{	matrix proj; //orbitals: nOrbitals x nBands
-			if(eInfo.isMine(q))
+			if(fpBatch)
+			{	proj.init(iInfo.nAtomicOrbitals(), eInfo.nBands);
+				proj.read(fpBatch);
+			}
+			else if(eInfo.isMine(q) and not e->cntrl.bandBatchSize)
 			{	proj = iInfo.getAtomicOrbitals(q, true) ^ eVars.C[q]; //dagger(Opsi).Cq
 				if(not mpiWorld->isHead()) mpiWorld->sendData(proj, 0, q); //send to head for writing
 			}
 			if(mpiWorld->isHead())
-			{	if(not eInfo.isMine(q)) //recv from process that stored q
+			{	if(not (eInfo.isMine(q) or fpBatch)) //recv from process that stored q
 				{	proj.init(iInfo.nAtomicOrbitals(), eInfo.nBands);
 					mpiWorld->recvData(proj, eInfo.whose(q), q);
 				}
@@ -309,6 +339,10 @@ void Dump::operator()(DumpFrequency freq, int iter)
 			}
 		}
 		if(mpiWorld->isHead()) fclose(fp);
+		if(fpBatch)
+		{	fclose(fpBatch);
+			remove(fnameBatch.c_str()); //no longer needed
+		}
 		EndDump
 	}
 	
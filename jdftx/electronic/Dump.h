@@ -26,6 +26,8 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <set>
 #include <memory>
 
+class Everything;
+
 //! @addtogroup Output
 //! @{
 //! @file Dump.h Selection of output quantities
@@ -94,6 +96,8 @@ private:
 	std::map<DumpFrequency,string> formatFreq; //!< frequency-dependent format override
 	friend class Phonon;
 	friend class DefectSupercell;
+	friend class NEB;
+	friend void bandMinimizeBatched(Everything& e);
 	friend struct CommandDump;
 	friend struct CommandDumpName;
 	friend struct CommandDumpInterval;
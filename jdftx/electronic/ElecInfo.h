@@ -164,6 +164,7 @@ private:
 	friend class ElecVars;
 	friend struct LCAOminimizer;
 	friend void dumpFCI(const Everything& e, const char* filename);
+	friend class ResultCache;
 	
 	//!Calculate nElectrons and return magnetization at given mu, Bz and eigenvalues eps
 	double magnetizationCalc(double mu, double Bz, const std::vector<diagMatrix>& eps, double& nElectrons) const; 
@@ -174,6 +175,7 @@ private:
 	friend class Everything;
 	friend class Phonon;
 	friend class DefectSupercell;
+	friend class ProcessGroupScope;
 	void kpointsFold(); //!< Fold k-points by kfold
 	void kpointsReduce(); //!< Reduce folded k-points under symmetries
 };
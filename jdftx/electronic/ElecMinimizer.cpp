@@ -28,6 +28,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/Random.h>
 #include <core/ScalarField.h>
 #include <ctime>
+#include <cfloat>
 #include <electronic/SCF.h>
 
 void ElecGradient::init(const Everything& e)
@@ -271,6 +272,42 @@ double ElecMinimizer::sync(double x) const
 	return x;
 }
 
+//Squared distance between k-points of two states (infinite for different spins)
+inline double kDistanceSq(const Everything& e, const QuantumNumber& qnum1, const QuantumNumber& qnum2)
+{	if(qnum1.spin != qnum2.spin) return DBL_MAX;
+	return e.gInfo.GGT.metric_length_squared(qnum1.k - qnum2.k);
+}
+
+//Order states [qStart,qStop) greedily so that each state follows its nearest neighbour,
+//starting from the state nearest to qnumStart (or from qStart, if null)
+inline std::vector<int> neighborOrder(const Everything& e, int qStart, int qStop, const QuantumNumber* qnumStart)
+{	std::vector<int> order;
+	std::vector<bool> done(qStop-qStart, false);
+	const QuantumNumber* qnumCur = qnumStart;
+	for(int iStep=qStart; iStep<qStop; iStep++)
+	{	int qNext = -1; double distSqMin = DBL_MAX;
+		for(int q=qStart; q<qStop; q++)
+			if(not done[q-qStart])
+			{	double distSq = qnumCur ? kDistanceSq(e, *qnumCur, e.eInfo.qnums[q]) : 0.;
+				if(qNext<0 or distSq<distSqMin) { qNext = q; distSqMin = distSq; }
+			}
+		done[qNext-qStart] = true;
+		order.push_back(qNext);
+		qnumCur = &e.eInfo.qnums[qNext];
+	}
+	return order;
+}
+
+//Converged wavefunctions (among Csolved) nearest in k to state q with the same spin (null if none)
+inline const ColumnBundle* nearestSolved(const Everything& e, int q, const std::vector<const ColumnBundle*>& Csolved)
+{	const ColumnBundle* Cnearest = 0; double distSqMin = DBL_MAX;
+	for(const ColumnBundle* C: Csolved)
+	{	double distSq = kDistanceSq(e, *(C->qnum), e.eInfo.qnums[q]);
+		if(distSq < distSqMin) { Cnearest = C; distSqMin = distSq; }
+	}
+	return Cnearest;
+}
+
 void bandMinimize(Everything& e, bool updateVxx, bool isInner)
 {	bool fixed_H = true; std::swap(fixed_H, e.cntrl.fixed_H); //remember fixed_H flag and temporarily set it to true
 	bool loopOuter = updateVxx and e.exCorr.exxFactor(); //whether an outer loop to converge VXX is required
@@ -283,12 +320,25 @@ void bandMinimize(Everything& e, bool updateVxx, bool isInner)
 	for(int iOuter=0; iOuter<nOuter; iOuter++)
 	{	if(loopOuter) e.exx->prepareHamiltonian(e.exCorr.exxRange(), e.eVars.F, e.eVars.C);
 		e.ener.Eband = 0.;
-		for(int q=e.eInfo.qStart; q<e.eInfo.qStop; q++)
+		//Initial guesses from neighbouring k-points (only for fresh band structure calculations, not for SCF / empty states / outer loops):
+		bool neighborGuess = fixed_H and e.cntrl.davidsonNeighborGuess and (e.cntrl.elecEigenAlgo==ElecEigenDavidson) and (not isInner) and (iOuter==0);
+		std::vector<int> qOrder;
+		if(neighborGuess) qOrder = neighborOrder(e, e.eInfo.qStart, e.eInfo.qStop, 0);
+		else for(int q=e.eInfo.qStart; q<e.eInfo.qStop; q++) qOrder.push_back(q);
+		std::vector<const ColumnBundle*> Csolved;
+		for(int q: qOrder)
 		{	logPrintf("\n---- Minimization of quantum number: "); e.eInfo.kpointPrint(globalLog, q, true); logPrintf(" ----\n");
 			switch(e.cntrl.elecEigenAlgo)
 			{	case ElecEigenCG: { BandMinimizer(e, q).minimize(e.elecMinParams); break; }
-				case ElecEigenDavidson: { BandDavidson(e, q).minimize(isInner); break; }
+				case ElecEigenDavidson:
+				{	BandDavidson bd(e, q);
+					const ColumnBundle* Cneighbor = neighborGuess ? nearestSolved(e, q, Csolved) : 0;
+					if(Cneighbor) bd.initFromNeighbor(*Cneighbor);
+					bd.minimize(isInner);
+					break;
+				}
 			}
+			if(neighborGuess) Csolved.push_back(&e.eVars.C[q]);
 			e.ener.Eband += e.eInfo.qnums[q].weight * trace(e.eVars.Hsub_eigs[q]);
 		}
 		mpiWorld->allReduce(e.ener.Eband, MPIUtil::ReduceSum);
@@ -314,8 +364,148 @@ void bandMinimize(Everything& e, bool updateVxx, bool isInner)
 		e.eVars.setEigenvectors();
 }
 
+void bandMinimizeBatched(Everything& e)
+{	const ElecInfo& eInfo = e.eInfo;
+	const IonInfo& iInfo = e.iInfo;
+	ElecVars& eVars = e.eVars;
+	Dump& dump = e.dump;
+	int batchSize = e.cntrl.bandBatchSize;
+	int nBatches = ceildiv(eInfo.qStop - eInfo.qStart, batchSize);
+	mpiWorld->allReduce(nBatches, MPIUtil::ReduceMax); //all processes take part in the (collective) output of every batch
+	
+	//Output files, written at the offsets of the corresponding complete end-of-run output:
+	dump.curFreq = DumpFreq_End; dump.curIter = 0; //for filenames
+	string fnameEigs = dump.getFilename("eigenvals"); //always written (to allow restarts)
+	string fnameWfns = dump.count(std::make_pair(DumpFreq_End,DumpState)) ? dump.getFilename("wfns") : string();
+	string fnameProj = dump.count(std::make_pair(DumpFreq_End,DumpBandProjections)) ? dump.getFilename("bandProjectionsBatch") : string(); //converted to text by Dump
+	string fnameProgress = dump.getFilename("bandBatch");
+	int nOrbitals = fnameProj.length() ? iInfo.nAtomicOrbitals() : 0;
+	std::vector<long> offsetWfns(eInfo.nStates+1, 0);
+	for(int q=0; q<eInfo.nStates; q++)
+		offsetWfns[q+1] = offsetWfns[q] + long(e.basis[q].nbasis) * eInfo.spinorLength() * eInfo.nBands * sizeof(complex);
+	auto openBatchFile = [&](MPIUtil::File& fp, const string& fname, bool fresh)
+	{	if(fresh) mpiWorld->fopenWrite(fp, fname.c_str()); //start new file
+		else mpiWorld->fopenUpdate(fp, fname.c_str()); //retain previous batches
+	};
+	
+	//Resume from the last completed batch of a previous run, if available and compatible:
+	int iBatchStart = 0;
+	if(e.cntrl.bandBatchRestart && mpiWorld->isHead())
+	{	FILE* fp = fopen(fnameProgress.c_str(), "r");
+		if(fp)
+		{	int nStates, nBands, nProcesses, batchSizePrev, nDone;
+			if(fscanf(fp, "%d %d %d %d %d", &nStates, &nBands, &nProcesses, &batchSizePrev, &nDone) == 5
+				and nStates==eInfo.nStates and nBands==eInfo.nBands
+				and nProcesses==mpiWorld->nProcesses() and batchSizePrev==batchSize)
+				iBatchStart = std::min(nDone, nBatches);
+			fclose(fp);
+		}
+	}
+	mpiWorld->bcast(iBatchStart);
+	if(iBatchStart)
+	{	logPrintf("Resuming after batch %d of %d: reading eigenvalues from '%s'\n", iBatchStart, nBatches, fnameEigs.c_str());
+		int qDoneStop = std::min(eInfo.qStop, eInfo.qStart + iBatchStart*batchSize);
+		MPIUtil::File fp; mpiWorld->fopenRead(fp, fnameEigs.c_str());
+		mpiWorld->fseek(fp, eInfo.qStart*eInfo.nBands*sizeof(double), SEEK_SET);
+		for(int q=eInfo.qStart; q<qDoneStop; q++)
+		{	eVars.Hsub_eigs[q].resize(eInfo.nBands);
+			mpiWorld->freadData(eVars.Hsub_eigs[q], fp);
+		}
+		mpiWorld->fclose(fp);
+	}
+	
+	logPrintf("Minimization will be done independently for each quantum number, in batches of %d per process.\n", batchSize);
+	bool neighborGuess = e.cntrl.davidsonNeighborGuess and (e.cntrl.elecEigenAlgo==ElecEigenDavidson);
+	ColumnBundle Clast; //wavefunctions of last state solved in previous batch (retained for neighbour initial guess)
+	for(int iBatch=iBatchStart; iBatch<nBatches; iBatch++)
+	{	int qBatchStart = std::min(eInfo.qStop, eInfo.qStart + iBatch*batchSize);
+		int qBatchStop = std::min(eInfo.qStop, qBatchStart + batchSize);
+		logPrintf("\n======== Band batch %d of %d ========\n", iBatch+1, nBatches);
+		std::vector<matrix> proj(qBatchStop-qBatchStart); //atomic orbital projections (if needed)
+		std::vector<int> qOrder;
+		if(neighborGuess) qOrder = neighborOrder(e, qBatchStart, qBatchStop, Clast ? Clast.qnum : 0);
+		else for(int q=qBatchStart; q<qBatchStop; q++) qOrder.push_back(q);
+		std::vector<const ColumnBundle*> Csolved;
+		if(Clast) Csolved.push_back(&Clast);
+		for(int q: qOrder)
+		{	logPrintf("\n---- Minimization of quantum number: "); eInfo.kpointPrint(globalLog, q, true); logPrintf(" ----\n");
+			//Initialize wavefunctions (from nearest solved k-point if available, and randomly otherwise):
+			const ColumnBundle* Cneighbor = neighborGuess ? nearestSolved(e, q, Csolved) : 0;
+			if(Cneighbor) BandDavidson(e, q).initFromNeighbor(*Cneighbor);
+			else
+			{	eVars.C[q].init(eInfo.nBands, e.basis[q].nbasis * eInfo.spinorLength(), &e.basis[q], &eInfo.qnums[q], isGpuEnabled());
+				eVars.C[q].randomize(0, eInfo.nBands);
+				eVars.orthonormalize(q);
+			}
+			//Solve:
+			switch(e.cntrl.elecEigenAlgo)
+			{	case ElecEigenCG: { BandMinimizer(e, q).minimize(e.elecMinParams); eVars.setEigenvectors(q); break; }
+				case ElecEigenDavidson: { BandDavidson(e, q).minimize(false); break; }
+			}
+			if(neighborGuess) Csolved.push_back(&eVars.C[q]);
+			if(nOrbitals) proj[q-qBatchStart] = iInfo.getAtomicOrbitals(q, true) ^ eVars.C[q]; //dagger(Opsi).Cq
+		}
+		if(neighborGuess and qOrder.size()) Clast = eVars.C[qOrder.back()];
+		
+		//Write outputs of batch:
+		bool fresh = (iBatch == 0);
+		MPIUtil::File fp;
+		openBatchFile(fp, fnameEigs, fresh);
+		for(int q=qBatchStart; q<qBatchStop; q++)
+		{	mpiWorld->fseek(fp, q*eInfo.nBands*sizeof(double), SEEK_SET);
+			mpiWorld->fwriteData(eVars.Hsub_eigs[q], fp);
+		}
+		mpiWorld->fclose(fp);
+		if(fnameWfns.length())
+		{	openBatchFile(fp, fnameWfns, fresh);
+			for(int q=qBatchStart; q<qBatchStop; q++)
+			{	mpiWorld->fseek(fp, offsetWfns[q], SEEK_SET);
+				mpiWorld->fwriteData(eVars.C[q], fp);
+			}
+			mpiWorld->fclose(fp);
+		}
+		if(nOrbitals)
+		{	openBatchFile(fp, fnameProj, fresh);
+			for(int q=qBatchStart; q<qBatchStop; q++)
+			{	mpiWorld->fseek(fp, long(q)*nOrbitals*eInfo.nBands*sizeof(complex), SEEK_SET);
+				mpiWorld->fwriteData(proj[q-qBatchStart], fp);
+			}
+			mpiWorld->fclose(fp);
+		}
+		
+		//Free wavefunctions and subspace matrices of batch (retaining eigenvalues):
+		for(int q=qBatchStart; q<qBatchStop; q++)
+		{	eVars.C[q].free();
+			eVars.VdagC[q].assign(iInfo.species.size(), matrix());
+			eVars.Hsub[q] = matrix();
+			eVars.Hsub_evecs[q] = matrix();
+		}
+		
+		//Record progress:
+		if(mpiWorld->isHead())
+		{	FILE* fpProgress = fopen(fnameProgress.c_str(), "w");
+			if(!fpProgress) die_alone("Error opening file '%s' for writing.\n", fnameProgress.c_str());
+			fprintf(fpProgress, "%d %d %d %d %d\n", eInfo.nStates, eInfo.nBands, mpiWorld->nProcesses(), batchSize, iBatch+1);
+			fclose(fpProgress);
+		}
+		logPrintf("Wrote outputs of band batch %d of %d.\n", iBatch+1, nBatches); logFlush();
+	}
+	if(mpiWorld->isHead()) remove(fnameProgress.c_str()); //all batches complete
+	eVars.isRandom = false;
+	
+	//Band structure energy:
+	e.ener.Eband = 0.;
+	for(int q=eInfo.qStart; q<eInfo.qStop; q++)
+		e.ener.Eband += eInfo.qnums[q].weight * trace(eVars.Hsub_eigs[q]);
+	mpiWorld->allReduce(e.ener.Eband, MPIUtil::ReduceSum);
+	if(e.cntrl.shouldPrintEigsFillings)
+	{	print_Hsub_eigs(e);
+		logPrintf("\n"); logFlush();
+	}
+}
+
 
-void muOuterLoop(Everything& e)
+bool muOuterLoop(Everything& e)
 {	logPrintf("\n-------- mu target loop -----------\n"); logFlush();
 	assert(!std::isnan(e.eInfo.mu));
 	double muTarget = NAN;
@@ -324,7 +514,7 @@ void muOuterLoop(Everything& e)
 	#define RunFixedCharge \
 		{	e.ener.E["minusMuN"] = -muTarget * Ncur; \
 			e.eInfo.nElectrons = Ncur; \
-			elecMinimize(e); \
+			innerConverged = elecMinimize(e); \
 			double Bz; \
 			muCur = e.eInfo.findMu(e.eVars.Haux_eigs, Ncur, Bz); \
 			Gcur = relevantFreeEnergy(e); \
@@ -332,6 +522,7 @@ void muOuterLoop(Everything& e)
 	
 	//Initial calculation:
 	double Ncur = e.eInfo.nElectrons, muCur, Gcur;
+	bool innerConverged, converged = false;
 	RunFixedCharge
 	
 	//Secant-method:
@@ -344,10 +535,12 @@ void muOuterLoop(Everything& e)
 		logPrintf("MuTargetLoop: Iter: %3d  G: %+.15lf  mu: %+.9lf  nElectrons: %.6lf\n", iter, Gcur, muCur, Ncur);
 		if(fabs(muCur-muTarget) < muThreshold)
 		{	logPrintf("MuTargetLoop: Converged (|mu-muTarget|<%le).\n", muThreshold);
+			converged = true;
 			break;
 		}
 		if(!std::isnan(Gprev) && (Gcur<Gprev) && fabs(Gcur-Gprev)<EdiffThreshold)
 		{	logPrintf("MuTargetLoop: Converged (|Delta G|<%le)\n", EdiffThreshold);
+			converged = true;
 			break;
 		}
 		//Determine next point:
@@ -364,35 +557,39 @@ void muOuterLoop(Everything& e)
 	}
 	std::swap(muTarget, e.eInfo.mu); //restore finite ElecInfo::mu (fixed mu mode)
 	e.ener.E["minusMuN"] = 0.; e.ener.muN = e.eInfo.mu*e.eInfo.nElectrons; //restore normal storage of muN component
+	return converged && innerConverged;
 }
 
 
-void elecMinimize(Everything& e)
-{	
+bool elecMinimize(Everything& e)
+{	bool converged = true;
 	if(!std::isnan(e.eInfo.mu) && e.eInfo.muLoop)
-	{	muOuterLoop(e); //Run a loop over fixed charge calculations to target mu
+	{	converged = muOuterLoop(e); //Run a loop over fixed charge calculations to target mu
 	}
 	else if(e.cntrl.scf)
 	{	SCF scf(e);
 		scf.minimize();
+		converged = scf.converged;
 		if(e.cntrl.elecEigenAlgo == ElecEigenDavidson)
 			e.eVars.setEigenvectors(); //this was skipped in each bandMinimize()
 	}
 	else if(e.cntrl.fixed_H)
-	{	bandMinimize(e);
+	{	bandMinimize(e); //(no self-consistency to converge)
 	}
 	else
 	{	ElecMinimizer emin(e);
 		emin.minimize(e.elecMinParams);
+		converged = emin.converged;
 		e.eVars.setEigenvectors();
 	}
 	e.eVars.isRandom = false; //wavefunctions are no longer random
 	//Converge empty states if necessary:
 	if(e.cntrl.convergeEmptyStates and (not e.cntrl.fixed_H))
 		convergeEmptyStates(e);
+	return converged;
 }
 
-void elecFluidMinimize(Everything &e)
+bool elecFluidMinimize(Everything &e)
 {	Control &cntrl = e.cntrl;
 	ElecVars &eVars = e.eVars;
 	ElecInfo& eInfo = e.eInfo;
@@ -443,13 +640,13 @@ void elecFluidMinimize(Everything &e)
 	
 	//First electronic minimization (with fluid if present) in most cases
 	logPrintf("\n-------- Electronic minimization -----------\n"); logFlush();
-	elecMinimize(e); //non-gummel fluid will be minimized each EdensityAndVscloc() [see ElecVars.cpp]
+	bool converged = elecMinimize(e); //non-gummel fluid will be minimized each EdensityAndVscloc() [see ElecVars.cpp]
 	
 	if(eVars.fluidParams.fluidType!=FluidNone && eVars.fluidSolver->useGummel())
 	{	//gummel loop
 		logPrintf("\n-------- Electron <-> Fluid self-consistency loop -----------\n"); logFlush();
 		double dAtyp = 1.;
-		bool converged = false;
+		converged = false;
 		for(int iGummel=0; iGummel<cntrl.fluidGummel_nIterations && !killFlag; iGummel++)
 		{
 			//Fluid-side:
@@ -488,6 +685,7 @@ void elecFluidMinimize(Everything &e)
 	
 	if(!std::isnan(Evac0))
 		logPrintf("Single-point solvation energy estimate, Delta%s = %+.15f\n", relevantFreeEnergyName(e), relevantFreeEnergy(e)-Evac0);
+	return converged;
 }
 
 void convergeEmptyStates(Everything& e)
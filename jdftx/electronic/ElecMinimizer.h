@@ -75,8 +75,9 @@ private:
 };
 
 void bandMinimize(Everything& e, bool updateVxx=true, bool isInner=false); //!< band structure minimization. Update ACE representation of exact exchange operator Vxx if updateVxx = true.
-void elecMinimize(Everything& e); //!< minimize electonic system
-void elecFluidMinimize(Everything& e); //!< minimize electrons and fluid in a gummel loop if necessary
+void bandMinimizeBatched(Everything& e); //!< band structure minimization in batches of Control::bandBatchSize states, streaming outputs of each batch to the end-of-run dump files
+bool elecMinimize(Everything& e); //!< minimize electonic system, and return whether it converged
+bool elecFluidMinimize(Everything& e); //!< minimize electrons and fluid in a gummel loop if necessary, and return whether all loops converged
 void convergeEmptyStates(Everything& e); //!< run bandMinimize to converge empty states (usually called from SCF / total energy calculations)
 
 //! @}
@@ -182,9 +182,14 @@ void ElecVars::setup(const Everything &everything)
 	}
 	
 	//Wavefunction initialiation (bypass in dry runs and phonon supercell calculations)
-	if(skipWfnsInit)
+	if(e->cntrl.bandBatchSize)
+	{	if(!e->cntrl.fixed_H) die("band-batch requires fix-electron-density or fix-electron-potential.\n");
+		if(e->exCorr.exxFactor()) die("band-batch is not supported with exact exchange.\n");
+	}
+	if(skipWfnsInit or e->cntrl.bandBatchSize)
 	{	C.resize(eInfo.nStates); //skip memory allocation, but initialize array
-		logPrintf("Skipped wave function initialization.\n");
+		if(skipWfnsInit) logPrintf("Skipped wave function initialization.\n");
+		else logPrintf("Wave functions will be initialized in batches of %d states per process.\n", e->cntrl.bandBatchSize);
 	}
 	else
 	{
@@ -229,7 +234,10 @@ void ElecVars::setup(const Everything &everything)
 		
 		//Orthogonalize initial wavefunctions:
 		for(int q=eInfo.qStart; q<eInfo.qStop; q++)
-		{	C[q] = C[q] * orthoMatrix(C[q] ^ O(C[q]));
+		{	bool rotTriangular = false;
+			matrix rot = orthoMatrix(C[q] ^ O(C[q]), &rotTriangular);
+			if(rotTriangular) multiplyUpperTriangular(C[q], rot);
+			else C[q] = C[q] * rot;
 			iInfo.project(C[q], VdagC[q]);
 		}
 	}
@@ -581,19 +589,22 @@ void ElecVars::setEigenvectors()
 {	const ElecInfo& eInfo = e->eInfo;
 	logPrintf("Setting wave functions to eigenvectors of Hamiltonian\n"); logFlush();
 	for(int q=eInfo.qStart; q<eInfo.qStop; q++)
-	{
-		fixPhase(Hsub_evecs[q], Hsub_eigs[q], C[q]);
-		C[q] = C[q] * Hsub_evecs[q];
-		for(matrix& VdagCq_sp: VdagC[q])
-			if(VdagCq_sp) VdagCq_sp = VdagCq_sp * Hsub_evecs[q];
-		
-		if(eInfo.fillingsUpdate==ElecInfo::FillingsHsub && !e->cntrl.scf)
-			Haux_eigs[q] = Hsub_eigs[q];
-		
-		//Apply corresponding changes to Hsub:
-		Hsub[q] = Hsub_eigs[q]; //now diagonal
-		Hsub_evecs[q] = eye(eInfo.nBands);
-	}
+		setEigenvectors(q);
+}
+
+void ElecVars::setEigenvectors(int q)
+{	const ElecInfo& eInfo = e->eInfo;
+	fixPhase(Hsub_evecs[q], Hsub_eigs[q], C[q]);
+	C[q] = C[q] * Hsub_evecs[q];
+	for(matrix& VdagCq_sp: VdagC[q])
+		if(VdagCq_sp) VdagCq_sp = VdagCq_sp * Hsub_evecs[q];
+	
+	if(eInfo.fillingsUpdate==ElecInfo::FillingsHsub && !e->cntrl.scf)
+		Haux_eigs[q] = Hsub_eigs[q];
+	
+	//Apply corresponding changes to Hsub:
+	Hsub[q] = Hsub_eigs[q]; //now diagonal
+	Hsub_evecs[q] = eye(eInfo.nBands);
 }
 
 ScalarFieldArray ElecVars::KEdensity() const
@@ -602,11 +613,7 @@ ScalarFieldArray ElecVars::KEdensity() const
 	for(int q=e->eInfo.qStart; q<e->eInfo.qStop; q++)
 		for(int iDir=0; iDir<3; iDir++)
 			tau += (0.5*C[q].qnum->weight) * diagouterI(F[q], D(C[q],iDir), tau.size(), &e->gInfo);
-	for(ScalarField& tau_s: tau)
-	{	nullToZero(tau_s, e->gInfo);
-		tau_s->allReduceData(mpiWorld, MPIUtil::ReduceSum);
-	}
-	e->symm.symmetrize(tau); //Symmetrize
+	e->symm.reduceSymmetrize(tau); //Sum over processes and symmetrize
 	//Add core KE density model:
 	if(e->iInfo.tauCore)
 	{	int nSpins = std::min(2, int(tau.size())); //don't add to Re/Im(UpDn) in vector-spin mode
@@ -625,20 +632,21 @@ ScalarFieldArray ElecVars::calcDensity() const
 		e->iInfo.augmentDensitySpherical(e->eInfo.qnums[q], F[q], VdagC[q]); //pseudopotential contribution
 	}
 	e->iInfo.augmentDensityGrid(density);
-	for(ScalarField& ns: density)
-	{	nullToZero(ns, e->gInfo);
-		ns->allReduceData(mpiWorld, MPIUtil::ReduceSum);
-	}
-	e->symm.symmetrize(density);
+	e->symm.reduceSymmetrize(density); //Sum over processes and symmetrize
 	return density;
 }
 
 void ElecVars::orthonormalize(int q, matrix* extraRotation)
 {	assert(e->eInfo.isMine(q));
 	VdagC[q].clear();
-	matrix rot = orthoMatrix(C[q]^O(C[q], &VdagC[q])); //Compute matrix that orthonormalizes wavefunctions
-	if(extraRotation) *extraRotation = (rot = rot * (*extraRotation)); //set rot and extraRotation to the net transformation
-	C[q] = C[q] * rot;
+	bool rotTriangular = false;
+	matrix rot = orthoMatrix(C[q]^O(C[q], &VdagC[q]), &rotTriangular); //Compute matrix that orthonormalizes wavefunctions
+	if(extraRotation)
+	{	*extraRotation = (rot = rot * (*extraRotation)); //set rot and extraRotation to the net transformation
+		C[q] = C[q] * rot;
+	}
+	else if(rotTriangular) multiplyUpperTriangular(C[q], rot); //in-place, at half the cost of the general product
+	else C[q] = C[q] * rot;
 	e->iInfo.project(C[q], VdagC[q], &rot); //update the atomic projections
 }
 
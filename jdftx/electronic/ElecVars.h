@@ -111,6 +111,7 @@ public:
 	
 	//! Set C to eigenvectors of the subspace hamiltonian
 	void setEigenvectors(); 
+	void setEigenvectors(int q); //!< Set C[q] to eigenvectors of the subspace hamiltonian of state q alone
 	
 	//! Compute the kinetic energy density
 	ScalarFieldArray KEdensity() const;
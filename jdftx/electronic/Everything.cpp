@@ -21,6 +21,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <electronic/ExactExchange.h>
 #include <electronic/VanDerWaalsD3.h>
 #include <electronic/Vibrations.h>
+#include <electronic/ResultCache.h>
 #include <electronic/DOS.h>
 #include <electronic/DumpBGW_internal.h>
 #include <core/LatticeUtils.h>
@@ -145,6 +146,7 @@ void Everything::setup()
 	iInfo.update(ener); //needs to happen before eVars setup for LCAO
 	eVars.setup(*this);
 	dump.setup(*this);
+	if(resultCache) resultCache->setup(*this);
 
 	//Setup vibrations module:
 	if(vibrations) vibrations->setup(this);
@@ -36,6 +36,8 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <electronic/Dump.h>
 #include <electronic/SCFparams.h>
 #include <electronic/IonicDynamicsParams.h>
+#include <electronic/NEBparams.h>
+#include <electronic/IonicPreconditionerParams.h>
 #include <memory>
 
 //! @addtogroup ElectronicDFT
@@ -66,6 +68,8 @@ public:
 	MinimizeParams latticeMinParams; //!< lattice minimization parameters
 	MinimizeParams inverseKSminParams; //!< Inverse Kohn-sham minimization parameters
 	IonicDynamicsParams ionicDynParams; //!< Molecular dynamics parameters
+	NEBparams nebParams; //!< Nudged elastic band parameters
+	IonicPreconditionerParams ionicPrecondParams; //!< Ionic minimization preconditioner parameters
 	SCFparams scfParams; //!< Self-consistent field mixing parameters
 	
 	CoulombParams coulombParams; //!< Coulomb truncation parameters
@@ -75,6 +79,7 @@ public:
 	std::shared_ptr<VanDerWaals> vanDerWaals; //! vdw correction calculator for electronic system
 	std::shared_ptr<VanDerWaalsD2> vanDerWaalsFluid; //!< vdW correction calculation for fluid coupling / solvation
 	std::shared_ptr<class Vibrations> vibrations; //! Vibrational mode calculator
+	std::shared_ptr<class ResultCache> resultCache; //!< on-disk cache of results for repeated geometries (optional)
 
 	//! Call the setup/initialize routines of all the above in the necessray order
 	void setup();
@@ -29,6 +29,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/Thread.h>
 #include <core/GpuUtil.h>
 #include <core/VectorField.h>
+#include <core/ScalarFieldExpr.h>
 
 //---------------- Subset wrapper for MPI parallelization --------------------
 
@@ -77,7 +78,12 @@ FunctionalLDA::FunctionalLDA(LDA_Variant variant, double scaleFac) : Functional(
 
 template<LDA_Variant variant, int nCount>
 void LDA(int N, array<const double*,nCount> n, double* E, array<double*,nCount> E_n, double scaleFac)
-{	threadedLoop(LDA_calc<variant,nCount>::compute, N, n, E, E_n, scaleFac);
+{
+	#if defined(SIMD_ENABLED) && defined(VECTOR_XC_ENABLED)
+	threadLaunch(LDA_calc_simd<variant,nCount>::compute, N, n, E, E_n, scaleFac); //vectorized where available
+	#else
+	threadedLoop(LDA_calc<variant,nCount>::compute, N, n, E, E_n, scaleFac);
+	#endif
 }
 void LDA(LDA_Variant variant, int N, std::vector<const double*> n, double* E, std::vector<double*> E_n, double scaleFac)
 {	SwitchTemplate_spin(SwitchTemplate_LDA, variant, n.size(), LDA, (N, n, E, E_n, scaleFac) )
@@ -116,7 +122,12 @@ FunctionalGGA::FunctionalGGA(GGA_Variant variant, double scaleFac) : Functional(
 template<GGA_Variant variant, bool spinScaling, int nCount>
 void GGA(int N, array<const double*,nCount> n, array<const double*,2*nCount-1> sigma,
 	double* E, array<double*,nCount> E_n, array<double*,2*nCount-1> E_sigma, double scaleFac)
-{	threadedLoop(GGA_calc<variant,spinScaling,nCount>::compute, N, n, sigma, E, E_n, E_sigma, scaleFac);
+{
+	#if defined(SIMD_ENABLED) && defined(VECTOR_XC_ENABLED)
+	threadLaunch(GGA_calc_simd<variant,spinScaling,nCount>::compute, N, n, sigma, E, E_n, E_sigma, scaleFac); //vectorized where available
+	#else
+	threadedLoop(GGA_calc<variant,spinScaling,nCount>::compute, N, n, sigma, E, E_n, E_sigma, scaleFac);
+	#endif
 }
 void GGA(GGA_Variant variant, int N, std::vector<const double*> n, std::vector<const double*> sigma,
 	double* E, std::vector<double*> E_n, std::vector<double*> E_sigma, double scaleFac)
@@ -1032,10 +1043,10 @@ void ExCorr::getSecondDerivatives(const ScalarField& n, ScalarField& e_nn, Scala
 	}
 	
 	//Compute finite difference derivatives:
-	ScalarField nDen = (0.5/eps) * inv(n) * mask;
+	ScalarField nDen = (0.5/eps) * inv(lazy(n)) * mask;
 	e_nn = nDen * (configs[1].e_n - configs[2].e_n);
 	if(needsSigma)
-	{	ScalarField sigmaDen = (0.5/eps) * inv(sigma) * mask;
+	{	ScalarField sigmaDen = (0.5/eps) * inv(lazy(sigma)) * mask;
 		e_sigma = configs[0].e_sigma*mask; //First derivative available analytically
 		e_nsigma = 0.5*(nDen * (configs[1].e_sigma - configs[2].e_sigma) + sigmaDen * (configs[3].e_n - configs[4].e_n));
 		e_sigmasigma = sigmaDen * (configs[3].e_sigma - configs[4].e_sigma);
@@ -25,6 +25,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 //! @file ExCorr_internal.h Internal abstractions of, and helper routines for the internal exchange and correlation routines
 
 #include <core/vector3.h>
+#include <core/simd.h>
 
 static const double nCutoff = 1e-16; //!< ignore densities below this value
 
@@ -125,28 +126,35 @@ __hostanddev__ void spinDiagonalizeGrad_calc(int i, array<const double*,4> n, ar
 }
 
 
+//! Whether x is zero (in all lanes for SIMD types), used to select uniform branches in generic code
+__hostanddev__ bool isZero(double x) { return !x; }
+#ifdef SIMD_ENABLED
+inline bool isZero(const simdDouble& x) { return all(x == 0.); }
+#endif
+
 //! LDA spin interpolation function f(zeta) and its derivative
-__hostanddev__ double spinInterpolation(double zeta, double& f_zeta)
+//! (The helpers below are templated over scalar type T, which is double or simdDouble for vectorized evaluation)
+template<typename T> __hostanddev__ T spinInterpolation(T zeta, T& f_zeta)
 {	const double scale = 1./(pow(2.,4./3) - 2);
-	double zetaPlusCbrt = pow(1+zeta, 1./3);
-	double zetaMinusCbrt = pow(1-zeta, 1./3);
+	T zetaPlusCbrt = pow(1+zeta, 1./3);
+	T zetaMinusCbrt = pow(1-zeta, 1./3);
 	f_zeta = scale*(zetaPlusCbrt - zetaMinusCbrt)*(4./3);
 	return scale*((1+zeta)*zetaPlusCbrt + (1-zeta)*zetaMinusCbrt - 2.);
 }
 
 //! Spin-interpolate an LDA functional given its paramagnetic and ferromagnetic functors
-template<typename Para, typename Ferro> __hostanddev__ 
-double spinInterpolate(double rs, double zeta, double& e_rs, double& e_zeta, const Para& para, const Ferro& ferro)
-{	double ePara_rs, ePara = para(rs, ePara_rs);
-	if(!zeta)
+template<typename T, typename Para, typename Ferro> __hostanddev__ 
+T spinInterpolate(T rs, T zeta, T& e_rs, T& e_zeta, const Para& para, const Ferro& ferro)
+{	T ePara_rs, ePara = para(rs, ePara_rs);
+	if(isZero(zeta))
 	{	//Return paramagnetic result:
 		e_rs = ePara_rs;
 		e_zeta = 0.;
 		return ePara;
 	}
 	else //Mix in ferromagnetic result:
-	{	double eFerro_rs, eFerro = ferro(rs, eFerro_rs);
-		double f_zeta, f = spinInterpolation(zeta, f_zeta); //spin interpolation function
+	{	T eFerro_rs, eFerro = ferro(rs, eFerro_rs);
+		T f_zeta, f = spinInterpolation(zeta, f_zeta); //spin interpolation function
 		e_rs = ePara_rs + f*(eFerro_rs - ePara_rs);
 		e_zeta = f_zeta*(eFerro - ePara);
 		return ePara + f*(eFerro - ePara);
@@ -156,26 +164,26 @@ double spinInterpolate(double rs, double zeta, double& e_rs, double& e_zeta, con
 //! Spin-interpolate an LDA functional given its paramagnetic, ferromagnetic and spin-stiffness functors
 //! (This is the spin-inteprolation technique used in the VWN and PW correlation functionals)
 //! (For numerical compatibility with the original PW routine, the f"(0) scale factor may be over-ridden)
-template<typename Para, typename Ferro, typename Stiff> __hostanddev__ 
-double spinInterpolate(double rs, double zeta, double& e_rs, double& e_zeta,
+template<typename T, typename Para, typename Ferro, typename Stiff> __hostanddev__ 
+T spinInterpolate(T rs, T zeta, T& e_rs, T& e_zeta,
 	const Para& para, const Ferro& ferro, const Stiff& stiff,
 	const double fDblPrime0 = 4./(9*(pow(2., 1./3)-1)))
 {
-	double ePara_rs, ePara = para(rs, ePara_rs); //Paramagentic
-	if(!zeta) //return paramagentic result
+	T ePara_rs, ePara = para(rs, ePara_rs); //Paramagentic
+	if(isZero(zeta)) //return paramagentic result
 	{	e_rs = ePara_rs;
 		e_zeta = 0.;
 		return ePara;
 	}
 	else //Mix in ferromagnetic and zeta-derivative results:
-	{	double eFerro_rs, eFerro = ferro(rs, eFerro_rs); //Ferromagnetic
-		double eStiff_rs, eStiff = stiff(rs, eStiff_rs); //Spin-derivative
+	{	T eFerro_rs, eFerro = ferro(rs, eFerro_rs); //Ferromagnetic
+		T eStiff_rs, eStiff = stiff(rs, eStiff_rs); //Spin-derivative
 		//Compute mix factors:
-		double f_zeta, f = spinInterpolation(zeta, f_zeta); //spin interpolation function
-		double zeta2=zeta*zeta, zeta3=zeta2*zeta, zeta4=zeta2*zeta2; //powers of zeta
+		T f_zeta, f = spinInterpolation(zeta, f_zeta); //spin interpolation function
+		T zeta2=zeta*zeta, zeta3=zeta2*zeta, zeta4=zeta2*zeta2; //powers of zeta
 		const double scale = -1./fDblPrime0;
-		double w1 = zeta4*f,             w1_zeta = 4*zeta3*f + zeta4*f_zeta;
-		double w2 = scale*((1-zeta4)*f), w2_zeta = scale*(-4*zeta3*f + (1-zeta4)*f_zeta);
+		T w1 = zeta4*f,             w1_zeta = 4*zeta3*f + zeta4*f_zeta;
+		T w2 = scale*((1-zeta4)*f), w2_zeta = scale*(-4*zeta3*f + (1-zeta4)*f_zeta);
 		//Mix:
 		e_rs = ePara_rs + w1*(eFerro_rs-ePara_rs) + w2*eStiff_rs;
 		e_zeta = w1_zeta*(eFerro-ePara) + w2_zeta*eStiff;
@@ -136,6 +136,14 @@ template<GGA_Variant variant> __hostanddev__
 double GGA_eval(double rs, double zeta, double g, double t2,
 	double& e_rs, double& e_zeta, double& e_g, double& e_t2);
 
+//! GGA_eval templated over the scalar type T (double, or simdDouble for vectorized evaluation).
+//! Specialized (with available = true) for functionals whose implementation is branch-free
+//! or uses only uniform branches; eval() then has the signature of the corresponding GGA_eval above,
+//! which simply calls eval() with T = double.
+template<GGA_Variant variant> struct GGA_evalT
+{	static const bool available = false;
+};
+
 //! GGA interface outer layer: Accumulate GGA energy density (per unit volume)
 //! and its derivatives w.r.t. density and sigma (gradient contractions)
 //! Uses template specializations of the appropriate version of GGA_eval
@@ -221,24 +229,24 @@ struct GGA_calc <variant, false, nCount>
 //---------------------- GGA exchange implementations ---------------------------
 
 //! Slater exchange as a function of rs (PER PARTICLE):
-__hostanddev__ double slaterExchange(double rs, double& e_rs)
+template<typename T> __hostanddev__ T slaterExchange(T rs, T& e_rs)
 {	
-	double rsInvMinus = -1./rs;
-	double e = rsInvMinus * (0.75*pow(1.5/M_PI, 2./3));
+	T rsInvMinus = -1./rs;
+	T e = rsInvMinus * (0.75*pow(1.5/M_PI, 2./3));
 	e_rs = rsInvMinus * e;
 	return e;
 }
 
 //! PBE GGA exchange [JP Perdew, K Burke, and M Ernzerhof, Phys. Rev. Lett. 77, 3865 (1996)]
-__hostanddev__ double GGA_PBE_exchange(const double kappa, const double mu,
-	double rs, double s2, double& e_rs, double& e_s2)
+template<typename T> __hostanddev__ T GGA_PBE_exchange(const double kappa, const double mu,
+	T rs, T s2, T& e_rs, T& e_s2)
 {	//Slater exchange:
-	double eSlater_rs, eSlater = slaterExchange(rs, eSlater_rs);
+	T eSlater_rs, eSlater = slaterExchange(rs, eSlater_rs);
 	//PBE Enhancement factor:
 	const double kappaByMu = kappa/mu;
-	double frac = -1./(kappaByMu + s2);
-	double F = 1+kappa + (kappa*kappaByMu) * frac;
-	double F_s2 = (kappa*kappaByMu) * frac * frac;
+	T frac = -1./(kappaByMu + s2);
+	T F = 1+kappa + (kappa*kappaByMu) * frac;
+	T F_s2 = (kappa*kappaByMu) * frac * frac;
 	//GGA result:
 	e_rs = eSlater_rs * F;
 	e_s2 = eSlater * F_s2;
@@ -246,13 +254,25 @@ __hostanddev__ double GGA_PBE_exchange(const double kappa, const double mu,
 }
 
 //! PBE GGA exchange [JP Perdew, K Burke, and M Ernzerhof, Phys. Rev. Lett. 77, 3865 (1996)]
+template<> struct GGA_evalT<GGA_X_PBE>
+{	static const bool available = true;
+	template<typename T> __hostanddev__ static T eval(T rs, T s2, T& e_rs, T& e_s2)
+	{	return GGA_PBE_exchange(0.804, 0.2195149727645171, rs, s2, e_rs, e_s2);
+	}
+};
 template<> __hostanddev__ double GGA_eval<GGA_X_PBE>(double rs, double s2, double& e_rs, double& e_s2)
-{	return GGA_PBE_exchange(0.804, 0.2195149727645171, rs, s2, e_rs, e_s2);
+{	return GGA_evalT<GGA_X_PBE>::eval(rs, s2, e_rs, e_s2);
 }
 
 //! PBEsol GGA exchange [JP Perdew et al, Phys. Rev. Lett. 100, 136406 (2008)]
+template<> struct GGA_evalT<GGA_X_PBEsol>
+{	static const bool available = true;
+	template<typename T> __hostanddev__ static T eval(T rs, T s2, T& e_rs, T& e_s2)
+	{	return GGA_PBE_exchange(0.804, 10./81, rs, s2, e_rs, e_s2);
+	}
+};
 template<> __hostanddev__ double GGA_eval<GGA_X_PBEsol>(double rs, double s2, double& e_rs, double& e_s2)
-{	return GGA_PBE_exchange(0.804, 10./81, rs, s2, e_rs, e_s2);
+{	return GGA_evalT<GGA_X_PBEsol>::eval(rs, s2, e_rs, e_s2);
 }
 
 
@@ -498,32 +518,32 @@ template<int nCount> struct GGA_calc <GGA_X_LB94, true, nCount>
 //! Also the H fuunction (equations 7,8) of PBE.
 //! The notation is a mixture, picking the shortest of both references:
 //! using g from PW91 (phi in PBE) and gamma from PBE (beta^2/(2*alpha) in PW91).
-__hostanddev__ double PW91_H0(const double gamma,
-	double beta, double g3, double t2, double ecUnif,
-	double& H0_beta, double& H0_g3, double& H0_t2, double& H0_ecUnif)
+template<typename T> __hostanddev__ T PW91_H0(const double gamma,
+	T beta, T g3, T t2, T ecUnif,
+	T& H0_beta, T& H0_g3, T& H0_t2, T& H0_ecUnif)
 {
-	const double betaByGamma = beta/gamma;
+	const T betaByGamma = beta/gamma;
 	//Compute A (PBE equation (8), PW91 equation (14)) and its derivatives:
-	double expArg = ecUnif/(gamma*g3);
-	double expTerm = exp(-expArg);
-	double A_betaByGamma = 1./(expTerm-1);
-	double A = betaByGamma * A_betaByGamma;
-	double A_expArg = A * A_betaByGamma * expTerm;
-	double A_ecUnif = A_expArg/(gamma*g3);
-	double A_g3 = -A_expArg*expArg/g3;
+	T expArg = ecUnif/(gamma*g3);
+	T expTerm = exp(-expArg);
+	T A_betaByGamma = 1./(expTerm-1);
+	T A = betaByGamma * A_betaByGamma;
+	T A_expArg = A * A_betaByGamma * expTerm;
+	T A_ecUnif = A_expArg/(gamma*g3);
+	T A_g3 = -A_expArg*expArg/g3;
 	//Start with the innermost rational function
-	double At2 = A*t2;
-	double num = 1.+At2,          num_At2 = 1.;
-	double den = 1.+At2*(1.+At2), den_At2 = 1.+2*At2;
-	double frac = num/den,        frac_At2 = (num_At2*den-num*den_At2)/(den*den);
+	T At2 = A*t2;
+	T num = 1.+At2,          num_At2 = 1.;
+	T den = 1.+At2*(1.+At2), den_At2 = 1.+2*At2;
+	T frac = num/den,        frac_At2 = (num_At2*den-num*den_At2)/(den*den);
 	//Log of the rational function
-	double logArg = 1 + betaByGamma*t2*frac;
-	double logTerm = log(logArg);
-	double logTerm_betaByGamma = t2*frac/logArg;
-	double logTerm_t2 = betaByGamma*(frac + t2*A*frac_At2)/logArg;
-	double logTerm_A = betaByGamma*t2*t2*frac_At2/logArg;
+	T logArg = 1 + betaByGamma*t2*frac;
+	T logTerm = log(logArg);
+	T logTerm_betaByGamma = t2*frac/logArg;
+	T logTerm_t2 = betaByGamma*(frac + t2*A*frac_At2)/logArg;
+	T logTerm_A = betaByGamma*t2*t2*frac_At2/logArg;
 	//Final expression:
-	double H0_A = gamma*g3*logTerm_A;
+	T H0_A = gamma*g3*logTerm_A;
 	H0_beta = (gamma*g3*logTerm_betaByGamma + H0_A * A_betaByGamma)/gamma;
 	H0_g3 = gamma*logTerm + H0_A * A_g3;
 	H0_t2 = gamma*g3*logTerm_t2;
@@ -534,19 +554,19 @@ __hostanddev__ double PW91_H0(const double gamma,
 
 //! PBE GGA correlation [JP Perdew, K Burke, and M Ernzerhof, Phys. Rev. Lett. 77, 3865 (1996)]
 //! If beta depends on rs (as in revTPSS), beta_rs (=dbeta/drs) is propagated to e_rs
-__hostanddev__ double GGA_PBE_correlation(const double beta, const double beta_rs,
-	double rs, double zeta, double g, double t2,
-	double& e_rs, double& e_zeta, double& e_g, double& e_t2)
+template<typename T> __hostanddev__ T GGA_PBE_correlation(const double beta, const double beta_rs,
+	T rs, T zeta, T g, T t2,
+	T& e_rs, T& e_zeta, T& e_g, T& e_t2)
 {	
 	//Compute uniform correlation energy and its derivatives:
-	double ecUnif_rs, ecUnif_zeta;
-	double ecUnif = LDA_eval<LDA_C_PW_prec>(rs, zeta, ecUnif_rs, ecUnif_zeta);
+	T ecUnif_rs, ecUnif_zeta;
+	T ecUnif = LDA_evalT<LDA_C_PW_prec>::eval(rs, zeta, ecUnif_rs, ecUnif_zeta);
 	
 	//Compute gradient correction H:
-	double g2=g*g, g3 = g*g2;
-	double H_beta, H_g3, H_t2, H_ecUnif;
+	T g2=g*g, g3 = g*g2;
+	T H_beta, H_g3, H_t2, H_ecUnif;
 	const double gamma = (1. - log(2.))/(M_PI*M_PI);
-	double H = PW91_H0(gamma, beta, g3, t2, ecUnif, H_beta, H_g3, H_t2, H_ecUnif);
+	T H = PW91_H0<T>(gamma, beta, g3, t2, ecUnif, H_beta, H_g3, H_t2, H_ecUnif);
 	
 	//Put together final results (propagate gradients):
 	e_rs = ecUnif_rs + H_ecUnif*ecUnif_rs + H_beta*beta_rs;
@@ -557,15 +577,27 @@ __hostanddev__ double GGA_PBE_correlation(const double beta, const double beta_r
 }
 
 //! PBE GGA correlation [JP Perdew, K Burke, and M Ernzerhof, Phys. Rev. Lett. 77, 3865 (1996)]
+template<> struct GGA_evalT<GGA_C_PBE>
+{	static const bool available = true;
+	template<typename T> __hostanddev__ static T eval(T rs, T zeta, T g, T t2, T& e_rs, T& e_zeta, T& e_g, T& e_t2)
+	{	return GGA_PBE_correlation(0.06672455060314922, 0., rs, zeta, g, t2, e_rs, e_zeta, e_g, e_t2);
+	}
+};
 template<> __hostanddev__ double GGA_eval<GGA_C_PBE>(double rs, double zeta, double g, double t2,
 	double& e_rs, double& e_zeta, double& e_g, double& e_t2)
-{	return GGA_PBE_correlation(0.06672455060314922, 0., rs, zeta, g, t2, e_rs, e_zeta, e_g, e_t2);
+{	return GGA_evalT<GGA_C_PBE>::eval(rs, zeta, g, t2, e_rs, e_zeta, e_g, e_t2);
 }
 
 //! PBEsol GGA correlation [JP Perdew et al, Phys. Rev. Lett. 100, 136406 (2008)]
+template<> struct GGA_evalT<GGA_C_PBEsol>
+{	static const bool available = true;
+	template<typename T> __hostanddev__ static T eval(T rs, T zeta, T g, T t2, T& e_rs, T& e_zeta, T& e_g, T& e_t2)
+	{	return GGA_PBE_correlation(0.046, 0., rs, zeta, g, t2, e_rs, e_zeta, e_g, e_t2);
+	}
+};
 template<> __hostanddev__ double GGA_eval<GGA_C_PBEsol>(double rs, double zeta, double g, double t2,
 	double& e_rs, double& e_zeta, double& e_g, double& e_t2)
-{	return GGA_PBE_correlation(0.046, 0., rs, zeta, g, t2, e_rs, e_zeta, e_g, e_t2);
+{	return GGA_evalT<GGA_C_PBEsol>::eval(rs, zeta, g, t2, e_rs, e_zeta, e_g, e_t2);
 }
 
 //! PW91 GGA correlation [JP Perdew et al, Phys. Rev. B 46, 6671 (1992)]
@@ -670,5 +702,115 @@ template<> __hostanddev__ double GGA_eval<GGA_KE_PW91>(double rs, double s2, dou
 	return eTF * F;
 }
 
+
+#ifdef SIMD_ENABLED
+//! Vectorized GGA_calc for all points in [iStart,iStop) (a threadLaunch-compatible function).
+//! Functionals without a vectorized implementation (GGA_evalT unavailable) fall back to GGA_calc for each point.
+template<GGA_Variant variant, bool spinScaling, int nCount, bool available=GGA_evalT<variant>::available> struct GGA_calc_simd
+{	static void compute(size_t iStart, size_t iStop, array<const double*,nCount> n, array<const double*,2*nCount-1> sigma,
+		double* E, array<double*,nCount> E_n, array<double*,2*nCount-1> E_sigma, double scaleFac)
+	{	for(size_t i=iStart; i<iStop; i++)
+			GGA_calc<variant,spinScaling,nCount>::compute(i, n, sigma, E, E_n, E_sigma, scaleFac);
+	}
+};
+
+//! Specialization of GGA_calc_simd for spin-scaling functionals using GGA_evalT: same as GGA_calc,
+//! but for simdDouble::width points at a time, with the density cutoff applied by masking
+template<GGA_Variant variant, int nCount> struct GGA_calc_simd<variant, true, nCount, true>
+{	static void compute(size_t iStart, size_t iStop, array<const double*,nCount> n, array<const double*,2*nCount-1> sigma,
+		double* E, array<double*,nCount> E_n, array<double*,2*nCount-1> E_sigma, double scaleFac)
+	{	size_t i = iStart;
+		for(; i+simdDouble::width <= iStop; i+=simdDouble::width)
+		{	simdDouble Ei = simdDouble::load(E+i);
+			//Each spin component is computed separately:
+			for(int s=0; s<nCount; s++)
+			{	//Scale up s-density and gradient:
+				simdDouble nIn = simdDouble::load(n[s]+i);
+				simdMask mask = !(nIn * nCount < nCutoff);
+				if(!any(mask)) continue;
+				nIn = select(mask, nIn, 1.); //keep skipped lanes finite
+				simdDouble ns = nIn * nCount;
+				simdDouble scale = select(mask, scaleFac, 0.); //zero contributions of skipped lanes
+				//Compute dimensionless quantities rs and s2:
+				simdDouble rs = pow((4.*M_PI/3.)*ns, (-1./3));
+				simdDouble s2_sigma = pow(ns, -8./3) * ((0.25*nCount*nCount) * pow(3.*M_PI*M_PI, -2./3));
+				simdDouble s2 = s2_sigma * select(mask, simdDouble::load(sigma[2*s]+i), 0.);
+				//Compute energy density and its gradients using GGA_evalT:
+				simdDouble e_rs, e_s2, e = GGA_evalT<variant>::eval(rs, s2, e_rs, e_s2);
+				//Compute gradients if required:
+				if(E_n[0])
+				{	//Propagate s and rs gradients to n and sigma:
+					simdDouble e_n = -(e_rs*rs + 8*e_s2*s2) / (3. * nIn);
+					simdDouble e_sigma = e_s2 * s2_sigma;
+					//Convert form per-particle to per volume:
+					(simdDouble::load(E_n[s]+i) + scale*( nIn * e_n + e )).store(E_n[s]+i);
+					(simdDouble::load(E_sigma[2*s]+i) + scale*( nIn * e_sigma )).store(E_sigma[2*s]+i);
+				}
+				Ei += scale*( nIn * e );
+			}
+			Ei.store(E+i);
+		}
+		for(; i<iStop; i++) //remainder
+			GGA_calc<variant,true,nCount>::compute(i, n, sigma, E, E_n, E_sigma, scaleFac);
+	}
+};
+
+//! Specialization of GGA_calc_simd for functionals that do not spin-scale using GGA_evalT: same as GGA_calc,
+//! but for simdDouble::width points at a time, with the density cutoff applied by masking
+template<GGA_Variant variant, int nCount> struct GGA_calc_simd<variant, false, nCount, true>
+{	static void compute(size_t iStart, size_t iStop, array<const double*,nCount> n, array<const double*,2*nCount-1> sigma,
+		double* E, array<double*,nCount> E_n, array<double*,2*nCount-1> E_sigma, double scaleFac)
+	{	size_t i = iStart;
+		for(; i+simdDouble::width <= iStop; i+=simdDouble::width)
+		{	//Compute nTot and rs, and ignore tiny densities:
+			simdDouble n0 = simdDouble::load(n[0]+i);
+			simdDouble n1 = (nCount==1) ? simdDouble(0.) : simdDouble::load(n[nCount-1]+i);
+			simdDouble nTot = n0 + n1;
+			simdMask mask = !(nTot < nCutoff);
+			if(!any(mask)) continue;
+			nTot = select(mask, nTot, 1.); //keep skipped lanes finite
+			simdDouble rs = pow((4.*M_PI/3.)*nTot, (-1./3));
+			simdDouble scale = select(mask, scaleFac, 0.); //zero contributions of skipped lanes
+			
+			//Compute zeta, g(zeta) and dimensionless gradient squared t2:
+			simdDouble zeta = (nCount==1) ? simdDouble(0.) : select(mask, (n0 - n1)/nTot, 0.);
+			simdDouble g = 0.5*(pow(1+zeta, 2./3) + pow(1-zeta, 2./3));
+			simdDouble t2_sigma = (pow(M_PI/3, 1./3)/16.) * pow(nTot,-7./3) / (g*g);
+			simdDouble sigmaTot = (nCount==1)
+				? simdDouble::load(sigma[0]+i)
+				: simdDouble::load(sigma[0]+i) + 2*simdDouble::load(sigma[nCount-1]+i) + simdDouble::load(sigma[2*nCount-2]+i);
+			simdDouble t2 = t2_sigma * select(mask, sigmaTot, 0.);
+			
+			//Compute per-particle energy and derivatives:
+			simdDouble e_rs, e_zeta, e_g, e_t2;
+			simdDouble e = GGA_evalT<variant>::eval(rs, zeta, g, t2, e_rs, e_zeta, e_g, e_t2);
+			
+			//Compute and store final n/sigma derivatives if required
+			if(E_n[0])
+			{	simdDouble e_nTot = -(e_rs*rs + 7.*e_t2*t2) / (3.*nTot); //propagate rs and t2 derivatives to nTot
+				simdDouble e_sigma = e_t2 * t2_sigma; //derivative w.r.t |DnTot|^2
+				
+				simdDouble g_zeta = (1./3) * //Avoid singularities at zeta = +/- 1:
+					( select(1+zeta > nCutoff, pow(1+zeta, -1./3), 0.)
+					- select(1-zeta > nCutoff, pow(1-zeta, -1./3), 0.) );
+				e_zeta += (e_g - 2. * e_t2*t2 / g) * g_zeta;
+				
+				simdDouble E_nTot = e + nTot * e_nTot;
+				(simdDouble::load(E_n[0]+i) + scale*( E_nTot - e_zeta * (zeta-1) )).store(E_n[0]+i);
+				(simdDouble::load(E_sigma[0]+i) + scale*( nTot * e_sigma )).store(E_sigma[0]+i);
+				if(nCount>1)
+				{	(simdDouble::load(E_n[nCount-1]+i) + scale*( E_nTot - e_zeta * (zeta+1) )).store(E_n[nCount-1]+i);
+					(simdDouble::load(E_sigma[nCount-1]+i) + scale*( (nTot * e_sigma) * 2 )).store(E_sigma[nCount-1]+i);
+					(simdDouble::load(E_sigma[2*nCount-2]+i) + scale*( nTot * e_sigma )).store(E_sigma[2*nCount-2]+i);
+				}
+			}
+			(simdDouble::load(E+i) + scale*( nTot * e )).store(E+i); //energy density per volume
+		}
+		for(; i<iStop; i++) //remainder
+			GGA_calc<variant,false,nCount>::compute(i, n, sigma, E, E_n, E_sigma, scaleFac);
+	}
+};
+#endif
+
 //! @}
 #endif // JDFTX_ELECTRONIC_EXCORR_INTERNAL_GGA_H
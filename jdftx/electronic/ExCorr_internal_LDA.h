@@ -109,6 +109,13 @@ private:
 template<LDA_Variant variant> __hostanddev__
 double LDA_eval(double rs, double zeta, double& e_rs, double& e_zeta);
 
+//! LDA_eval templated over the scalar type T (double, or simdDouble for vectorized evaluation).
+//! Specialized (with available = true) for functionals whose implementation is branch-free
+//! or uses only uniform branches; the corresponding LDA_eval simply calls eval() with T = double.
+template<LDA_Variant variant> struct LDA_evalT
+{	static const bool available = false;
+};
+
 //! LDA interface outer layer: Accumulate LDA energy density (per unit volume) and its density derivatives
 //! Uses template specializations of LDA_eval for each functional written in terms of rs and zeta
 //! This layer may be directly specialized for simpler functionals (eg. Slater exchange, Thomas-Fermi KE)
@@ -202,7 +209,7 @@ double LDA_eval<LDA_C_PZ>(double rs, double zeta, double& e_rs, double& e_zeta)
 //! @tparam spinID Compute paramagnetic for spinID=0, ferromagnetic for spinID=1 and spin-stiffness for spinID=2
 //! @tparam prec false for original PW coefficients, true for higher precision version used in PBE
 template<int spinID, bool prec=true> struct LDA_eval_C_PW
-{	__hostanddev__ double operator()(double rs, double& e_rs) const
+{	template<typename T> __hostanddev__ T operator()(T rs, T& e_rs) const
 	{	//PW fit parameters for          paramagnetic            ferromagnetic    zeta-derivative
 		const double A     = prec
 		                 ? ( (spinID==0) ? 0.0310907 : ((spinID==1) ? 0.01554535 : 0.0168869) )
@@ -213,30 +220,42 @@ template<int spinID, bool prec=true> struct LDA_eval_C_PW
 		const double beta3 = (spinID==0) ? 1.6382    : ((spinID==1) ? 3.3662     : 0.88026);
 		const double beta4 = (spinID==0) ? 0.49294   : ((spinID==1) ? 0.62517    : 0.49671);
 		//Denominator of rational function inside the log of equation (10):
-		double x = sqrt(rs);
-		double den   = (2*A)*x*(beta1 + x*(beta2 + x*(beta3 + x*(beta4))));
-		double den_x = (2*A)*(beta1 + x*(2*beta2 + x*(3*beta3 + x*(4*beta4))));
-		double den_rs = den_x * 0.5/x; //propagate x derivative to rs derivative
+		T x = sqrt(rs);
+		T den   = (2*A)*x*(beta1 + x*(beta2 + x*(beta3 + x*(beta4))));
+		T den_x = (2*A)*(beta1 + x*(2*beta2 + x*(3*beta3 + x*(4*beta4))));
+		T den_rs = den_x * 0.5/x; //propagate x derivative to rs derivative
 		//The log term of equation (10):
-		double logTerm    = log(1.+1./den);
-		double logTerm_rs = -den_rs/(den*(1.+den));
+		T logTerm    = log(1.+1./den);
+		T logTerm_rs = -den_rs/(den*(1.+den));
 		//Equation (10) and its derivative:
 		e_rs = -(2*A) * (alpha * logTerm + (1+alpha*rs) * logTerm_rs);
 		return -(2*A) * (1+alpha*rs) * logTerm;
 	}
 };
 //! Perdew-Wang correlation (original version, for numerical compatibility with LibXC's PW91)
+template<> struct LDA_evalT<LDA_C_PW>
+{	static const bool available = true;
+	template<typename T> __hostanddev__ static T eval(T rs, T zeta, T& e_rs, T& e_zeta)
+	{	return spinInterpolate(rs, zeta, e_rs, e_zeta,
+			LDA_eval_C_PW<0,false>(), LDA_eval_C_PW<1,false>(), LDA_eval_C_PW<2,false>(),
+			1.709921); //truncation of 4./(9*(2^(1./3) - 1)) at ~ single precision
+	}
+};
 template<> __hostanddev__
 double LDA_eval<LDA_C_PW>(double rs, double zeta, double& e_rs, double& e_zeta)
-{	return spinInterpolate(rs, zeta, e_rs, e_zeta,
-		LDA_eval_C_PW<0,false>(), LDA_eval_C_PW<1,false>(), LDA_eval_C_PW<2,false>(),
-		1.709921); //truncation of 4./(9*(2^(1./3) - 1)) at ~ single precision
+{	return LDA_evalT<LDA_C_PW>::eval(rs, zeta, e_rs, e_zeta);
 }
 //! Perdew-Wang correlation (extended precision version, for numerical compatibility with LibXC's PBE)
+template<> struct LDA_evalT<LDA_C_PW_prec>
+{	static const bool available = true;
+	template<typename T> __hostanddev__ static T eval(T rs, T zeta, T& e_rs, T& e_zeta)
+	{	return spinInterpolate(rs, zeta, e_rs, e_zeta,
+			LDA_eval_C_PW<0>(), LDA_eval_C_PW<1>(), LDA_eval_C_PW<2>()); //defaults are high-prec versions
+	}
+};
 template<> __hostanddev__
 double LDA_eval<LDA_C_PW_prec>(double rs, double zeta, double& e_rs, double& e_zeta)
-{	return spinInterpolate(rs, zeta, e_rs, e_zeta,
-		LDA_eval_C_PW<0>(), LDA_eval_C_PW<1>(), LDA_eval_C_PW<2>()); //defaults are high-prec versions
+{	return LDA_evalT<LDA_C_PW_prec>::eval(rs, zeta, e_rs, e_zeta);
 }
 
 
@@ -305,5 +324,72 @@ double LDA_eval<LDA_XC_Teter>(double rs, double zeta, double& e_rs, double& e_ze
 	return -num/den;
 };
 
+
+#ifdef SIMD_ENABLED
+//! Vectorized LDA_calc for all points in [iStart,iStop) (a threadLaunch-compatible function).
+//! Functionals without a vectorized implementation (LDA_evalT unavailable) fall back to LDA_calc for each point.
+template<LDA_Variant variant, int nCount, bool available=LDA_evalT<variant>::available> struct LDA_calc_simd
+{	static void compute(size_t iStart, size_t iStop, array<const double*,nCount> n, double* E, array<double*,nCount> E_n, double scaleFac)
+	{	for(size_t i=iStart; i<iStop; i++)
+			LDA_calc<variant,nCount>::compute(i, n, E, E_n, scaleFac);
+	}
+};
+
+//! Specialization of LDA_calc_simd using LDA_evalT: same as LDA_calc, but for simdDouble::width points at a time,
+//! with the density cutoff applied by masking (and a scalar loop for the remainder)
+template<LDA_Variant variant, int nCount> struct LDA_calc_simd<variant, nCount, true>
+{	static void compute(size_t iStart, size_t iStop, array<const double*,nCount> n, double* E, array<double*,nCount> E_n, double scaleFac)
+	{	size_t i = iStart;
+		for(; i+simdDouble::width <= iStop; i+=simdDouble::width)
+		{	//Compute nTot and rs, and ignore tiny densities:
+			simdDouble n0 = simdDouble::load(n[0]+i);
+			simdDouble n1 = (nCount==1) ? simdDouble(0.) : simdDouble::load(n[nCount-1]+i);
+			simdDouble nTot = n0 + n1;
+			simdMask mask = !(nTot < nCutoff);
+			if(!any(mask)) continue;
+			nTot = select(mask, nTot, 1.); //keep skipped lanes finite
+			simdDouble rs = pow((4.*M_PI/3.)*nTot, (-1./3));
+			simdDouble scale = select(mask, scaleFac, 0.); //zero contributions of skipped lanes
+			
+			//Compute the per particle energy and its derivatives:
+			simdDouble zeta = (nCount==1) ? simdDouble(0.) : select(mask, (n0 - n1)/nTot, 0.);
+			simdDouble e_rs, e_zeta, e = LDA_evalT<variant>::eval(rs, zeta, e_rs, e_zeta);
+			
+			//Compute and store final n derivatives if required
+			if(E_n[0])
+			{	simdDouble e_nTot = -e_rs * rs / (3. * nTot); //propagate rs derivative to nTot;
+				simdDouble E_nTot = e + nTot * e_nTot; //derivative of energy density per volume
+				(simdDouble::load(E_n[0]+i) + scale*( E_nTot - e_zeta * (zeta-1) )).store(E_n[0]+i);
+				if(nCount>1) (simdDouble::load(E_n[nCount-1]+i) + scale*( E_nTot - e_zeta * (zeta+1) )).store(E_n[nCount-1]+i);
+			}
+			(simdDouble::load(E+i) + scale*( nTot * e )).store(E+i); //energy density per volume
+		}
+		for(; i<iStop; i++) //remainder
+			LDA_calc<variant,nCount>::compute(i, n, E, E_n, scaleFac);
+	}
+};
+
+//! Specialization of LDA_calc_simd for Slater exchange (vectorized version of the corresponding LDA_calc)
+template<int nCount> struct LDA_calc_simd<LDA_X_Slater, nCount, false>
+{	static void compute(size_t iStart, size_t iStop, array<const double*,nCount> n, double* E, array<double*,nCount> E_n, double scaleFac)
+	{	const double Xprefac = (-0.75/nCount) * pow(3./M_PI, 1./3);
+		size_t i = iStart;
+		for(; i+simdDouble::width <= iStop; i+=simdDouble::width)
+		{	simdDouble Ei = simdDouble::load(E+i);
+			for(int s=0; s<nCount; s++)
+			{	simdDouble ns = simdDouble::load(n[s]+i) * nCount;
+				simdDouble nsCbrt = pow(ns, 1./3);
+				Ei += scaleFac*( Xprefac * nsCbrt * ns ); // Xprefac * ns^(4/3)
+				if(E_n[s])
+					(simdDouble::load(E_n[s]+i) + scaleFac*( (nCount * Xprefac * 4./3) * nsCbrt )).store(E_n[s]+i);
+			}
+			Ei.store(E+i);
+		}
+		for(; i<iStop; i++) //remainder
+			LDA_calc<LDA_X_Slater,nCount>::compute(i, n, E, E_n, scaleFac);
+	}
+};
+#endif
+
 //! @}
 #endif // JDFTX_ELECTRONIC_EXCORR_INTERNAL_LDA_H
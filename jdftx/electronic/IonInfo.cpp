@@ -24,6 +24,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <electronic/ExCorr.h>
 #include <electronic/ColumnBundle.h>
 #include <electronic/VanDerWaals.h>
+#include <electronic/RealSpaceProjectors.h>
 #include <fluid/FluidSolver.h>
 #include <core/SphericalHarmonics.h>
 #include <core/Units.h>
@@ -34,11 +35,15 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 
 IonInfo::IonInfo()
 {	shouldPrintForceComponents = false;
+	projectorCache = std::make_shared<ProjectorCache>();
 	vdWenable = false;
 	vdWscale = 0.;
 	vdWstyle = VDW_D2;
 	ljOverride = false;
 	computeStress = false;
+	localUpdateInterval = 0;
+	localUpdateMaxMoved = 0.25;
+	nIncrementalUpdates = 0;
 }
 
 void IonInfo::setup(const Everything &everything)
@@ -49,6 +54,7 @@ void IonInfo::setup(const Everything &everything)
 		forcesOutputCoords = coordsType==CoordsLattice ? ForcesCoordsLattice : ForcesCoordsCartesian;
 
 	logPrintf("\n---------- Setting up pseudopotentials ----------\n");
+	projectorCache->setLimits(size_t(e->cntrl.cacheProjectorsMaxMemory * 1048576.), e->cntrl.cacheProjectorsSingle);
 		
 	//Choose width of the nuclear gaussian:
 	switch(ionWidthMethod)
@@ -93,6 +99,10 @@ void IonInfo::setup(const Everything &everything)
 	{	//Check for unsupported features:
 		if(e->coulombParams.Efield.length_squared())
 			die("\nStress calculation not supported with external electric fields.\n\n");
+		if(e->cntrl.realSpaceProjectors)
+			die("\nStress calculation not supported with real-space projectors.\n\n");
+		if(e->cntrl.realSpaceAugmentation)
+			die("\nStress calculation not supported with real-space augmentation.\n\n");
 		//Additional checks in ElecVars for electronic contributions
 	}
 }
@@ -168,20 +178,43 @@ void IonInfo::update(Energies& ener)
 	}
 	
 	//----------- update Vlocps, rhoIon, nCore and nChargeball --------------
-	initZero(Vlocps, gInfo);
-	initZero(rhoIon, gInfo);
-	if(nChargeball) nChargeball->zero();
-	ScalarFieldTilde nCoreTilde, tauCoreTilde;
-	for(auto sp: species) //collect contributions to the above from all species
-		sp->updateLocal(Vlocps, rhoIon, nChargeball, nCoreTilde, tauCoreTilde);
+	bool incremental = checkIncrementalUpdate();
+	if(!incremental)
+	{	initZero(VlocpsShort, gInfo);
+		initZero(rhoIonPoint, gInfo);
+		if(nChargeball) nChargeball->zero();
+		nCoreTilde = 0;
+		tauCoreTilde = 0;
+	}
+	int nAtomsUpdated = 0;
+	for(unsigned iSp=0; iSp<species.size(); iSp++) //collect contributions to the above from all species (only of moved atoms if incremental)
+		nAtomsUpdated += species[iSp]->updateLocal(VlocpsShort, rhoIonPoint, nChargeball, nCoreTilde, tauCoreTilde,
+			incremental ? &atposLocal[iSp] : 0);
 	//Add long-range part to Vlocps and smoothen rhoIon:
-	Vlocps += (*e->coulomb)(rhoIon, Coulomb::PointChargeRight);
+	Vlocps = VlocpsShort + (*e->coulomb)(rhoIonPoint, Coulomb::PointChargeRight);
 	if(computeStress and ionWidth)
-		rhoIonBare = clone(rhoIon); //remember rhoIon before convolution for stress calculation
-	rhoIon = gaussConvolve(rhoIon, ionWidth);
+		rhoIonBare = clone(rhoIonPoint); //remember rhoIon before convolution for stress calculation
+	rhoIon = gaussConvolve(rhoIonPoint, ionWidth);
 	//Process partial core density:
-	if(nCoreTilde) nCore = I(nCoreTilde); // put in real space
-	if(tauCoreTilde) tauCore = I(tauCoreTilde); // put in real space
+	nCore = nCoreTilde ? I(nCoreTilde) : 0; // put in real space
+	tauCore = tauCoreTilde ? I(tauCoreTilde) : 0; // put in real space
+	//Retain state for subsequent incremental updates (if enabled):
+	if(localUpdateInterval)
+	{	atposLocal.clear();
+		for(auto sp: species) atposLocal.push_back(sp->atpos);
+		Rlocal = gInfo.R;
+		if(incremental)
+		{	nIncrementalUpdates++;
+			logPrintf("Updated local pseudopotentials incrementally for %d moved atoms.\n", nAtomsUpdated);
+		}
+		else nIncrementalUpdates = 0;
+	}
+	else
+	{	VlocpsShort = 0;
+		rhoIonPoint = 0;
+		nCoreTilde = 0;
+		tauCoreTilde = 0;
+	}
 	
 	//---------- energies dependent on ionic positions alone ----------------
 	
@@ -195,6 +228,24 @@ void IonInfo::update(Energies& ener)
 	ener.E["Epulay"] = calcEpulay();
 }
 
+bool IonInfo::checkIncrementalUpdate() const
+{	if(!localUpdateInterval || !VlocpsShort) return false; //disabled, or no previous update
+	if(nIncrementalUpdates+1 >= localUpdateInterval) return false; //periodic full update to control accumulated round-off
+	if(!(e->gInfo.R == Rlocal)) return false; //lattice changed
+	//Check fraction of moved atoms:
+	if(atposLocal.size() != species.size()) return false;
+	size_t nAtoms = 0, nMoved = 0;
+	for(unsigned iSp=0; iSp<species.size(); iSp++)
+	{	const std::vector<vector3<>>& atpos = species[iSp]->atpos;
+		const std::vector<vector3<>>& atposOld = atposLocal[iSp];
+		if(atpos.size() != atposOld.size()) return false;
+		for(size_t atom=0; atom<atpos.size(); atom++)
+			if(!(atpos[atom] == atposOld[atom])) nMoved++;
+		nAtoms += atpos.size();
+	}
+	return nMoved <= localUpdateMaxMoved * nAtoms;
+}
+
 double IonInfo::ionicEnergyAndGrad()
 {	const ElecInfo &eInfo = e->eInfo;
 	const ElecVars &eVars = e->eVars;
@@ -334,8 +385,48 @@ double IonInfo::EnlAndGrad(const QuantumNumber& qnum, const diagMatrix& Fq, cons
 
 void IonInfo::augmentOverlap(const ColumnBundle& Cq, ColumnBundle& OCq, std::vector<matrix>* VdagCq) const
 {	if(VdagCq) VdagCq->resize(species.size());
+	if(mergedProjectors())
+	{	bool anyUltrasoft = false;
+		for(auto sp: species) if(sp->atpos.size() && sp->Qint.size()) anyUltrasoft = true;
+		if(!anyUltrasoft) return; //no overlap augmentation
+		static StopWatch watch("augmentOverlap"); watch.start();
+		std::vector<int> offsets;
+		std::shared_ptr<ColumnBundle> V = getVmerged(Cq, offsets);
+		matrix VdagCqAll = (*V) ^ Cq; //projections of all species in one multiply
+		matrix QVdagCqAll = zeroes(VdagCqAll.nRows(), VdagCqAll.nCols());
+		int nSpinor = Cq.spinorLength();
+		for(unsigned sp=0; sp<species.size(); sp++)
+		{	int rowStart = offsets[sp]*nSpinor, rowStop = offsets[sp+1]*nSpinor;
+			if(rowStop == rowStart) continue;
+			matrix VdagCqSp = VdagCqAll(rowStart,rowStop, 0,Cq.nCols());
+			if(species[sp]->Qint.size())
+				QVdagCqAll.set(rowStart,rowStop, 0,Cq.nCols(), tiledBlockMatrix(species[sp]->QintAll, species[sp]->atpos.size()) * VdagCqSp);
+			if(VdagCq) VdagCq->at(sp) = VdagCqSp; //cache for later usage (including norm-conserving species, which saves a projection)
+		}
+		OCq += (*V) * QVdagCqAll;
+		watch.stop();
+		return;
+	}
+	std::vector<const RealSpaceProjectors*> rsp(species.size(), 0); //species handled in real space
+	bool anyRealSpace = false;
 	for(unsigned sp=0; sp<species.size(); sp++)
-		species[sp]->augmentOverlap(Cq, OCq, VdagCq ? &VdagCq->at(sp) : 0);
+	{	if(e->cntrl.realSpaceProjectors && species[sp]->Qint.size())
+			rsp[sp] = species[sp]->getRealSpaceProjectors(*(Cq.basis->gInfo));
+		if(rsp[sp]) anyRealSpace = true;
+		else species[sp]->augmentOverlap(Cq, OCq, VdagCq ? &VdagCq->at(sp) : 0);
+	}
+	if(anyRealSpace)
+	{	static StopWatch watch("augmentOverlap"); watch.start();
+		std::vector<matrix> VdagCqRS, QVdagCq(species.size());
+		RealSpaceProjectors::project(Cq, rsp, VdagCqRS);
+		for(unsigned sp=0; sp<species.size(); sp++)
+			if(rsp[sp])
+			{	QVdagCq[sp] = tiledBlockMatrix(species[sp]->QintAll, species[sp]->atpos.size()) * VdagCqRS[sp];
+				if(VdagCq) VdagCq->at(sp) = VdagCqRS[sp]; //cache for later usage
+			}
+		RealSpaceProjectors::projectGrad(rsp, QVdagCq, OCq);
+		watch.stop();
+	}
 }
 
 void IonInfo::augmentDensityInit() const
@@ -359,18 +450,98 @@ void IonInfo::augmentDensitySphericalGrad(const QuantumNumber& qnum, const std::
 
 void IonInfo::project(const ColumnBundle& Cq, std::vector<matrix>& VdagCq, matrix* rotExisting) const
 {	VdagCq.resize(species.size());
+	if(mergedProjectors())
+	{	std::vector<int> offsets;
+		std::shared_ptr<ColumnBundle> V;
+		matrix VdagCqAll;
+		int nSpinor = Cq.spinorLength();
+		for(unsigned sp=0; sp<species.size(); sp++)
+		{	if(rotExisting && VdagCq[sp]) VdagCq[sp] = VdagCq[sp] * (*rotExisting); //rotate and keep the existing projections
+			else
+			{	if(!V)
+				{	V = getVmerged(Cq, offsets);
+					if(!V) return; //no nonlocal projectors
+					VdagCqAll = (*V) ^ Cq; //projections of all species in one multiply
+				}
+				int rowStart = offsets[sp]*nSpinor, rowStop = offsets[sp+1]*nSpinor;
+				if(rowStop > rowStart) VdagCq[sp] = VdagCqAll(rowStart,rowStop, 0,Cq.nCols());
+			}
+		}
+		return;
+	}
+	std::vector<const RealSpaceProjectors*> rsp(species.size(), 0); //species to be projected in real space
+	bool anyRealSpace = false;
 	for(unsigned sp=0; sp<e->iInfo.species.size(); sp++)
 	{	if(rotExisting && VdagCq[sp]) VdagCq[sp] = VdagCq[sp] * (*rotExisting); //rotate and keep the existing projections
+		else if(e->cntrl.realSpaceProjectors && (rsp[sp] = species[sp]->getRealSpaceProjectors(*(Cq.basis->gInfo))))
+			anyRealSpace = true; //process below (sharing wavefunction transforms between species)
 		else
 		{	auto V = e->iInfo.species[sp]->getV(Cq);
 			if(V) VdagCq[sp] = (*V) ^ Cq;
 		}
 	}
+	if(anyRealSpace)
+	{	std::vector<matrix> VdagCqRS;
+		RealSpaceProjectors::project(Cq, rsp, VdagCqRS);
+		for(unsigned sp=0; sp<species.size(); sp++)
+			if(rsp[sp]) VdagCq[sp] = VdagCqRS[sp];
+	}
 }
 
 void IonInfo::projectGrad(const std::vector<matrix>& HVdagCq, const ColumnBundle& Cq, ColumnBundle& HCq) const
-{	for(unsigned sp=0; sp<species.size(); sp++)
-		if(HVdagCq[sp]) HCq += *(species[sp]->getV(Cq)) * HVdagCq[sp];
+{	if(mergedProjectors())
+	{	std::vector<int> offsets;
+		std::shared_ptr<ColumnBundle> V = getVmerged(Cq, offsets);
+		if(!V) return; //no nonlocal projectors
+		int nSpinor = Cq.spinorLength();
+		matrix HVdagCqAll = zeroes(offsets.back()*nSpinor, Cq.nCols());
+		bool anyNonzero = false;
+		for(unsigned sp=0; sp<species.size(); sp++)
+			if(HVdagCq[sp] && offsets[sp+1] > offsets[sp])
+			{	HVdagCqAll.set(offsets[sp]*nSpinor,offsets[sp+1]*nSpinor, 0,Cq.nCols(), HVdagCq[sp]);
+				anyNonzero = true;
+			}
+		if(anyNonzero) HCq += (*V) * HVdagCqAll; //gradient contributions of all species in one multiply
+		return;
+	}
+	std::vector<const RealSpaceProjectors*> rsp(species.size(), 0); //species to be processed in real space
+	bool anyRealSpace = false;
+	for(unsigned sp=0; sp<species.size(); sp++)
+		if(HVdagCq[sp])
+		{	if(e->cntrl.realSpaceProjectors && (rsp[sp] = species[sp]->getRealSpaceProjectors(*(HCq.basis->gInfo))))
+				anyRealSpace = true;
+			else HCq += *(species[sp]->getV(Cq)) * HVdagCq[sp];
+		}
+	if(anyRealSpace) RealSpaceProjectors::projectGrad(rsp, HVdagCq, HCq);
+}
+
+bool IonInfo::mergedProjectors() const
+{	return e->cntrl.mergeProjectors && !e->cntrl.realSpaceProjectors; //real-space projectors take precedence
+}
+
+std::shared_ptr<ColumnBundle> IonInfo::getVmerged(const ColumnBundle& Cq, std::vector<int>& offsets) const
+{	//Determine layout:
+	offsets.assign(species.size()+1, 0);
+	for(unsigned sp=0; sp<species.size(); sp++)
+		offsets[sp+1] = offsets[sp] + species[sp]->nProjectors() / e->eInfo.spinorLength(); //getV is not a spinor regardless of spin type
+	if(!offsets.back()) return 0; //purely local psps
+	//Check cache (merged entries are stored with a null species):
+	const QuantumNumber& qnum = *(Cq.qnum);
+	const Basis& basis = *(Cq.basis);
+	bool useCache = e->cntrl.cacheProjectors;
+	if(useCache)
+	{	std::shared_ptr<ColumnBundle> V = projectorCache->find(0, qnum.k, &basis);
+		if(V) return V; //return cached value
+	}
+	//Concatenate projectors of each species:
+	std::shared_ptr<ColumnBundle> V = std::make_shared<ColumnBundle>(offsets.back(), basis.nbasis, &basis, &qnum, isGpuEnabled());
+	for(unsigned sp=0; sp<species.size(); sp++)
+		if(offsets[sp+1] > offsets[sp])
+		{	std::shared_ptr<ColumnBundle> Vsp = species[sp]->getV(Cq);
+			callPref(eblas_copy)(V->dataPref()+offsets[sp]*basis.nbasis, Vsp->dataPref(), Vsp->nData());
+		}
+	if(useCache) projectorCache->add(0, qnum.k, &basis, V);
+	return V;
 }
 
 //----- DFT+U functions --------
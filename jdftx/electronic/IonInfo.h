@@ -23,6 +23,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <electronic/SpeciesInfo.h>
 #include <electronic/IonicMinimizer.h>
+#include <electronic/ProjectorCache.h>
 #include <core/matrix.h>
 #include <core/ScalarField.h>
 #include <core/Thread.h>
@@ -55,6 +56,7 @@ class IonInfo
 public:
 	std::vector< std::shared_ptr<SpeciesInfo> > species; //!< list of ionic species
 	std::vector<string> pspFilenamePatterns; //!< list of wildcards for pseudopotential sets
+	std::shared_ptr<ProjectorCache> projectorCache; //!< nonlocal projectors cached by all species
 	
 	CoordsType coordsType; //!< coordinate system for ionic positions etc.
 	ForcesOutputCoords forcesOutputCoords; //!< coordinate system to print forces in
@@ -131,16 +133,32 @@ public:
 	ionWidthMethod; //!< method for determining ion charge width
 	double ionWidth; //!< width for gaussian representation of nuclei
 	bool shouldPrintForceComponents;
+	
+	int localUpdateInterval; //!< if non-zero, update local quantities incrementally for moved atoms, with a full update after these many updates
+	double localUpdateMaxMoved; //!< maximum fraction of moved atoms for which incremental updates are used
+	
+	//! Compute all pair-potential terms in the energy, forces (in lattice coordinates) or lattice derivative (E_RRT) (electrostatic, and optionally vdW)
+	void pairPotentialsAndGrad(class Energies* ener=0, IonicGradient* forces=0, matrix3<>* E_RRT=0) const;
 
 private:
 	const Everything* e;
 	ScalarFieldTilde rhoIonBare; //rhoIon without ionWidth required for stress calculation
 	
-	//! Compute all pair-potential terms in the energy, forces or lattice derivative (E_RRT) (electrostatic, and optionally vdW)
-	void pairPotentialsAndGrad(class Energies* ener=0, IonicGradient* forces=0, matrix3<>* E_RRT=0) const;
+	//Quantities retained for incremental updates of local quantities (only if localUpdateInterval is non-zero):
+	ScalarFieldTilde VlocpsShort, rhoIonPoint, nCoreTilde, tauCoreTilde; //short-ranged part of Vlocps, rhoIon without ionWidth and partial cores in reciprocal space
+	std::vector<std::vector<vector3<>>> atposLocal; //atomic positions of each species that the above correspond to
+	matrix3<> Rlocal; //lattice vectors that the above correspond to
+	int nIncrementalUpdates; //number of incremental updates since the last full update
+	bool checkIncrementalUpdate() const; //whether local quantities can be updated incrementally for the current positions
 	
 	//! Compute pulay contributions to energy and optionally stress
 	double calcEpulay(matrix3<>* E_RRT=0) const;
+	
+	//! Projectors of all species concatenated in species order at the k-point and basis of Cq (used if Control::mergeProjectors).
+	//! Species sp occupies columns offsets[sp] to offsets[sp+1] (none for unused species and purely local psps).
+	//! Returns null if no species has nonlocal projectors.
+	std::shared_ptr<ColumnBundle> getVmerged(const ColumnBundle& Cq, std::vector<int>& offsets) const;
+	bool mergedProjectors() const; //!< whether to use getVmerged
 };
 
 //! @}
@@ -71,6 +71,32 @@ IonicDynamics::IonicDynamics(Everything& e)
 	if(vInitNeeded)
 		initializeVelocities();
 	
+	//Harmonic bonds for multiple time stepping:
+	if(idp.nInnerSteps>1 and idp.fastForceModel==IonicDynamicsParams::HarmonicBonds)
+	{	const auto& species = e.iInfo.species;
+		for(int sp1=0; sp1<int(species.size()); sp1++)
+			for(int at1=0; at1<int(species[sp1]->atpos.size()); at1++)
+				for(int sp2=sp1; sp2<int(species.size()); sp2++)
+					for(int at2=(sp2==sp1 ? at1+1 : 0); at2<int(species[sp2]->atpos.size()); at2++)
+					{	vector3<> dx = species[sp2]->atpos[at2] - species[sp1]->atpos[at1];
+						for(int k=0; k<3; k++) dx[k] -= floor(0.5 + dx[k]); //minimum image
+						double r = sqrt(e.gInfo.RTR.metric_length_squared(dx));
+						if(r < idp.bondCutoff)
+						{	Bond bond = { sp1, at1, sp2, at2, r };
+							bonds.push_back(bond);
+						}
+					}
+		if(not bonds.size())
+			die("No atom pairs within bondCutoff for fastForceModel HarmonicBonds.\n\n");
+	}
+	if(idp.nInnerSteps>1)
+	{	logPrintf("Multiple time stepping with %d inner steps of %lg fs using ", idp.nInnerSteps, idp.dt/(idp.nInnerSteps*fs));
+		if(idp.fastForceModel==IonicDynamicsParams::HarmonicBonds)
+			logPrintf("%d harmonic bonds as fast forces.\n", int(bonds.size()));
+		else
+			logPrintf("pair potentials as fast forces.\n");
+	}
+	
 	//Whether nAccum is needed:
 	for(auto dumpPair: e.dump)
 		if(dumpPair.second == DumpElecDensityAccum)
@@ -254,27 +280,90 @@ bool IonicDynamics::report(int iter, double t)
 	return lmin.report(iter);
 }
 
+LatticeGradient IonicDynamics::computeFastAccel()
+{	//Fast forces in Cartesian coordinates:
+	IonicGradient forces; forces.init(e.iInfo);
+	if(e.ionicDynParams.fastForceModel == IonicDynamicsParams::HarmonicBonds)
+	{	for(const Bond& bond: bonds)
+		{	vector3<> dx = e.iInfo.species[bond.sp2]->atpos[bond.at2] - e.iInfo.species[bond.sp1]->atpos[bond.at1];
+			for(int k=0; k<3; k++) dx[k] -= floor(0.5 + dx[k]); //minimum image
+			vector3<> d = e.gInfo.R * dx;
+			double r = d.length();
+			vector3<> f = (e.ionicDynParams.bondK * (r - bond.r0) / r) * d; //force on first atom
+			forces[bond.sp1][bond.at1] += f;
+			forces[bond.sp2][bond.at2] -= f;
+		}
+	}
+	else
+	{	e.iInfo.pairPotentialsAndGrad(0, &forces); //in lattice coordinates
+		forces = e.gInfo.invRT * forces;
+	}
+	//Convert to acceleration and constrain:
+	LatticeGradient accel; accel.init(e.iInfo);
+	for(size_t sp=0; sp<e.iInfo.species.size(); sp++)
+	{	const SpeciesInfo& spInfo = *(e.iInfo.species[sp]);
+		for(size_t at=0; at<spInfo.atpos.size(); at++)
+			accel.ionic[sp][at] = spInfo.constraints[at].moveScale ? forces[sp][at] * (1./(spInfo.mass*amu)) : vector3<>();
+	}
+	lmin.constrain(accel);
+	return accel;
+}
+
+void IonicDynamics::innerSteps(LatticeGradient& vel, LatticeGradient& accelFast)
+{	const IonicDynamicsParams& idp = e.ionicDynParams;
+	double dtInner = idp.dt / idp.nInnerSteps;
+	//Store initial positions:
+	std::vector<std::vector< vector3<> > > atposInit;
+	for(const auto& sp: e.iInfo.species)
+		atposInit.push_back(sp->atpos);
+	//Inner velocity Verlet loop, moving atoms directly (no wavefunction drag or ion-dependent updates):
+	for(int iInner=0; iInner<idp.nInnerSteps; iInner++)
+	{	axpy(0.5*dtInner, accelFast, vel);
+		for(size_t sp=0; sp<e.iInfo.species.size(); sp++)
+		{	SpeciesInfo& spInfo = *(e.iInfo.species[sp]);
+			for(size_t at=0; at<spInfo.atpos.size(); at++)
+				spInfo.atpos[at] += dtInner * (e.gInfo.invR * vel.ionic[sp][at]);
+		}
+		accelFast = computeFastAccel();
+		axpy(0.5*dtInner, accelFast, vel);
+	}
+	//Restore initial positions and apply net displacement as a single step (with wavefunction drag):
+	LatticeGradient dpos; dpos.init(e.iInfo);
+	for(size_t sp=0; sp<e.iInfo.species.size(); sp++)
+	{	SpeciesInfo& spInfo = *(e.iInfo.species[sp]);
+		for(size_t at=0; at<spInfo.atpos.size(); at++)
+			dpos.ionic[sp][at] = e.gInfo.R * (spInfo.atpos[at] - atposInit[sp][at]);
+		spInfo.atpos = atposInit[sp];
+	}
+	lmin.step(dpos, 1.);
+}
+
 void IonicDynamics::run()
 {	const IonicDynamicsParams& idp = e.ionicDynParams;
 	
 	//Initial energies and forces
 	if(nAccumNeeded) nullToZero(e.eVars.nAccum, e.gInfo);
 	LatticeGradient accel = computePE(), accelV = thermostat(getVelocities()); //in Cartesian coordinates
+	bool multipleTimeStep = (idp.nInnerSteps > 1);
+	LatticeGradient accelFast; if(multipleTimeStep) accelFast = computeFastAccel(); //fast part of accel (r-RESPA)
 	
 	for(int iter=0; iter<=idp.nSteps; iter++)
 	{	double t = iter*idp.dt;
 		report(iter, t);
 		if(iter==idp.nSteps) break;
 		
-		//Velocity Verlet step:
+		//Velocity Verlet step (with only the slow part of accel in the outer half steps for r-RESPA):
 		//--- velocity update: first half step
 		LatticeGradient vel = getVelocities();
-		axpy(0.5*idp.dt, accel+accelV, vel);
+		axpy(0.5*idp.dt, (multipleTimeStep ? accel-accelFast : accel)+accelV, vel);
 		//--- position and position-dependent acceleration update:
-		lmin.step(vel, idp.dt);
+		if(multipleTimeStep)
+			innerSteps(vel, accelFast); //also updates vel and accelFast
+		else
+			lmin.step(vel, idp.dt);
 		accel = computePE();
 		//--- velocity update: second half step estimator
-		axpy(0.5*idp.dt, accel+accelV, vel); //note second-order error here due to first-order error in accelV
+		axpy(0.5*idp.dt, (multipleTimeStep ? accel-accelFast : accel)+accelV, vel); //note second-order error here due to first-order error in accelV
 		//--- velocity update: second half step corrector
 		LatticeGradient accelVnew = thermostat(vel);
 		axpy(0.5*idp.dt, accelVnew-accelV, vel); //corrects second-order error introduced in estimator step
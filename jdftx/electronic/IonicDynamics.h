@@ -44,6 +44,13 @@ private:
 	LatticeMinimizer lmin; //!< Helper class for changing atomic positions / lattice vectors (doesn't minimize anything)
 	bool nAccumNeeded; //!< Whether accumulated electron density is needed
 	
+	//! Harmonic bond between two atoms for the HarmonicBonds fast-force model
+	struct Bond
+	{	int sp1, at1, sp2, at2; //!< species and atom indices of the bonded atoms
+		double r0; //!< rest length (initial distance) [a0]
+	};
+	std::vector<Bond> bonds; //!< list of harmonic bonds (multiple time stepping with HarmonicBonds only)
+	
 	//Current thermodynamic properties:
 	double KE; //!< current kinetic energy
 	double PE; //!< current potential energy
@@ -60,6 +67,10 @@ private:
 	LatticeGradient computePE(); //!< Update potential energy and return acceleration (due to potential forces)
 	LatticeGradient thermostat(const LatticeGradient& vel); //!< Return velocity-dependent acceleration due to thermostat (calls setVelocities, computeKE and computePressure)
 	bool report(int iter, double t); //!< Report properties at current step
+	
+	//Multiple time stepping (r-RESPA):
+	LatticeGradient computeFastAccel(); //!< Return acceleration due to the fast-force model alone at current positions
+	void innerSteps(LatticeGradient& vel, LatticeGradient& accelFast); //!< Propagate positions over dt with nInnerSteps velocity Verlet steps of the fast forces alone
 };
 
 //! @}
@@ -39,11 +39,16 @@ struct IonicDynamicsParams
 	int chainLengthT; //!< Nose-Hoover chain length for thermostat
 	int chainLengthP; //!< Nose-Hoover chain length for barostat
 	double B0; //!< characteristic bulk modulus for Berendsen barostat (default: water bulk modulus)
+	int nInnerSteps; //!< number of inner steps (with fast forces only) per time step dt; r-RESPA multiple time stepping if > 1
+	enum FastForceModel { PairPotential, HarmonicBonds } fastForceModel; //!< cheap reference model for fast forces in multiple time stepping
+	double bondK; //!< force constant of harmonic bonds [Eh/a0^2] (HarmonicBonds only)
+	double bondCutoff; //!< maximum initial distance of atom pairs treated as harmonic bonds [a0] (HarmonicBonds only)
 	
 	IonicDynamicsParams() : dt(1.*fs), nSteps(0), statMethod(StatNone),
 		T0(298*Kelvin), P0(NAN), stress0(NAN,NAN,NAN),
 		tDampT(50.*fs), tDampP(100.*fs),
-		chainLengthT(3), chainLengthP(3), B0(2.2E9*Pascal) {}
+		chainLengthT(3), chainLengthP(3), B0(2.2E9*Pascal),
+		nInnerSteps(1), fastForceModel(PairPotential), bondK(0.), bondCutoff(0.) {}
 };
 
 //! @}
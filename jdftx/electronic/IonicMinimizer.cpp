@@ -18,12 +18,14 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 -------------------------------------------------------------------*/
 
 #include <electronic/IonicMinimizer.h>
+#include <electronic/IonicPreconditioner.h>
 #include <electronic/IonInfo.h>
 #include <electronic/Symmetries.h>
 #include <electronic/Everything.h>
 #include <electronic/ElecMinimizer.h>
 #include <electronic/ColumnBundle.h>
 #include <electronic/Dump.h>
+#include <electronic/ResultCache.h>
 #include <core/Random.h>
 #include <core/BlasExtra.h>
 
@@ -162,7 +164,9 @@ IonicGradient operator*(const matrix3<>& mat, const IonicGradient& x)
 
 
 IonicMinimizer::IonicMinimizer(Everything& e, bool dynamicsMode)
-: e(e), populationAnalysisPending(false), skipWfnsDrag(false), dynamicsMode(dynamicsMode)
+: e(e), latticeResidual(0.), populationAnalysisPending(false), skipWfnsDrag(false), dynamicsMode(dynamicsMode),
+	elecThresholdSpecified(e.elecMinParams.energyDiffThreshold), scfThresholdSpecified(e.scfParams.energyDiffThreshold),
+	residualMin(DBL_MAX), adaptActive(e.cntrl.adaptiveElecThreshold && !dynamicsMode)
 {	//Check if any atoms constrained:
 	anyConstrained = false;
 	for(const auto sp: e.iInfo.species)
@@ -172,6 +176,9 @@ IonicMinimizer::IonicMinimizer(Everything& e, bool dynamicsMode)
 			{	anyConstrained = true;
 				break;
 			}
+	//Optional preconditioner:
+	if(e.ionicPrecondParams.type==IonicPreconditionerParams::Exp && !dynamicsMode)
+		precond = std::make_shared<IonicPreconditioner>(e);
 }
 
 void IonicMinimizer::step(const IonicGradient& dir, double alpha)
@@ -287,18 +294,24 @@ double IonicMinimizer::compute(IonicGradient* grad, IonicGradient* Kgrad)
 	//Initialize ion-dependent quantities at this position:
 	e.iInfo.update(e.ener);
 
+	//Check for cached results at this position (and initialize from nearby cached state if available):
+	bool cached = e.resultCache and (not e.iInfo.ljOverride) and e.resultCache->lookup(e, grad);
+	
 	//Minimize the electronic system:
-	if(not e.iInfo.ljOverride)
-		elecFluidMinimize(e);
+	bool elecConverged = false;
+	if(not (e.iInfo.ljOverride or cached))
+		elecConverged = elecFluidMinimize(e);
 	
 	//Calculate forces if needed:
 	if(grad)
-	{	e.iInfo.ionicEnergyAndGrad(); //compute forces in lattice coordinates
+	{	if(not cached) e.iInfo.ionicEnergyAndGrad(); //compute forces in lattice coordinates
 		*grad = -e.gInfo.invRT * e.iInfo.forces; //gradient in cartesian coordinates (and negative of force)
+		if(precond) precond->addSecant(*grad);
 		
 		//Preconditioned gradient:
 		if(Kgrad)
 		{	*Kgrad = *grad;
+			if(precond) precond->apply(*Kgrad);
 			//Apply scale factors:
 			for(unsigned sp=0; sp<Kgrad->size(); sp++)
 			{	const SpeciesInfo& spInfo = *(e.iInfo.species[sp]);
@@ -311,6 +324,9 @@ double IonicMinimizer::compute(IonicGradient* grad, IonicGradient* Kgrad)
 		}
 	}
 	
+	if(e.resultCache and elecConverged) //only cache results converged to the recorded threshold
+		e.resultCache->store(e, grad);
+	
 	skipWfnsDrag = false; //computed at physical atomic positions; safe to drag wfns at next step
 	return relevantFreeEnergy(e);
 }
@@ -326,6 +342,8 @@ bool IonicMinimizer::report(int iter)
 	logPrintf("# Energy components:\n"); e.ener.print(); logPrintf("\n");
 	e.dump(DumpFreq_Ionic, iter);
 	populationAnalysisPending = true; //population analysis will be performed the next time step() is called
+	adaptElecThreshold();
+	if(precond) precond->saveState();
 	return false;
 }
 
@@ -404,6 +422,44 @@ double IonicMinimizer::sync(double x) const
 
 double IonicMinimizer::minimize(const MinimizeParams& params)
 {	double result = Minimizable<IonicGradient>::minimize(params);
+	restoreElecThreshold();
 	step(e.iInfo.forces, 0.); //so that population analysis may be performed at final positions
 	return result;
 }
+
+double IonicMinimizer::computeTolerance() const
+{	if(!adaptActive) return 0.;
+	return e.cntrl.scf ? e.scfParams.energyDiffThreshold : e.elecMinParams.energyDiffThreshold;
+}
+
+bool IonicMinimizer::tightenComputeTolerance()
+{	if(!adaptActive) return false;
+	bool loosened = (e.elecMinParams.energyDiffThreshold > elecThresholdSpecified)
+		|| (e.scfParams.energyDiffThreshold > scfThresholdSpecified);
+	restoreElecThreshold();
+	adaptActive = false; //keep specified thresholds for rest of optimization
+	if(loosened) logPrintf("Reverting to specified electronic convergence thresholds.\n");
+	return loosened;
+}
+
+void IonicMinimizer::adaptElecThreshold()
+{	if(!adaptActive) return;
+	//Determine residual (max force on unconstrained atoms, or lattice residual):
+	IonicGradient f = e.gInfo.invRT * e.iInfo.forces; //Cartesian forces
+	constrain(f);
+	double residual = latticeResidual;
+	for(const auto& fSp: f)
+		for(const vector3<>& fAtom: fSp)
+			residual = std::max(residual, fAtom.length());
+	residualMin = std::min(residualMin, sync(residual));
+	//Force errors ~ sqrt(2 k dE) for electronic energy error dE, with stiffness k ~ 1 Eh/a0^2:
+	double threshold = std::min(0.5*std::pow(e.cntrl.adaptiveElecAccuracy*residualMin, 2), e.cntrl.adaptiveElecThresholdMax);
+	e.elecMinParams.energyDiffThreshold = std::max(threshold, elecThresholdSpecified);
+	e.scfParams.energyDiffThreshold = std::max(threshold, scfThresholdSpecified);
+	logPrintf("Adaptive electronic threshold: %le (residual: %le Eh/a0)\n", computeTolerance(), residualMin);
+}
+
+void IonicMinimizer::restoreElecThreshold()
+{	e.elecMinParams.energyDiffThreshold = elecThresholdSpecified;
+	e.scfParams.energyDiffThreshold = scfThresholdSpecified;
+}
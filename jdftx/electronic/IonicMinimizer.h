@@ -69,11 +69,22 @@ public:
 	double sync(double x) const; //!< All processes minimize together; make sure scalars are in sync to round-off error
 	
 	double minimize(const MinimizeParams& params); //!< minor addition to Minimizable::minimize to invoke charge analysis at final positions
+	
+	//Adaptive electronic convergence (see Control::adaptiveElecThreshold):
+	double computeTolerance() const; //!< current electronic energy-difference threshold when adapted, and zero otherwise
+	bool tightenComputeTolerance(); //!< revert to the specified electronic thresholds for the rest of the optimization (if currently loosened)
+	void adaptElecThreshold(); //!< update electronic thresholds based on the current force (and latticeResidual)
+	void restoreElecThreshold(); //!< restore the specified electronic thresholds (at the end of optimization)
+	double latticeResidual; //!< residual of lattice degrees of freedom in Eh/a0 (set by LatticeMinimizer) for adaptElecThreshold
 private:
 	bool populationAnalysisPending; //!< report() has requested a charge analysis output that is yet to be done
 	bool skipWfnsDrag; //!< whether to temprarily skip wavefunction dragging due to large steps
 	bool anyConstrained; //!< whether any atoms are constrained
 	bool dynamicsMode; //!< class used as a helper for IonicDynamics (changes Kgrad to be acceleration in compute)
+	double elecThresholdSpecified, scfThresholdSpecified; //!< specified electronic thresholds (restored at the end)
+	double residualMin; //!< smallest force / lattice residual so far (thresholds only tighten during an optimization)
+	bool adaptActive; //!< whether thresholds are currently being adapted (cleared by tightenComputeTolerance)
+	std::shared_ptr<class IonicPreconditioner> precond; //!< optional Hessian-guess preconditioner (see IonicPreconditionerParams)
 };
 
 //! @}
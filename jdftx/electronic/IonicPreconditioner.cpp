@@ -0,0 +1,168 @@
+/*-------------------------------------------------------------------
+Copyright 2026 JDFTx contributors
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+
+#include <electronic/IonicPreconditioner.h>
+#include <electronic/Everything.h>
+#include <core/Units.h>
+
+IonicPreconditioner::IonicPreconditioner(const Everything& e)
+: e(e), params(e.ionicPrecondParams), nAtoms(0), mu(params.mu), sy(0.), sLs(0.)
+{	for(const auto& sp: e.iInfo.species)
+		nAtoms += sp->atpos.size();
+	//Nearest-neighbour distance:
+	rNN = DBL_MAX;
+	double rSearch = 10.; //pairs searched within this distance (increased till neighbours found)
+	while(rNN == DBL_MAX && rSearch < 1e3)
+	{	pairLoop(rSearch, [&](int i, int j, double r) { rNN = std::min(rNN, r); });
+		rSearch *= 2.;
+	}
+	if(rNN == DBL_MAX) rNN = 1.; //no pairs (eg. single atom in vacuum): preconditioner is diagonal in any case
+	//Read stiffness from previous run (if available):
+	if(params.stateFilename.length() && fileSize(params.stateFilename.c_str()) > 0)
+	{	double muPrev = 0.;
+		if(mpiWorld->isHead())
+		{	FILE* fp = fopen(params.stateFilename.c_str(), "r");
+			if(fp)
+			{	if(fscanf(fp, "%lg", &muPrev) != 1) muPrev = 0.;
+				fclose(fp);
+			}
+		}
+		mpiWorld->bcast(muPrev);
+		if(muPrev > 0.)
+		{	mu = muPrev;
+			logPrintf("Read ionic preconditioner stiffness from '%s'.\n", params.stateFilename.c_str());
+		}
+	}
+	logPrintf("Ionic preconditioner: Exp with rNN = %lg bohrs and mu = %lg Eh/a0^2 (%lg eV/A^2).\n",
+		rNN, mu, mu/(eV/(Angstrom*Angstrom)));
+	build();
+}
+
+void IonicPreconditioner::apply(IonicGradient& grad)
+{	//Rebuild if atoms have moved sufficiently:
+	IonicGradient pos = getPositions();
+	double dMax = 0.;
+	for(unsigned sp=0; sp<pos.size(); sp++)
+		for(unsigned at=0; at<pos[sp].size(); at++)
+			dMax = std::max(dMax, (pos[sp][at] - posBuilt[sp][at]).length());
+	if(dMax > 0.1*rNN) build();
+	//Apply inverse:
+	unflatten(Pinv * flatten(grad), grad);
+}
+
+void IonicPreconditioner::addSecant(const IonicGradient& grad)
+{	IonicGradient pos = getPositions();
+	if(posPrev.size())
+	{	IonicGradient s = pos - posPrev;
+		IonicGradient y = grad - gradPrev;
+		matrix sMat = flatten(s);
+		double sLsCur = trace(dagger(sMat) * L * sMat).real() + params.cStab * dot(s, s); //s.(L + cStab).s, consistent with P
+		if(sLsCur > 0.)
+		{	sy += dot(s, y);
+			sLs += sLsCur;
+		}
+	}
+	posPrev = pos;
+	gradPrev = grad;
+}
+
+void IonicPreconditioner::saveState() const
+{	if(!params.stateFilename.length()) return;
+	if(!(sy > 0. && sLs > 0.)) return; //no usable estimate
+	double muFit = sy / sLs;
+	muFit = std::min(std::max(muFit, 0.1*mu), 10.*mu); //guard against outliers from poor secant data
+	if(mpiWorld->isHead())
+	{	FILE* fp = fopen(params.stateFilename.c_str(), "w");
+		if(!fp) { logPrintf("WARNING: could not open '%s' for writing.\n", params.stateFilename.c_str()); return; }
+		fprintf(fp, "%.15lg #ionic preconditioner stiffness mu [Eh/a0^2]\n", muFit);
+		fclose(fp);
+	}
+}
+
+IonicGradient IonicPreconditioner::getPositions() const
+{	IonicGradient pos;
+	for(const auto& sp: e.iInfo.species)
+		pos.push_back(sp->atpos);
+	return e.gInfo.R * pos;
+}
+
+void IonicPreconditioner::build()
+{	posBuilt = getPositions();
+	L = zeroes(nAtoms, nAtoms);
+	complex* Ldata = L.data();
+	pairLoop(params.rCutFactor*rNN, [&](int i, int j, double r)
+	{	if(i == j) return; //periodic images of the same atom do not contribute to the Laplacian
+		double w = exp(-params.A*(r/rNN - 1.));
+		Ldata[L.index(i,j)] -= w;
+		Ldata[L.index(i,i)] += w;
+	});
+	matrix P = mu * (L + params.cStab * eye(nAtoms));
+	Pinv = inv(P);
+}
+
+matrix IonicPreconditioner::flatten(const IonicGradient& x) const
+{	matrix X(nAtoms, 3);
+	complex* Xdata = X.data();
+	int i = 0;
+	for(const auto& xSp: x)
+		for(const vector3<>& xAt: xSp)
+		{	for(int k=0; k<3; k++) Xdata[X.index(i,k)] = xAt[k];
+			i++;
+		}
+	return X;
+}
+
+void IonicPreconditioner::unflatten(const matrix& X, IonicGradient& x) const
+{	const complex* Xdata = X.data();
+	int i = 0;
+	for(auto& xSp: x)
+		for(vector3<>& xAt: xSp)
+		{	for(int k=0; k<3; k++) xAt[k] = Xdata[X.index(i,k)].real();
+			i++;
+		}
+}
+
+template<typename Func> void IonicPreconditioner::pairLoop(double rMax, const Func& func) const
+{	//Flatten lattice coordinates:
+	std::vector< vector3<> > x;
+	for(const auto& sp: e.iInfo.species)
+		x.insert(x.end(), sp->atpos.begin(), sp->atpos.end());
+	//Range of periodic images:
+	vector3<bool> isTruncated = e.coulombParams.isTruncated();
+	vector3<int> nImages;
+	for(int k=0; k<3; k++)
+		nImages[k] = isTruncated[k] ? 0 : int(ceil(rMax * e.gInfo.invR.row(k).length()));
+	//Loop over pairs:
+	double rMaxSq = rMax*rMax;
+	for(int i=0; i<nAtoms; i++)
+		for(int j=0; j<nAtoms; j++)
+		{	vector3<> dx = x[j] - x[i];
+			for(int k=0; k<3; k++)
+				if(!isTruncated[k]) dx[k] -= floor(0.5 + dx[k]);
+			vector3<int> iCell;
+			for(iCell[0]=-nImages[0]; iCell[0]<=nImages[0]; iCell[0]++)
+			for(iCell[1]=-nImages[1]; iCell[1]<=nImages[1]; iCell[1]++)
+			for(iCell[2]=-nImages[2]; iCell[2]<=nImages[2]; iCell[2]++)
+			{	if(i==j && !iCell.length_squared()) continue; //self
+				double rSq = (e.gInfo.R * (dx + iCell)).length_squared();
+				if(rSq < rMaxSq) func(i, j, sqrt(rSq));
+			}
+		}
+}
@@ -0,0 +1,68 @@
+/*-------------------------------------------------------------------
+Copyright 2026 JDFTx contributors
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+
+#ifndef JDFTX_ELECTRONIC_IONICPRECONDITIONER_H
+#define JDFTX_ELECTRONIC_IONICPRECONDITIONER_H
+
+#include <electronic/IonicMinimizer.h>
+#include <electronic/IonicPreconditionerParams.h>
+#include <core/matrix.h>
+
+//! @addtogroup IonicSystem
+//! @{
+//! @file IonicPreconditioner.h Class IonicPreconditioner
+
+/**
+Exponential connectivity preconditioner for ionic minimization \cite PreconExp.
+The Hessian guess P = mu (L + cStab), where L is the graph Laplacian of pair weights exp(-A (r/rNN - 1))
+for pairs (including periodic images) within rCutFactor*rNN, acts identically on each Cartesian direction.
+It is rebuilt whenever atoms move by more than 10% of rNN since the last build.
+The stiffness mu is fitted (for the next run) by secant estimates s.y / s.(L + cStab).s from successive gradient evaluations,
+and saved to IonicPreconditionerParams::stateFilename when specified.
+*/
+class IonicPreconditioner
+{
+public:
+	IonicPreconditioner(const Everything& e);
+	void apply(IonicGradient& grad); //!< replace Cartesian gradient by inv(P) * grad (at the current positions)
+	void addSecant(const IonicGradient& grad); //!< accumulate secant estimate of mu from Cartesian gradient at the current positions
+	void saveState() const; //!< write the fitted mu to stateFilename (if any)
+	
+private:
+	const Everything& e;
+	const IonicPreconditionerParams& params;
+	int nAtoms; //!< total number of atoms
+	double mu; //!< stiffness scale in use for this run
+	double rNN; //!< nearest-neighbour distance at the initial positions
+	IonicGradient posBuilt; //!< Cartesian positions at which L and Pinv were last built
+	matrix L; //!< connectivity Laplacian at posBuilt
+	matrix Pinv; //!< inverse preconditioner at posBuilt
+	IonicGradient posPrev, gradPrev; //!< previous Cartesian positions and gradient for secant estimate
+	double sy, sLs; //!< accumulated secant sums dot(s,y) and dot(s,(L+cStab).s)
+	
+	IonicGradient getPositions() const; //!< current Cartesian positions
+	void build(); //!< build L and Pinv at current positions
+	matrix flatten(const IonicGradient& x) const; //!< nAtoms x 3 matrix
+	void unflatten(const matrix& X, IonicGradient& x) const; //!< inverse of flatten
+	template<typename Func> void pairLoop(double rMax, const Func& func) const; //!< call func(i, j, r) for all pairs (i!=j or periodic image) within rMax
+};
+
+//! @}
+#endif // JDFTX_ELECTRONIC_IONICPRECONDITIONER_H
@@ -0,0 +1,49 @@
+/*-------------------------------------------------------------------
+Copyright 2026 JDFTx contributors
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+
+#ifndef JDFTX_ELECTRONIC_IONICPRECONDITIONERPARAMS_H
+#define JDFTX_ELECTRONIC_IONICPRECONDITIONERPARAMS_H
+
+#include <core/string.h>
+
+//! @addtogroup IonicSystem
+//! @{
+//! @file IonicPreconditionerParams.h Struct IonicPreconditionerParams
+
+//! Parameters controlling the preconditioner for ionic minimization
+struct IonicPreconditionerParams
+{	//! Preconditioner type
+	enum Type
+	{	Diagonal, //!< scale gradient by per-atom moveScale alone (default)
+		Exp //!< exponentially-decaying connectivity Hessian guess built from the current positions \cite PreconExp
+	}
+	type;
+	
+	double A; //!< dimensionless decay rate of connectivity with distance relative to nearest-neighbour distance
+	double rCutFactor; //!< connectivity cutoff in units of the nearest-neighbour distance
+	double mu; //!< stiffness scale [Eh/a0^2] (overridden by value in stateFilename, if available)
+	double cStab; //!< dimensionless diagonal stabilization (relative to mu)
+	string stateFilename; //!< file to save the fitted stiffness to, and to read it from on restart (if non-empty)
+	
+	IonicPreconditionerParams() : type(Diagonal), A(3.), rCutFactor(2.), mu(0.02), cStab(0.1) {}
+};
+
+//! @}
+#endif // JDFTX_ELECTRONIC_IONICPRECONDITIONERPARAMS_H
@@ -214,6 +214,7 @@ double LatticeMinimizer::compute(LatticeGradient* grad, LatticeGradient* Kgrad)
 
 double LatticeMinimizer::minimize(const MinimizeParams& params)
 {	double result = Minimizable<LatticeGradient>::minimize(params);
+	imin.restoreElecThreshold();
 	LatticeGradient dir; dir.ionic = e.iInfo.forces; //just needs to be right size; values irrelevant since used with step size 0
 	step(dir, 0.); //so that population analysis may be performed at final positions / lattice
 	return result;
@@ -224,6 +225,8 @@ bool LatticeMinimizer::report(int iter)
 	{	logPrintf("# Lattice vectors:\n"); e.gInfo.printLattice();
 		logPrintf("\n# Strain tensor in Cartesian coordinates:\n"); strain.print(globalLog, "%12lg ", true, 1e-14);
 	}
+	if(not dynamicsMode) //lattice residual for adaptive electronic thresholds (free components of the strain gradient per cell length)
+		imin.latticeResidual = nrm2(Pfree * (e.iInfo.stress * e.gInfo.detR) * Pfree) / cbrt(e.gInfo.detR);
 	return imin.report(iter); //IonicMinimizer::report will print stress, atomic positions, forces etc.
 }
 
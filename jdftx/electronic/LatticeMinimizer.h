@@ -60,6 +60,8 @@ public:
 	void constrain(LatticeGradient&);
 	double safeStepSize(const LatticeGradient& dir) const;
 	double sync(double x) const; //!< All processes minimize together; make sure scalars are in sync to round-off error
+	double computeTolerance() const { return imin.computeTolerance(); } //!< see IonicMinimizer::computeTolerance
+	bool tightenComputeTolerance() { return imin.tightenComputeTolerance(); } //!< see IonicMinimizer::tightenComputeTolerance
 
 	double minimize(const MinimizeParams& params); //!< minor addition to Minimizable::minimize to invoke charge analysis at final positions
 	int nFree() { return (dynamicsMode and statP) ? 1 : int(round(trace(Pfree))); } //!< number of free lattice directions
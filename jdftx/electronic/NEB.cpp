@@ -0,0 +1,320 @@
+/*-------------------------------------------------------------------
+Copyright 2026 JDFTx contributors
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#include <electronic/NEB.h>
+#include <electronic/Everything.h>
+#include <electronic/ColumnBundle.h>
+#include <electronic/ProcessGroupScope.h>
+#include <commands/parser.h>
+#include <commands/command.h>
+
+//Cartesian atomic positions of a system
+inline IonicGradient getPositions(const Everything& e)
+{	IonicGradient x;
+	for(const auto& sp: e.iInfo.species)
+		x.push_back(sp->atpos);
+	return e.gInfo.R * x;
+}
+
+NEB::NEB(Everything& e, const std::vector< std::pair<string,string> >& input)
+: e(e), params(e.nebParams), nImages(params.nImages), nSpecies(e.iInfo.species.size()), iClimb(0), anyConstrained(false)
+{
+	logPrintf("\n---------- Setting up nudged elastic band ----------\n");
+	//Check constraints:
+	for(const auto& sp: e.iInfo.species)
+		for(const auto& constraint: sp->constraints)
+		{	if(constraint.type==SpeciesInfo::Constraint::HyperPlane)
+				die("HyperPlane constraints are not supported in nudged elastic band calculations.\n");
+			if(constraint.getDimension()<3)
+				anyConstrained = true;
+		}
+
+	//Read final state (ion commands replacing those in input):
+	IonicGradient xInitial, xFinal; //lattice coordinates of end points
+	for(const auto& sp: e.iInfo.species)
+		xInitial.push_back(sp->atpos);
+	{	std::vector< std::pair<string,string> > inputFinal;
+		for(const auto& entry: input)
+			if(entry.first != "ion")
+				inputFinal.push_back(entry);
+		for(const auto& entry: readInputFile(params.finalPositionsFilename))
+			if(entry.first == "ion")
+				inputFinal.push_back(entry);
+		Everything eFinal;
+		logSuspend(); parse(inputFinal, eFinal); logResume();
+		for(int sp=0; sp<nSpecies; sp++)
+		{	if(eFinal.iInfo.species[sp]->atpos.size() != xInitial[sp].size())
+				die("Number of atoms of species %s differs between initial and final states ('%s').\n",
+					e.iInfo.species[sp]->name.c_str(), params.finalPositionsFilename.c_str());
+			xFinal.push_back(eFinal.iInfo.species[sp]->atpos);
+		}
+		logPrintf("Read final state positions from '%s'.\n", params.finalPositionsFilename.c_str());
+	}
+
+	//Linearly interpolate images (using nearest periodic image of each atom):
+	vector3<bool> isTruncated = e.coulombParams.isTruncated();
+	std::vector<IonicGradient> x(nImages+2, xInitial);
+	pos.resize(nImages+2);
+	gradImage.resize(nImages+2);
+	E.assign(nImages+2, 0.);
+	for(int sp=0; sp<nSpecies; sp++)
+		for(size_t at=0; at<xInitial[sp].size(); at++)
+		{	vector3<> dx = xFinal[sp][at] - xInitial[sp][at];
+			for(int j=0; j<3; j++)
+				if(!isTruncated[j]) dx[j] -= round(dx[j]);
+			for(int i=1; i<=nImages+1; i++)
+				x[i][sp][at] += (i*1./(nImages+1)) * dx;
+		}
+	for(int i=0; i<=nImages+1; i++)
+	{	pos[i] = e.gInfo.R * x[i];
+		gradImage[i].init(e.iInfo);
+	}
+
+	//Initial state (on all processes):
+	logPrintf("\n---------- NEB initial state ----------\n"); logFlush();
+	E[0] = IonicMinimizer(e).compute(0, 0);
+
+	//Set up intermediate images and compute final state within process groups:
+	int nGroups = mpiGroup->procDivision.nGroups;
+	logPrintf("\nDistributing %d images and the final state over %d process groups (output shown for group 0).\n", nImages, nGroups);
+	if(nGroups > nImages+1)
+		logPrintf("WARNING: only %d of the %d process groups will be used (set -G accordingly).\n", nImages+1, nGroups);
+	images.resize(nImages+2);
+	imins.resize(nImages+2);
+	double Efinal = 0.;
+	{	ProcessGroupScope groupScope;
+		for(int i=1; i<=nImages+1; i++) if(isMine(i))
+		{	logPrintf("\n---------- Setting up NEB image %d ----------\n", i); logFlush();
+			images[i] = createImage(i, input, x[i]);
+			imins[i] = std::make_shared<IonicMinimizer>(*images[i]);
+		}
+		if(isMine(nImages+1))
+		{	logPrintf("\n---------- NEB final state ----------\n"); logFlush();
+			double E = imins[nImages+1]->compute(0, 0);
+			images[nImages+1]->dump(DumpFreq_End, 0);
+			if(mpiGroup->isHead()) Efinal = E;
+			imins[nImages+1] = 0; //final state no longer needed
+			images[nImages+1] = 0;
+		}
+	}
+	mpiWorld->allReduce(Efinal, MPIUtil::ReduceSum);
+	E[nImages+1] = Efinal;
+}
+
+std::shared_ptr<Everything> NEB::createImage(int i, const std::vector< std::pair<string,string> >& input, const IonicGradient& x) const
+{	std::shared_ptr<Everything> img = std::make_shared<Everything>();
+	logSuspend(); parse(input, *img); logResume();
+	for(int sp=0; sp<nSpecies; sp++)
+		img->iInfo.species[sp]->atpos = x[sp];
+	img->symm.mode = SymmetriesNone; //the path generally breaks symmetries of the end points
+	img->nebParams.nImages = 0;
+	//Image-specific output, and restart from it if available:
+	ostringstream oss; oss << "neb." << i << ".$@#!"; //placeholder for $VAR
+	string fnamePattern = e.dump.getFilename(oss.str()); //(because dump variable name cannot contain $VAR)
+	fnamePattern.replace(fnamePattern.find("$@#!"), 4, "$VAR"); //replace placeholder with $VAR
+	img->eVars.wfnsFilename.clear();
+	img->eVars.eigsFilename.clear();
+	img->eVars.fluidInitialStateFilename.clear();
+	img->eInfo.initialFillingsFilename.clear();
+	img->scfParams.historyFilename.clear();
+	setAvailableFilenames(fnamePattern, *img);
+	img->dump.format = fnamePattern;
+	img->setup();
+	return img;
+}
+
+void NEB::collectImages()
+{	std::vector<double> Eimages(nImages+2, 0.);
+	for(int i=1; i<=nImages; i++)
+	{	bool contrib = images[i] && mpiGroup->isHead(); //one process from owning group
+		if(contrib) Eimages[i] = E[i];
+		else
+		{	pos[i] *= 0.;
+			gradImage[i] *= 0.;
+		}
+		for(int sp=0; sp<nSpecies; sp++)
+		{	mpiWorld->allReduceData(pos[i][sp], MPIUtil::ReduceSum);
+			mpiWorld->allReduceData(gradImage[i][sp], MPIUtil::ReduceSum);
+		}
+	}
+	mpiWorld->allReduceData(Eimages, MPIUtil::ReduceSum);
+	for(int i=1; i<=nImages; i++)
+		E[i] = Eimages[i];
+}
+
+IonicGradient NEB::displacement(int i1, int i2) const
+{	IonicGradient dx = e.gInfo.invR * (pos[i2] - pos[i1]); //in lattice coordinates
+	vector3<bool> isTruncated = e.coulombParams.isTruncated();
+	for(auto& dxSp: dx)
+		for(vector3<>& dxAt: dxSp)
+			for(int j=0; j<3; j++)
+				if(!isTruncated[j]) dxAt[j] -= round(dxAt[j]);
+	return e.gInfo.R * dx;
+}
+
+IonicGradient NEB::tangent(int i) const
+{	IonicGradient tauPlus = displacement(i, i+1), tauMinus = displacement(i-1, i);
+	IonicGradient tau;
+	if(E[i+1] > E[i] && E[i] > E[i-1]) tau = tauPlus; //monotonically increasing: upwind tangent
+	else if(E[i+1] < E[i] && E[i] < E[i-1]) tau = tauMinus; //monotonically decreasing: upwind tangent
+	else //extremum: energy-weighted tangent
+	{	double dEmax = std::max(fabs(E[i+1]-E[i]), fabs(E[i-1]-E[i]));
+		double dEmin = std::min(fabs(E[i+1]-E[i]), fabs(E[i-1]-E[i]));
+		if(E[i+1] > E[i-1]) tau = tauPlus*dEmax + tauMinus*dEmin;
+		else tau = tauPlus*dEmin + tauMinus*dEmax;
+	}
+	return tau * (1./sqrt(dot(tau, tau)));
+}
+
+IonicGradient NEB::getBlock(const IonicGradient& x, int i) const
+{	IonicGradient xi;
+	xi.assign(x.begin()+(i-1)*nSpecies, x.begin()+i*nSpecies);
+	return xi;
+}
+
+void NEB::step(const IonicGradient& dir, double alpha)
+{	ProcessGroupScope groupScope;
+	for(int i=1; i<=nImages; i++) if(images[i])
+		imins[i]->step(getBlock(dir, i), alpha);
+}
+
+double NEB::compute(IonicGradient* grad, IonicGradient* Kgrad)
+{	//Compute energies and gradients of images in current group:
+	{	ProcessGroupScope groupScope;
+		for(int i=1; i<=nImages; i++) if(images[i])
+		{	logPrintf("\n---------- NEB image %d of %d ----------\n", i, nImages); logFlush();
+			E[i] = imins[i]->compute(&gradImage[i], 0);
+			pos[i] = getPositions(*images[i]);
+		}
+	}
+	collectImages();
+	double Esum = 0.;
+	for(int i=1; i<=nImages; i++)
+		Esum += E[i];
+	if(!std::isfinite(Esum)) return NAN;
+
+	//Select climbing image:
+	iClimb = 0;
+	if(params.climbing)
+	{	iClimb = 1;
+		for(int i=2; i<=nImages; i++)
+			if(E[i] > E[iClimb]) iClimb = i;
+	}
+
+	//NEB forces:
+	if(grad)
+	{	grad->clear();
+		for(int i=1; i<=nImages; i++)
+		{	IonicGradient tau = tangent(i);
+			IonicGradient gNEB = gradImage[i];
+			double gTau = dot(gNEB, tau);
+			if(i == iClimb)
+				axpy(-2.*gTau, tau, gNEB); //invert component of energy gradient along path
+			else
+			{	axpy(-gTau, tau, gNEB); //only perpendicular component of energy gradient
+				double dPlus = sqrt(dot(displacement(i, i+1), displacement(i, i+1)));
+				double dMinus = sqrt(dot(displacement(i-1, i), displacement(i-1, i)));
+				axpy(-params.springConstant*(dPlus-dMinus), tau, gNEB); //only parallel component of spring force
+			}
+			grad->insert(grad->end(), gNEB.begin(), gNEB.end());
+		}
+
+		//Preconditioned gradient:
+		if(Kgrad)
+		{	*Kgrad = *grad;
+			for(int i=1; i<=nImages; i++)
+				for(int sp=0; sp<nSpecies; sp++)
+				{	const SpeciesInfo& spInfo = *(e.iInfo.species[sp]);
+					for(size_t atom=0; atom<spInfo.atpos.size(); atom++)
+						Kgrad->at((i-1)*nSpecies+sp)[atom] *= spInfo.constraints[atom].moveScale;
+				}
+			constrain(*Kgrad);
+		}
+	}
+	return Esum;
+}
+
+bool NEB::report(int iter)
+{	logPrintf("\n# NEB images: index, path length [a0], energy relative to initial state [Eh]\n");
+	double s = 0.;
+	int iMax = 0;
+	for(int i=0; i<=nImages+1; i++)
+	{	if(i) s += sqrt(dot(displacement(i-1, i), displacement(i-1, i)));
+		if(E[i] > E[iMax]) iMax = i;
+		logPrintf("NEBimage %3d  %10.6lf  %+.10lf%s\n", i, s, E[i]-E[0], (i && i==iClimb) ? "  (climbing)" : "");
+	}
+	logPrintf("# NEB barrier estimates: forward %+.10lf  reverse %+.10lf [Eh]\n", E[iMax]-E[0], E[iMax]-E[nImages+1]);
+	logFlush();
+	ProcessGroupScope groupScope;
+	for(int i=1; i<=nImages; i++) if(images[i])
+		images[i]->dump(DumpFreq_Ionic, iter);
+	return false;
+}
+
+void NEB::constrain(IonicGradient& x)
+{	for(int i=1; i<=nImages; i++)
+	{	vector3<> xSum; int nAtoms = 0;
+		for(int sp=0; sp<nSpecies; sp++)
+		{	const SpeciesInfo& spInfo = *(e.iInfo.species[sp]);
+			for(size_t atom=0; atom<spInfo.atpos.size(); atom++)
+			{	vector3<>& xAt = x[(i-1)*nSpecies+sp][atom];
+				xAt = spInfo.constraints[atom](xAt);
+				xSum += xAt;
+				nAtoms++;
+			}
+		}
+		//Ensure zero total force on each image (if no atom is constrained):
+		if(!anyConstrained && nAtoms)
+		{	vector3<> xMean = (1./nAtoms) * xSum;
+			for(int sp=0; sp<nSpecies; sp++)
+				for(vector3<>& xAt: x[(i-1)*nSpecies+sp])
+					xAt -= xMean;
+		}
+	}
+}
+
+double NEB::safeStepSize(const IonicGradient& dir) const
+{	double dMax = 0.;
+	for(const auto& spArr: dir)
+		for(const vector3<>& d: spArr)
+			dMax = std::max(dMax, d.length());
+	return IonicMinimizer::maxAtomTestDisplacement/dMax;
+}
+
+double NEB::sync(double x) const
+{	mpiWorld->bcast(x);
+	return x;
+}
+
+double NEB::minimize(const MinimizeParams& mp)
+{	MinimizeParams p = mp;
+	p.linminMethod = MinimizeParams::Relax; //NEB force is not the gradient of an energy
+	p.energyDiffThreshold = 0.; //sum of image energies is not minimized: converge on NEB force alone
+	if(p.knormThreshold <= 0.)
+		die("Convergence parameter knormThreshold of ionic-minimize must be > 0 in nudged elastic band calculations.\n");
+	p.nDim = mp.nDim * nImages;
+	p.linePrefix = "NEB: ";
+	p.energyLabel = "Esum";
+	double result = Minimizable<IonicGradient>::minimize(p);
+	//Final output of each image:
+	ProcessGroupScope groupScope;
+	for(int i=1; i<=nImages; i++) if(images[i])
+		images[i]->dump(DumpFreq_End, 0);
+	return result;
+}
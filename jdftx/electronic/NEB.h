@@ -0,0 +1,79 @@
+/*-------------------------------------------------------------------
+Copyright 2026 JDFTx contributors
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#ifndef JDFTX_ELECTRONIC_NEB_H
+#define JDFTX_ELECTRONIC_NEB_H
+
+#include <electronic/IonicMinimizer.h>
+#include <electronic/NEBparams.h>
+
+//! @addtogroup IonicSystem
+//! @{
+//! @file NEB.h Class NEB
+
+/**
+Nudged elastic band (NEB) calculation with optional climbing image.
+The initial state is the system in the input file (e), and the final state is read from NEBparams::finalPositionsFilename.
+Each intermediate image is a separate Everything, set up and evaluated within one process group
+(command-line option -G), with images assigned to groups cyclically. The images retain their
+electronic state between iterations, so that each evaluation is warm-started from the previous one.
+The optimizer acts on the concatenation of the image gradients: the IonicGradient species blocks of
+image i (1-based) are at [(i-1)*nSpecies, i*nSpecies). Since the NEB force is not the gradient of an
+energy, the line minimization is always Relax, and the reported energy is the sum over images.
+Convergence is therefore tested only on the RMS NEB force over all images (knormThreshold of ionic-minimize).
+Symmetries are disabled for the intermediate images, and HyperPlane constraints are not supported.
+*/
+class NEB : public Minimizable<IonicGradient>
+{
+public:
+	NEB(Everything& e, const std::vector< std::pair<string,string> >& input);
+
+	//Virtual functions from Minimizable:
+	void step(const IonicGradient& dir, double alpha);
+	double compute(IonicGradient* grad, IonicGradient* Kgrad);
+	bool report(int iter);
+	void constrain(IonicGradient&);
+	double safeStepSize(const IonicGradient& dir) const; //!< enforces IonicMinimizer::maxAtomTestDisplacement on test step size
+	double sync(double x) const; //!< All processes minimize together; make sure scalars are in sync to round-off error
+
+	double minimize(const MinimizeParams& mp); //!< optimize the band (with Relax line minimization) and dump final state of each image
+
+private:
+	Everything& e; //!< initial state
+	const NEBparams& params;
+	int nImages; //!< number of intermediate images
+	int nSpecies; //!< number of species (size of IonicGradient blocks for each image)
+	std::vector<double> E; //!< energy of each image (including end points) on all processes
+	std::vector<IonicGradient> pos; //!< Cartesian positions of each image (including end points) on all processes
+	std::vector<IonicGradient> gradImage; //!< Cartesian energy gradient of each image on all processes (end points unused)
+	int iClimb; //!< index of climbing image (0 if none)
+	bool anyConstrained; //!< whether any atom is constrained (otherwise net force on each image is removed)
+	std::vector< std::shared_ptr<Everything> > images; //!< image systems handled by current process group (null otherwise)
+	std::vector< std::shared_ptr<IonicMinimizer> > imins; //!< ionic minimizers of above (for wavefunction drag and forces)
+
+	bool isMine(int i) const { return (i-1) % mpiGroup->procDivision.nGroups == mpiGroup->procDivision.iGroup; } //!< whether image i (1 to nImages+1) is handled by current group
+	std::shared_ptr<Everything> createImage(int i, const std::vector< std::pair<string,string> >& input, const IonicGradient& x) const; //!< set up image i at lattice coordinates x
+	void collectImages(); //!< make energies, positions and gradients of all intermediate images available on all processes
+	IonicGradient displacement(int i1, int i2) const; //!< Cartesian displacement from image i1 to i2 (nearest periodic image of each atom)
+	IonicGradient tangent(int i) const; //!< unit tangent at intermediate image i (upwind, energy-weighted at extrema)
+	IonicGradient getBlock(const IonicGradient& x, int i) const; //!< extract image i from concatenated vector
+};
+
+//! @}
+#endif // JDFTX_ELECTRONIC_NEB_H
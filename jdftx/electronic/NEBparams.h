@@ -0,0 +1,40 @@
+/*-------------------------------------------------------------------
+Copyright 2026 JDFTx contributors
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#ifndef JDFTX_ELECTRONIC_NEBPARAMS_H
+#define JDFTX_ELECTRONIC_NEBPARAMS_H
+
+#include <core/string.h>
+
+//! @addtogroup IonicSystem
+//! @{
+//! @file NEBparams.h Struct NEBparams
+
+//! Parameters to control the nudged elastic band (NEB) calculation
+struct NEBparams
+{	int nImages; //!< number of intermediate images (NEB is disabled if zero)
+	string finalPositionsFilename; //!< file containing ion commands for the final state (the initial state is specified in the input file)
+	double springConstant; //!< spring constant between adjacent images [Eh/a0^2]
+	bool climbing; //!< whether to use the climbing-image method for the highest-energy image
+
+	NEBparams() : nImages(0), springConstant(0.05), climbing(true) {}
+};
+
+//! @}
+#endif // JDFTX_ELECTRONIC_NEBPARAMS_H
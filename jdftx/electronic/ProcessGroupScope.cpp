@@ -0,0 +1,124 @@
+/*-------------------------------------------------------------------
+Copyright 2026 JDFTx contributors
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#include <electronic/ProcessGroupScope.h>
+#include <electronic/Everything.h>
+#include <electronic/ColumnBundle.h>
+
+ProcessGroupScope::ProcessGroupScope(Everything& e) : e(&e), mpiWorldSaved(mpiWorld)
+{	//Sources of each state in the original division:
+	std::vector<int> qSrc(e.eInfo.nStates);
+	for(int q=0; q<e.eInfo.nStates; q++)
+		qSrc[q] = e.eInfo.whose(q);
+	//Broadcast over all processes, and then switch to groups:
+	redistribute(qSrc, mpiGroup);
+	if(iGroup()) dumpSaved.swap(e.dump); //only group 0 writes output files
+}
+
+ProcessGroupScope::ProcessGroupScope() : e(0), mpiWorldSaved(mpiWorld)
+{	mpiWorld = mpiGroup;
+}
+
+ProcessGroupScope::~ProcessGroupScope()
+{	if(!e) { mpiWorld = mpiWorldSaved; return; } //no state to redistribute
+	if(iGroup()) dumpSaved.swap(e->dump);
+	//Sources of each state from group 0, which consists of processes 0 to mpiGroup->nProcesses()-1 of the original mpiWorld:
+	bool inGroup0 = (mpiGroup->procDivision.iGroup == 0);
+	std::vector<int> qSrc(e->eInfo.nStates, -1);
+	if(inGroup0)
+		for(int q=e->eInfo.qStart; q<e->eInfo.qStop; q++)
+			qSrc[q] = mpiGroup->iProcess(); //= rank in original mpiWorld
+	mpiWorld = mpiWorldSaved;
+	mpiWorld->allReduceData(qSrc, MPIUtil::ReduceMax);
+	//Broadcast over all processes, and restore original division:
+	redistribute(qSrc, mpiWorld);
+}
+
+bool ProcessGroupScope::available(const Everything& e)
+{	if(mpiGroup->procDivision.nGroups <= 1) return false;
+	if(mpiGroup->nProcesses() == mpiWorld->nProcesses()) return false; //only one group
+	const char* reason = 0;
+	if(e.exx) reason = "exact exchange";
+	if(e.eVars.fluidParams.fluidType != FluidNone) reason = "fluids";
+	if(reason)
+	{	logPrintf("NOTE: process groups are not supported with %s; running configurations one at a time.\n", reason);
+		return false;
+	}
+	return true;
+}
+
+//Broadcast a matrix of unknown size on non-root processes:
+template<typename T> void bcastMatrix(T& M, int root)
+{	int dims[2] = { M.nRows(), M.nCols() };
+	mpiWorld->bcast(dims, 2, root);
+	if(mpiWorld->iProcess() != root) M.init(dims[0], dims[1]);
+	if(dims[0] && dims[1]) mpiWorld->bcastData(M, root);
+}
+void bcastMatrix(diagMatrix& M, int root)
+{	int n = M.nRows();
+	mpiWorld->bcast(n, root);
+	M.resize(n);
+	if(n) mpiWorld->bcastData(M, root);
+}
+
+void ProcessGroupScope::redistribute(const std::vector<int>& qSrc, MPIUtil* mpiTarget)
+{	Everything& e = *(this->e);
+	ElecInfo& eInfo = e.eInfo;
+	ElecVars& eVars = e.eVars;
+	TaskDivision qDivision(eInfo.nStates, mpiTarget);
+	//Broadcast each state over the current mpiWorld, and retain it only if needed under the new division:
+	for(int q=0; q<eInfo.nStates; q++)
+	{	int src = qSrc[q];
+		bool isSrc = (mpiWorld->iProcess() == src);
+		if(!isSrc)
+			eVars.C[q].init(eInfo.nBands, e.basis[q].nbasis * eInfo.spinorLength(), &e.basis[q], &eInfo.qnums[q], isGpuEnabled());
+		mpiWorld->bcastData(eVars.C[q], src);
+		bcastMatrix(eVars.F[q], src);
+		if(eVars.Haux_eigs.size()) bcastMatrix(eVars.Haux_eigs[q], src);
+		bcastMatrix(eVars.Hsub[q], src);
+		bcastMatrix(eVars.Hsub_evecs[q], src);
+		bcastMatrix(eVars.Hsub_eigs[q], src);
+		if(!qDivision.isMine(q))
+		{	eVars.C[q].free();
+			eVars.F[q] = diagMatrix();
+			if(eVars.Haux_eigs.size()) eVars.Haux_eigs[q] = diagMatrix();
+			eVars.Hsub[q] = matrix();
+			eVars.Hsub_evecs[q] = matrix();
+			eVars.Hsub_eigs[q] = diagMatrix();
+			eVars.VdagC[q].clear();
+		}
+	}
+	//Switch communicator and update setup-time divisions:
+	for(auto sp: e.iInfo.species)
+		mpiWorld->bcastData(sp->atpos); //ensure identical positions (groups may differ by round-off)
+	mpiWorld = mpiTarget;
+	eInfo.qDivision = qDivision;
+	qDivision.myRange(eInfo.qStart, eInfo.qStop);
+	for(GridInfo* gInfo: { &e.gInfo, e.gInfoWfns.get() })
+		if(gInfo)
+		{	TaskDivision(gInfo->nr, mpiWorld).myRange(gInfo->irStart, gInfo->irStop);
+			TaskDivision(gInfo->nG, mpiWorld).myRange(gInfo->iGstart, gInfo->iGstop);
+		}
+	for(auto sp: e.iInfo.species) sp->sync_atpos(); //also invalidates atom divisions of real-space augmentation
+	//Update projections of states now local:
+	for(int q=eInfo.qStart; q<eInfo.qStop; q++)
+	{	eVars.VdagC[q].clear();
+		e.iInfo.project(eVars.C[q], eVars.VdagC[q]);
+	}
+}
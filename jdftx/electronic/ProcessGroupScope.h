@@ -0,0 +1,65 @@
+/*-------------------------------------------------------------------
+Copyright 2026 JDFTx contributors
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#ifndef JDFTX_ELECTRONIC_PROCESSGROUPSCOPE_H
+#define JDFTX_ELECTRONIC_PROCESSGROUPSCOPE_H
+
+#include <electronic/Dump.h>
+#include <core/Util.h>
+
+class Everything;
+
+//! @addtogroup ElectronicDFT
+//! @{
+
+/**
+Run independent electronic calculations concurrently in each process group (command-line option -G).
+While an object of this class exists, mpiWorld is replaced by mpiGroup, and the electronic state
+(wavefunctions, fillings and subspace matrices) and all setup-time process divisions are redistributed
+within each group, so that every group holds a complete copy of the state at construction.
+On destruction, the state of group 0 is redistributed back over all processes and mpiWorld is restored.
+Derived quantities (densities, potentials, energies) are not recomputed upon destruction.
+Only the world head (which belongs to group 0) writes to the log, and only group 0 dumps output, while the groups are active.
+The default constructor only replaces mpiWorld by mpiGroup, for calculations that set up their own Everything
+within each group (eg. NEB images and phonon supercells), and leaves all existing state untouched.
+*/
+class ProcessGroupScope
+{
+public:
+	ProcessGroupScope(Everything& e); //!< switch to groups, redistributing the electronic state of e
+	ProcessGroupScope(); //!< switch to groups without any state to redistribute
+	~ProcessGroupScope();
+
+	int nGroups() const { return mpiGroup->procDivision.nGroups; } //!< number of concurrent groups
+	int iGroup() const { return mpiGroup->procDivision.iGroup; } //!< index of group of current process
+	bool isMine(int iTask) const { return iTask % nGroups() == iGroup(); } //!< whether current group handles task iTask (round-robin)
+
+	//! Whether concurrent process groups are available and supported for the current calculation
+	//! (prints the reason to the log if groups were requested, but cannot be used)
+	static bool available(const Everything& e);
+
+private:
+	Everything* e; //!< system whose state is redistributed (null if none)
+	MPIUtil* mpiWorldSaved; //!< original mpiWorld
+	std::set<std::pair<DumpFrequency,DumpVariable> > dumpSaved; //!< dump variables suppressed on groups other than 0
+	void redistribute(const std::vector<int>& qSrc, MPIUtil* mpiTarget); //!< broadcast states from process qSrc[q] on the original mpiWorld and switch to division over mpiTarget
+};
+
+//! @}
+#endif //JDFTX_ELECTRONIC_PROCESSGROUPSCOPE_H
@@ -0,0 +1,126 @@
+/*-------------------------------------------------------------------
+Copyright 2026 JDFTx contributors
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#include <electronic/ProjectorCache.h>
+#include <electronic/ColumnBundle.h>
+#include <core/Util.h>
+
+bool ProjectorCache::Key::operator<(const Key& other) const
+{	if(sp != other.sp) return sp < other.sp;
+	if(basis != other.basis) return basis < other.basis;
+	for(int j=0; j<3; j++)
+		if(k[j] != other.k[j]) return k[j] < other.k[j];
+	return false;
+}
+
+ProjectorCache::ProjectorCache()
+: maxBytes(0), singlePrecision(false), nBytes(0), nBytesPeak(0), nHits(0), nMisses(0), nEvictions(0)
+{
+}
+
+void ProjectorCache::setLimits(size_t maxBytes, bool singlePrecision)
+{	std::lock_guard<std::mutex> guard(lock);
+	this->maxBytes = maxBytes;
+	this->singlePrecision = singlePrecision;
+}
+
+std::shared_ptr<ColumnBundle> ProjectorCache::find(const SpeciesInfo* sp, const vector3<>& k, const Basis* basis)
+{	std::lock_guard<std::mutex> guard(lock);
+	auto iter = entries.find(Key{sp, k, basis});
+	if(iter == entries.end()) { nMisses++; return 0; }
+	nHits++;
+	Entry& entry = iter->second;
+	lru.splice(lru.begin(), lru, entry.lruIter); //mark as most recently used
+	if(entry.V) return entry.V;
+	//Reuse expanded copy if still in use:
+	std::shared_ptr<ColumnBundle> V = entry.Vexpanded.lock();
+	if(V) return V;
+	//Expand from single precision:
+	V = std::make_shared<ColumnBundle>(entry.nCols, entry.colLength, basis, entry.qnum, false);
+	complex* Vdata = V->data();
+	const float* VsingleData = entry.Vsingle.data();
+	for(size_t i=0; i<V->nData(); i++)
+		Vdata[i] = complex(VsingleData[2*i], VsingleData[2*i+1]);
+	entry.Vexpanded = V;
+	return V;
+}
+
+void ProjectorCache::add(const SpeciesInfo* sp, const vector3<>& k, const Basis* basis, const std::shared_ptr<ColumnBundle>& V)
+{	std::lock_guard<std::mutex> guard(lock);
+	Key key{sp, k, basis};
+	auto iter = entries.find(key);
+	if(iter != entries.end()) erase(iter); //replace existing entry
+	//Prepare entry:
+	Entry entry;
+	entry.nCols = V->nCols();
+	entry.colLength = V->colLength();
+	entry.qnum = V->qnum;
+	if(singlePrecision)
+	{	entry.Vsingle.resize(2*V->nData());
+		const complex* Vdata = V->data();
+		float* VsingleData = entry.Vsingle.data();
+		for(size_t i=0; i<V->nData(); i++)
+		{	VsingleData[2*i] = float(Vdata[i].real());
+			VsingleData[2*i+1] = float(Vdata[i].imag());
+		}
+		entry.nBytes = entry.Vsingle.size() * sizeof(float);
+	}
+	else
+	{	entry.V = V;
+		entry.nBytes = V->nData() * sizeof(complex);
+	}
+	if(maxBytes && entry.nBytes > maxBytes) return; //would never fit
+	//Evict least recently used entries to make room:
+	while(maxBytes && nBytes + entry.nBytes > maxBytes)
+	{	erase(entries.find(lru.back()));
+		nEvictions++;
+	}
+	//Add entry:
+	lru.push_front(key);
+	entry.lruIter = lru.begin();
+	nBytes += entry.nBytes;
+	nBytesPeak = std::max(nBytesPeak, nBytes);
+	entries[key] = std::move(entry);
+}
+
+void ProjectorCache::clear(const SpeciesInfo* sp)
+{	std::lock_guard<std::mutex> guard(lock);
+	for(auto iter=entries.begin(); iter!=entries.end();)
+	{	auto iterNext = iter; iterNext++;
+		if(iter->first.sp == sp || !iter->first.sp) erase(iter); //merged entries (null sp) include all species
+		iter = iterNext;
+	}
+}
+
+void ProjectorCache::erase(std::map<Key,Entry>::iterator iter)
+{	nBytes -= iter->second.nBytes;
+	lru.erase(iter->second.lruIter);
+	entries.erase(iter);
+}
+
+void ProjectorCache::printStats() const
+{	size_t stats[4] = { nHits, nMisses, nEvictions, entries.size() };
+	mpiWorld->allReduce(stats, 4, MPIUtil::ReduceSum);
+	size_t nBytesMax[2] = { nBytes, nBytesPeak };
+	mpiWorld->allReduce(nBytesMax, 2, MPIUtil::ReduceMax);
+	size_t nLookups = stats[0] + stats[1];
+	if(!nLookups) return; //cache unused
+	logPrintf("Projector cache: %lu entries (%.1lf MB current, %.1lf MB peak per process), hit rate %.1lf%% of %lu lookups, %lu evictions.\n",
+		stats[3], nBytesMax[0]/1048576., nBytesMax[1]/1048576., (100.*stats[0])/nLookups, nLookups, stats[2]);
+}
@@ -0,0 +1,91 @@
+/*-------------------------------------------------------------------
+Copyright 2026 JDFTx contributors
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#ifndef JDFTX_ELECTRONIC_PROJECTORCACHE_H
+#define JDFTX_ELECTRONIC_PROJECTORCACHE_H
+
+#include <core/vector3.h>
+#include <map>
+#include <list>
+#include <mutex>
+#include <memory>
+#include <vector>
+
+class ColumnBundle;
+class SpeciesInfo;
+class Basis;
+class QuantumNumber;
+
+//! @addtogroup IonicSystem
+//! @{
+
+//! Cache of nonlocal projectors (see SpeciesInfo::getV) shared by all species, with a memory budget
+//! enforced by evicting the least-recently used entries across species and k-points.
+//! Projectors merged across all species (see IonInfo::project) are stored with a null species.
+//! Entries stored in single precision are expanded to a double-precision ColumnBundle on lookup,
+//! which costs an extra pass over (and temporarily, twice the memory of) the entry; the expanded
+//! copy is shared by all lookups while any caller still holds it, but is not counted in the budget.
+class ProjectorCache
+{
+public:
+	ProjectorCache();
+
+	//! Set the memory budget in bytes (0 => unlimited) and whether to store entries in single precision
+	void setLimits(size_t maxBytes, bool singlePrecision);
+
+	//! Return cached projectors of species sp at k-point k with specified basis (null if not in cache)
+	std::shared_ptr<ColumnBundle> find(const SpeciesInfo* sp, const vector3<>& k, const Basis* basis);
+
+	//! Add projectors V of species sp at k-point k with specified basis (evicting older entries as necessary)
+	void add(const SpeciesInfo* sp, const vector3<>& k, const Basis* basis, const std::shared_ptr<ColumnBundle>& V);
+
+	void clear(const SpeciesInfo* sp); //!< remove all entries for a species (eg. when atoms move), and any merged entries containing it
+	void printStats() const; //!< print size and hit-rate statistics (collective over mpiWorld)
+
+private:
+	struct Key
+	{	const SpeciesInfo* sp;
+		vector3<> k;
+		const Basis* basis;
+		bool operator<(const Key& other) const;
+	};
+	typedef std::list<Key> LRUlist; //most recently used entries first
+	struct Entry
+	{	std::shared_ptr<ColumnBundle> V; //full-precision projectors (if stored in double precision)
+		std::vector<float> Vsingle; //real and imaginary parts of projectors (if stored in single precision)
+		std::weak_ptr<ColumnBundle> Vexpanded; //double-precision expansion of Vsingle, while still in use
+		int nCols; size_t colLength; //dimensions of projectors
+		const QuantumNumber* qnum; //quantum number of projectors
+		size_t nBytes; //memory used by this entry
+		LRUlist::iterator lruIter; //location in LRU list
+	};
+	std::map<Key,Entry> entries;
+	LRUlist lru;
+	std::mutex lock;
+
+	size_t maxBytes; //memory budget (0 => unlimited)
+	bool singlePrecision; //whether to store entries in single precision
+	size_t nBytes, nBytesPeak; //current and peak memory usage
+	size_t nHits, nMisses, nEvictions; //usage statistics
+
+	void erase(std::map<Key,Entry>::iterator iter);
+};
+
+//! @}
+#endif // JDFTX_ELECTRONIC_PROJECTORCACHE_H
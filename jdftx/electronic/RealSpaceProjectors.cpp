@@ -0,0 +1,479 @@
+/*-------------------------------------------------------------------
+Copyright 2026 JDFTx contributors
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#include <electronic/RealSpaceProjectors.h>
+#include <electronic/SpeciesInfo.h>
+#include <electronic/Everything.h>
+#include <electronic/ColumnBundle.h>
+#include <core/SphericalHarmonics.h>
+#include <core/Thread.h>
+#include <cfloat>
+
+//Gaussian mask used for filtering, with mask(1) = 1e-3 at the sphere radius:
+inline double projectorMask(double x) { return exp(-3.*log(10.)*x*x); }
+
+void maskedFilter(const RadialFunctionR& f, int l, double rCut, double qCut, RadialFunctionG& result)
+{	//Divide by mask and transform to reciprocal space:
+	RadialFunctionR g(f);
+	for(size_t i=0; i<g.r.size(); i++)
+		g.f[i] = (g.r[i] < rCut) ? f.f[i] / projectorMask(g.r[i]/rCut) : 0.;
+	double dq = M_PI / (16.*rCut); //resolve oscillations of j_l(qr) within the sphere
+	int nqHlf = int(ceil(0.5*qCut/dq)); dq = 0.5*qCut/nqHlf;
+	std::vector<double> gTilde(2*nqHlf+1);
+	for(int iq=0; iq<=2*nqHlf; iq++)
+		gTilde[iq] = g.transform(l, iq*dq);
+	//Band-limited inverse transform and multiply back by mask:
+	const double dr = 0.01;
+	int nr = int(ceil(rCut/dr)) + 5; //include padding for spline
+	std::vector<double> samples(nr, 0.);
+	for(int ir=0; ir<nr; ir++)
+	{	double r = ir*dr;
+		if(r >= rCut) break;
+		double sum = 0.; //Simpson's 1/3 rule in q:
+		for(int iq=0; iq<=2*nqHlf; iq++)
+		{	double q = iq*dq;
+			sum += gTilde[iq] * q*q * bessel_jl(l, q*r)
+				* ( (iq==0 || iq==2*nqHlf) ? 1 : 2*((iq%2)+1) );
+		}
+		samples[ir] = projectorMask(r/rCut) * sum * dq / (3. * 2*M_PI*M_PI); //includes the 1/(2pi^2) of the inverse spherical Bessel transform
+	}
+	result.init(l, samples, dr);
+}
+
+double maskedFilterQcut(const GridInfo& gInfo)
+{	double qCut = DBL_MAX;
+	for(int k=0; k<3; k++)
+		qCut = std::min(qCut, M_PI * gInfo.S[k] / gInfo.R.column(k).length());
+	return qCut;
+}
+
+double radialExtent(const RadialFunctionR& f)
+{	double fMax = 0.; for(double fi: f.f) fMax = std::max(fMax, fabs(fi));
+	double rMax = 0.;
+	for(size_t i=0; i<f.f.size(); i++)
+		if(fabs(f.f[i]) > 1e-8*fMax)
+			rMax = f.r[i];
+	return rMax;
+}
+
+void AtomicSpheres::init(const GridInfo& gInfo, const std::vector<vector3<>>& atpos, double rCut)
+{	atomStart.assign(1, 0);
+	index.clear(); x.clear(); r.clear(); rHat.clear();
+	for(const vector3<>& pos: atpos)
+	{	vector3<int> iMin, iMax;
+		for(int k=0; k<3; k++)
+		{	double halfWidth = rCut * gInfo.invR.row(k).length(); //sphere extent in lattice coordinates
+			iMin[k] = int(ceil((pos[k]-halfWidth) * gInfo.S[k]));
+			iMax[k] = int(floor((pos[k]+halfWidth) * gInfo.S[k]));
+		}
+		vector3<int> i;
+		for(i[0]=iMin[0]; i[0]<=iMax[0]; i[0]++)
+		for(i[1]=iMin[1]; i[1]<=iMax[1]; i[1]++)
+		for(i[2]=iMin[2]; i[2]<=iMax[2]; i[2]++)
+		{	vector3<> xCur; for(int k=0; k<3; k++) xCur[k] = double(i[k]) / gInfo.S[k];
+			vector3<> d = gInfo.R * (xCur - pos);
+			double rCur = d.length();
+			if(rCur >= rCut) continue;
+			vector3<int> iWrapped; for(int k=0; k<3; k++) iWrapped[k] = ((i[k] % gInfo.S[k]) + gInfo.S[k]) % gInfo.S[k];
+			index.push_back(gInfo.fullRindex(iWrapped));
+			x.push_back(xCur);
+			r.push_back(rCur);
+			rHat.push_back(d * (rCur ? 1./rCur : 0.));
+		}
+		atomStart.push_back(index.size());
+	}
+}
+
+RealSpaceProjectors::RealSpaceProjectors(const SpeciesInfo& sp, const GridInfo& gInfo, double rCutScale) : gInfo(gInfo)
+{	static StopWatch watch("RealSpaceProjectors::init"); watch.start();
+
+	//Determine projector extent and sphere radius:
+	double rSupport = 0.;
+	nProj = 0;
+	for(int l=0; l<int(sp.VnlRadial.size()); l++)
+		for(const RadialFunctionG& Vnl: sp.VnlRadial[l])
+		{	assert(Vnl.rFunc);
+			rSupport = std::max(rSupport, radialExtent(*Vnl.rFunc));
+			nProj += 2*l+1;
+		}
+	rCut = rCutScale * rSupport;
+	spheres.init(gInfo, sp.atpos, rCut);
+
+	//Filtered radial functions:
+	double qCut = maskedFilterQcut(gInfo);
+	radial.resize(sp.VnlRadial.size());
+	for(int l=0; l<int(sp.VnlRadial.size()); l++)
+	{	radial[l].resize(sp.VnlRadial[l].size());
+		for(unsigned p=0; p<radial[l].size(); p++)
+			maskedFilter(*sp.VnlRadial[l][p].rFunc, l, rCut, qCut, radial[l][p]);
+	}
+	for(int l=0; l<int(radial.size()); l++)
+		for(unsigned p=0; p<radial[l].size(); p++)
+			for(int m=-l; m<=l; m++)
+				lPhase.push_back(cis(-0.5*M_PI*l));
+
+	//Projector values on each sphere (dV included for integration):
+	proj.resize(nProj * spheres.nPoints());
+	double* projCur = proj.data();
+	for(int atom=0; atom<spheres.nAtoms(); atom++)
+	{	size_t pStart = spheres.atomStart[atom], pStop = spheres.atomStart[atom+1];
+		for(int l=0; l<int(radial.size()); l++)
+			for(unsigned p=0; p<radial[l].size(); p++)
+				for(int m=-l; m<=l; m++)
+					for(size_t iPoint=pStart; iPoint<pStop; iPoint++)
+						*(projCur++) = gInfo.dV * radial[l][p](spheres.r[iPoint]) * Ylm(l, m, spheres.rHat[iPoint]);
+	}
+	logPrintf("Initialized real-space projectors for species %s with rCut = %lg bohrs and %lu points per atom.\n",
+		sp.name.c_str(), rCut, spheres.nPoints()/sp.atpos.size());
+	watch.stop();
+}
+
+RealSpaceProjectors::~RealSpaceProjectors()
+{	for(auto& radialL: radial) for(auto& radialLP: radialL) radialLP.free();
+}
+
+void RealSpaceProjectors::initDerivatives() const
+{	if(projDeriv[0].size()) return; //already initialized
+	static StopWatch watch("RealSpaceProjectors::initDerivatives"); watch.start();
+	const double h = 1e-4; //central-difference step [bohrs] (the filtered radial functions are smooth splines)
+	for(int k=0; k<3; k++) projDeriv[k].resize(proj.size());
+	size_t offs = 0;
+	for(int atom=0; atom<spheres.nAtoms(); atom++)
+	{	size_t pStart = spheres.atomStart[atom], pStop = spheres.atomStart[atom+1];
+		for(int l=0; l<int(radial.size()); l++)
+			for(unsigned p=0; p<radial[l].size(); p++)
+				for(int m=-l; m<=l; m++)
+					for(size_t iPoint=pStart; iPoint<pStop; iPoint++)
+					{	vector3<> d = spheres.r[iPoint] * spheres.rHat[iPoint]; //displacement of point from atom
+						for(int k=0; k<3; k++)
+						{	double projPM[2];
+							for(int sign=-1, iPM=0; sign<=1; sign+=2, iPM++)
+							{	vector3<> dCur = d; dCur[k] += sign*h;
+								double rCur = dCur.length();
+								projPM[iPM] = radial[l][p](rCur) * Ylm(l, m, dCur*(1./rCur));
+							}
+							projDeriv[k][offs] = gInfo.dV * (projPM[1]-projPM[0]) / (2.*h);
+						}
+						offs++;
+					}
+	}
+	watch.stop();
+}
+
+std::vector<complex> RealSpaceProjectors::getPhases(const vector3<>& k) const
+{	std::vector<complex> phase(spheres.nPoints());
+	for(size_t iPoint=0; iPoint<phase.size(); iPoint++)
+		phase[iPoint] = cis((2*M_PI)*dot(k, spheres.x[iPoint]));
+	return phase;
+}
+
+void RealSpaceProjectors::projectColumn(const complex* phase, const complex* ICbs, int b, int s, int nSpinor, complex* VdagCq, int ldVdagCq, const double* projData) const
+{	std::vector<complex> psi;
+	for(int atom=0; atom<spheres.nAtoms(); atom++)
+	{	size_t pStart = spheres.atomStart[atom];
+		size_t nPointsAtom = spheres.atomStart[atom+1] - pStart;
+		//Gather Bloch wavefunction on sphere:
+		psi.resize(nPointsAtom);
+		for(size_t iPoint=0; iPoint<nPointsAtom; iPoint++)
+			psi[iPoint] = phase[pStart+iPoint] * ICbs[spheres.index[pStart+iPoint]];
+		//Integrate against each projector:
+		const double* projAtom = (projData ? projData : proj.data()) + nProj*pStart;
+		for(int iProj=0; iProj<nProj; iProj++)
+		{	const double* projCur = projAtom + iProj*nPointsAtom;
+			double sumRe = 0., sumIm = 0.;
+			for(size_t iPoint=0; iPoint<nPointsAtom; iPoint++)
+			{	sumRe += projCur[iPoint] * psi[iPoint].real();
+				sumIm += projCur[iPoint] * psi[iPoint].imag();
+			}
+			VdagCq[nSpinor*(atom*nProj+iProj)+s + ldVdagCq*b] = lPhase[iProj] * complex(sumRe, sumIm);
+		}
+	}
+}
+
+void RealSpaceProjectors::projectGradColumn(const complex* phase, const complex* HVdagCq, int ldHVdagCq, int b, int s, int nSpinor, complex* HICbs) const
+{	std::vector<complex> coeff(nProj);
+	for(int atom=0; atom<spheres.nAtoms(); atom++)
+	{	size_t pStart = spheres.atomStart[atom];
+		size_t nPointsAtom = spheres.atomStart[atom+1] - pStart;
+		for(int iProj=0; iProj<nProj; iProj++)
+			coeff[iProj] = lPhase[iProj].conj() * HVdagCq[nSpinor*(atom*nProj+iProj)+s + ldHVdagCq*b];
+		//Expand on sphere and scatter to grid:
+		const double* projAtom = proj.data() + nProj*pStart;
+		for(size_t iPoint=0; iPoint<nPointsAtom; iPoint++)
+		{	complex sum = 0.;
+			for(int iProj=0; iProj<nProj; iProj++)
+				sum += projAtom[iProj*nPointsAtom+iPoint] * coeff[iProj];
+			HICbs[spheres.index[pStart+iPoint]] += phase[pStart+iPoint].conj() * sum;
+		}
+	}
+}
+
+//Project one column at a time (one FFT per column and spinor component shared by all species):
+void RealSpaceProjectors_project_sub(int colStart, int colStop, const ColumnBundle* Cq,
+	const std::vector<const RealSpaceProjectors*>* rsp, const std::vector<std::vector<complex>>* phase,
+	const std::vector<complex*>* VdagCqData, const std::vector<int>* ldVdagCq)
+{	int nSpinor = Cq->spinorLength();
+	for(int b=colStart; b<colStop; b++)
+		for(int s=0; s<nSpinor; s++)
+		{	complexScalarField ICbs = I(Cq->getColumn(b,s));
+			const complex* ICbsData = ICbs->data();
+			for(unsigned sp=0; sp<rsp->size(); sp++)
+				if(rsp->at(sp))
+					rsp->at(sp)->projectColumn(phase->at(sp).data(), ICbsData, b, s, nSpinor, VdagCqData->at(sp), ldVdagCq->at(sp));
+		}
+}
+
+void RealSpaceProjectors::project(const ColumnBundle& Cq, const std::vector<const RealSpaceProjectors*>& rsp, std::vector<matrix>& VdagCq)
+{	static StopWatch watch("RealSpaceProjectors::project"); watch.start();
+	std::vector<std::vector<complex>> phase(rsp.size());
+	std::vector<complex*> VdagCqData(rsp.size(), 0);
+	std::vector<int> ldVdagCq(rsp.size(), 0);
+	VdagCq.resize(rsp.size());
+	for(unsigned sp=0; sp<rsp.size(); sp++)
+		if(rsp[sp])
+		{	assert(&(rsp[sp]->gInfo) == Cq.basis->gInfo);
+			phase[sp] = rsp[sp]->getPhases(Cq.qnum->k);
+			VdagCq[sp].init(rsp[sp]->nProjectors() * Cq.spinorLength(), Cq.nCols());
+			VdagCqData[sp] = VdagCq[sp].data();
+			ldVdagCq[sp] = VdagCq[sp].nRows();
+		}
+	threadLaunch(isGpuEnabled()?1:0, RealSpaceProjectors_project_sub, Cq.nCols(), &Cq, &rsp, &phase, &VdagCqData, &ldVdagCq);
+	watch.stop();
+}
+
+//Accumulate projected gradient one column at a time (one FFT per column and spinor component shared by all species):
+void RealSpaceProjectors_projectGrad_sub(int colStart, int colStop, const std::vector<const RealSpaceProjectors*>* rsp,
+	const std::vector<std::vector<complex>>* phase, const std::vector<const complex*>* HVdagCqData, const std::vector<int>* ldHVdagCq,
+	ColumnBundle* HCq)
+{	int nSpinor = HCq->spinorLength();
+	const GridInfo& gInfo = *(HCq->basis->gInfo);
+	for(int b=colStart; b<colStop; b++)
+		for(int s=0; s<nSpinor; s++)
+		{	complexScalarField HICbs; nullToZero(HICbs, gInfo);
+			complex* HICbsData = HICbs->data();
+			for(unsigned sp=0; sp<rsp->size(); sp++)
+				if(rsp->at(sp) && HVdagCqData->at(sp))
+					rsp->at(sp)->projectGradColumn(phase->at(sp).data(), HVdagCqData->at(sp), ldHVdagCq->at(sp), b, s, nSpinor, HICbsData);
+			HCq->accumColumn(b,s, Idag(HICbs));
+		}
+}
+
+void RealSpaceProjectors::projectGrad(const std::vector<const RealSpaceProjectors*>& rsp, const std::vector<matrix>& HVdagCq, ColumnBundle& HCq)
+{	static StopWatch watch("RealSpaceProjectors::projectGrad"); watch.start();
+	std::vector<std::vector<complex>> phase(rsp.size());
+	std::vector<const complex*> HVdagCqData(rsp.size(), 0);
+	std::vector<int> ldHVdagCq(rsp.size(), 0);
+	for(unsigned sp=0; sp<rsp.size(); sp++)
+		if(rsp[sp] && HVdagCq[sp])
+		{	assert(&(rsp[sp]->gInfo) == HCq.basis->gInfo);
+			phase[sp] = rsp[sp]->getPhases(HCq.qnum->k);
+			assert(HVdagCq[sp].nRows() == rsp[sp]->nProjectors() * HCq.spinorLength());
+			assert(HVdagCq[sp].nCols() == HCq.nCols());
+			HVdagCqData[sp] = HVdagCq[sp].data();
+			ldHVdagCq[sp] = HVdagCq[sp].nRows();
+		}
+	threadLaunch(isGpuEnabled()?1:0, RealSpaceProjectors_projectGrad_sub, HCq.nCols(), &rsp, &phase, &HVdagCqData, &ldHVdagCq, &HCq);
+	watch.stop();
+}
+
+//Project derivatives one column at a time (one FFT per column and spinor component shared by all directions):
+void RealSpaceProjectors_projectDeriv_sub(int colStart, int colStop, const ColumnBundle* Cq, const RealSpaceProjectors* rsp,
+	const std::vector<complex>* phase, complex** DVdagCqData, int ldDVdagCq)
+{	int nSpinor = Cq->spinorLength();
+	for(int b=colStart; b<colStop; b++)
+		for(int s=0; s<nSpinor; s++)
+		{	complexScalarField ICbs = I(Cq->getColumn(b,s));
+			for(int k=0; k<3; k++)
+				rsp->projectColumn(phase->data(), ICbs->data(), b, s, nSpinor, DVdagCqData[k], ldDVdagCq, rsp->projDeriv[k].data());
+		}
+}
+
+void RealSpaceProjectors::projectDeriv(const ColumnBundle& Cq, matrix* DVdagCq) const
+{	static StopWatch watch("RealSpaceProjectors::projectDeriv"); watch.start();
+	assert(&gInfo == Cq.basis->gInfo);
+	initDerivatives();
+	std::vector<complex> phase = getPhases(Cq.qnum->k);
+	complex* DVdagCqData[3];
+	for(int k=0; k<3; k++)
+	{	DVdagCq[k].init(nProjectors() * Cq.spinorLength(), Cq.nCols());
+		DVdagCqData[k] = DVdagCq[k].data();
+	}
+	threadLaunch(isGpuEnabled()?1:0, RealSpaceProjectors_projectDeriv_sub, Cq.nCols(), &Cq, this, &phase, DVdagCqData, DVdagCq[0].nRows());
+	watch.stop();
+}
+
+//--------- Real-space augmentation ---------
+
+RealSpaceAugmentation::RealSpaceAugmentation(const SpeciesInfo& sp, double rCutScale) : gInfo(sp.e->gInfo)
+{	static StopWatch watch("RealSpaceAugmentation::init"); watch.start();
+	detR = gInfo.detR;
+	
+	//Determine dimensions and radius:
+	int lMax = 0;
+	for(unsigned l=0; l<sp.VnlRadial.size(); l++)
+		if(sp.VnlRadial[l].size()) lMax=l;
+	Nlm = (2*lMax+1)*(2*lMax+1);
+	double rSupport = 0.;
+	for(const auto& Qijl: sp.Qradial)
+	{	assert(Qijl.second.rFunc);
+		rSupport = std::max(rSupport, radialExtent(*Qijl.second.rFunc));
+	}
+	double rCut = rCutScale * rSupport;
+	spheres.init(gInfo, sp.atpos, rCut);
+	TaskDivision(sp.atpos.size(), mpiWorld).myRange(atomMineStart, atomMineStop);
+	
+	//Filtered augmentation functions:
+	double qCut = maskedFilterQcut(gInfo);
+	Qfiltered.resize(sp.Qradial.size());
+	Ql.resize(sp.Qradial.size());
+	for(const auto& Qijl: sp.Qradial)
+	{	int index = Qijl.first.index;
+		Ql[index] = Qijl.first.l;
+		maskedFilter(*Qijl.second.rFunc, Ql[index], rCut, qCut, Qfiltered[index]);
+	}
+	logPrintf("Initialized real-space augmentation for species %s with rCut = %lg bohrs and %lu points per atom.\n",
+		sp.name.c_str(), rCut, spheres.nPoints()/sp.atpos.size());
+	watch.stop();
+}
+
+RealSpaceAugmentation::~RealSpaceAugmentation()
+{	for(RadialFunctionG& Q: Qfiltered) Q.free();
+}
+
+void RealSpaceAugmentation::augmentDensity_sub(size_t iStart, size_t iStop, const RealSpaceAugmentation* rsa, const complex* nAugData, int s, double* nSphere)
+{	const AtomicSpheres& spheres = rsa->spheres;
+	int nQ = rsa->Ql.size();
+	int ldnAug = nQ;
+	std::vector<double> Y(rsa->Nlm);
+	for(size_t i=iStart; i<iStop; i++)
+	{	int atom = rsa->atomMineStart + i;
+		int atomOffs = rsa->Nlm * (atom + spheres.nAtoms()*s);
+		const complex* nAugAtom = nAugData + ldnAug*atomOffs;
+		for(size_t iPoint=spheres.atomStart[atom]; iPoint<spheres.atomStart[atom+1]; iPoint++)
+		{	const vector3<>& rHat = spheres.rHat[iPoint];
+			for(int l=0, lm=0; lm<rsa->Nlm; l++)
+				for(int m=-l; m<=l; m++)
+					Y[lm++] = Ylm(l, m, rHat);
+			double nCur = 0.;
+			for(int iQ=0; iQ<nQ; iQ++)
+			{	int l = rsa->Ql[iQ];
+				double QYsum = 0.;
+				for(int lm=l*l; lm<(l+1)*(l+1); lm++)
+					QYsum += nAugAtom[iQ+ldnAug*lm].real() * Y[lm];
+				nCur += QYsum * rsa->Qfiltered[iQ](spheres.r[iPoint]);
+			}
+			nSphere[iPoint] = rsa->detR * nCur;
+		}
+	}
+}
+
+void RealSpaceAugmentation::augmentDensity(const matrix& nAug, int s, ScalarField& n) const
+{	static StopWatch watch("RealSpaceAugmentation::augmentDensity"); watch.start();
+	assert(nAug.nRows() == int(Ql.size()));
+	//Compute density on each sphere (threaded over atoms):
+	std::vector<double> nSphere(spheres.nPoints());
+	threadLaunch(augmentDensity_sub, atomMineStop-atomMineStart, this, nAug.data(), s, nSphere.data());
+	//Accumulate to grid (serially, since spheres of different atoms could overlap):
+	nullToZero(n, gInfo);
+	double* nData = n->data();
+	for(int atom=atomMineStart; atom<atomMineStop; atom++)
+		for(size_t iPoint=spheres.atomStart[atom]; iPoint<spheres.atomStart[atom+1]; iPoint++)
+			nData[spheres.index[iPoint]] += nSphere[iPoint];
+	watch.stop();
+}
+
+void RealSpaceAugmentation::augmentDensityGrad_sub(size_t iStart, size_t iStop, const RealSpaceAugmentation* rsa, const double* E_nData, int s, complex* E_nAugData)
+{	const AtomicSpheres& spheres = rsa->spheres;
+	int nQ = rsa->Ql.size();
+	int ldE_nAug = nQ;
+	std::vector<double> Y(rsa->Nlm);
+	for(size_t i=iStart; i<iStop; i++)
+	{	int atom = rsa->atomMineStart + i;
+		int atomOffs = rsa->Nlm * (atom + spheres.nAtoms()*s);
+		complex* E_nAugAtom = E_nAugData + ldE_nAug*atomOffs;
+		for(size_t iPoint=spheres.atomStart[atom]; iPoint<spheres.atomStart[atom+1]; iPoint++)
+		{	const vector3<>& rHat = spheres.rHat[iPoint];
+			for(int l=0, lm=0; lm<rsa->Nlm; l++)
+				for(int m=-l; m<=l; m++)
+					Y[lm++] = Ylm(l, m, rHat);
+			double E_nCur = rsa->detR * E_nData[spheres.index[iPoint]];
+			for(int iQ=0; iQ<nQ; iQ++)
+			{	int l = rsa->Ql[iQ];
+				double E_nQ = E_nCur * rsa->Qfiltered[iQ](spheres.r[iPoint]);
+				for(int lm=l*l; lm<(l+1)*(l+1); lm++)
+					E_nAugAtom[iQ+ldE_nAug*lm] += E_nQ * Y[lm];
+			}
+		}
+	}
+}
+
+void RealSpaceAugmentation::augmentDensityGrad(const ScalarField& E_n, int s, matrix& E_nAug) const
+{	static StopWatch watch("RealSpaceAugmentation::augmentDensityGrad"); watch.start();
+	assert(E_nAug.nRows() == int(Ql.size()));
+	threadLaunch(augmentDensityGrad_sub, atomMineStop-atomMineStart, this, E_n->data(), s, E_nAug.data());
+	watch.stop();
+}
+
+void RealSpaceAugmentation::augmentForces_sub(size_t iStart, size_t iStop, const RealSpaceAugmentation* rsa, const complex* nAugData, const double* E_nData, int s, vector3<>* forces)
+{	const AtomicSpheres& spheres = rsa->spheres;
+	const double h = 1e-4; //central-difference step [bohrs] (the filtered radial functions are smooth splines)
+	int nQ = rsa->Ql.size();
+	int ldnAug = nQ;
+	std::vector<double> Y(rsa->Nlm);
+	for(size_t i=iStart; i<iStop; i++)
+	{	int atom = rsa->atomMineStart + i;
+		int atomOffs = rsa->Nlm * (atom + spheres.nAtoms()*s);
+		const complex* nAugAtom = nAugData + ldnAug*atomOffs;
+		vector3<> forceCart;
+		for(size_t iPoint=spheres.atomStart[atom]; iPoint<spheres.atomStart[atom+1]; iPoint++)
+		{	double E_nCur = rsa->detR * E_nData[spheres.index[iPoint]];
+			vector3<> d = spheres.r[iPoint] * spheres.rHat[iPoint]; //displacement of point from atom
+			for(int k=0; k<3; k++)
+			{	double nPM[2];
+				for(int sign=-1, iPM=0; sign<=1; sign+=2, iPM++)
+				{	vector3<> dCur = d; dCur[k] += sign*h;
+					double rCur = dCur.length();
+					vector3<> rHatCur = dCur * (1./rCur);
+					for(int l=0, lm=0; lm<rsa->Nlm; l++)
+						for(int m=-l; m<=l; m++)
+							Y[lm++] = Ylm(l, m, rHatCur);
+					double nCur = 0.;
+					for(int iQ=0; iQ<nQ; iQ++)
+					{	int l = rsa->Ql[iQ];
+						double QYsum = 0.;
+						for(int lm=l*l; lm<(l+1)*(l+1); lm++)
+							QYsum += nAugAtom[iQ+ldnAug*lm].real() * Y[lm];
+						nCur += QYsum * rsa->Qfiltered[iQ](rCur);
+					}
+					nPM[iPM] = nCur;
+				}
+				forceCart[k] += E_nCur * (nPM[1]-nPM[0]) / (2.*h); //density moves with the atom: -dE/dpos = E_n . grad(n)
+			}
+		}
+		forces[atom] += rsa->gInfo.RT * forceCart;
+	}
+}
+
+void RealSpaceAugmentation::augmentForces(const matrix& nAug, const ScalarField& E_n, int s, std::vector<vector3<>>& forces) const
+{	static StopWatch watch("RealSpaceAugmentation::augmentForces"); watch.start();
+	assert(nAug.nRows() == int(Ql.size()));
+	assert(int(forces.size()) == spheres.nAtoms());
+	threadLaunch(augmentForces_sub, atomMineStop-atomMineStart, this, nAug.data(), E_n->data(), s, forces.data());
+	watch.stop();
+}
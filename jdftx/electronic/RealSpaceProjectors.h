@@ -0,0 +1,160 @@
+/*-------------------------------------------------------------------
+Copyright 2026 JDFTx contributors
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#ifndef JDFTX_ELECTRONIC_REALSPACEPROJECTORS_H
+#define JDFTX_ELECTRONIC_REALSPACEPROJECTORS_H
+
+#include <core/ScalarField.h>
+#include <core/RadialFunction.h>
+#include <core/matrix.h>
+#include <vector>
+
+class SpeciesInfo;
+class ColumnBundle;
+
+//! @addtogroup IonicSystem
+//! @{
+
+//! Grid points within a sphere around each atom of a species (unwrapped, so that each sphere is contiguous)
+struct AtomicSpheres
+{	std::vector<size_t> atomStart; //!< offset of each atom's sphere in the point arrays below (nAtoms+1 entries)
+	std::vector<int> index; //!< real-space grid index of each sphere point
+	std::vector<vector3<>> x; //!< unwrapped lattice coordinates of each sphere point
+	std::vector<double> r; //!< distance of each sphere point from its atom
+	std::vector<vector3<>> rHat; //!< unit vector from atom to each sphere point (zero at the atom)
+
+	void init(const GridInfo& gInfo, const std::vector<vector3<>>& atpos, double rCut);
+	int nAtoms() const { return atomStart.size()-1; }
+	size_t nPoints() const { return index.size(); }
+};
+
+//! Band-limit f (with angular momentum l and negligible beyond rCut) to wavevectors below qCut
+//! using the masked-function method, and return the result as a spline in real space.
+void maskedFilter(const RadialFunctionR& f, int l, double rCut, double qCut, RadialFunctionG& result);
+
+//! Radius (in wavevector) of the largest sphere inscribed in the reciprocal-space box of the grid,
+//! which avoids aliasing of masked-function filtered quantities
+double maskedFilterQcut(const GridInfo& gInfo);
+
+//! Extent of radial function f, beyond which it is negligible
+double radialExtent(const RadialFunctionR& f);
+
+/**
+Real-space representation of the nonlocal projectors of one species.
+The projectors are band-limited to the wavefunction FFT grid using the masked-function method
+(divide by a Gaussian mask, filter in reciprocal space, multiply back by the mask),
+and tabulated on a sphere of grid points around each atom. Projections then cost
+O(number of sphere points) per band per atom after one FFT per band, instead of
+a dense reciprocal-space GEMM over all basis functions.
+The rows of the projections are ordered exactly as in SpeciesInfo::getV()^Cq.
+Cartesian derivatives of the projections (for forces) are computed from the same
+filtered projectors, so that the forces are consistent with the energy.
+*/
+class RealSpaceProjectors
+{
+public:
+	//! Set up spheres on grid gInfo (that of the wavefunction basis) for the current atomic positions
+	//! and lattice of species sp, with the sphere radius set to rCutScale times the extent of the projectors
+	RealSpaceProjectors(const SpeciesInfo& sp, const GridInfo& gInfo, double rCutScale);
+	~RealSpaceProjectors();
+
+	int nProjectors() const { return nProj * spheres.nAtoms(); } //!< total number of projectors for all atoms (same as SpeciesInfo::nProjectors() for non-spinor cases)
+	double getRcut() const { return rCut; } //!< radius of the sphere around each atom
+	size_t nPoints() const { return spheres.nPoints(); } //!< total number of grid points in all the spheres
+	const GridInfo& getGrid() const { return gInfo; } //!< grid on which the spheres are defined
+
+	//! Compute projections VdagCq (resized as necessary) for each species with non-null rsp.
+	//! Species with null entries in rsp are left untouched.
+	static void project(const ColumnBundle& Cq, const std::vector<const RealSpaceProjectors*>& rsp, std::vector<matrix>& VdagCq);
+
+	//! Accumulate projected gradients HVdagCq (for each species with non-null rsp) onto HCq
+	static void projectGrad(const std::vector<const RealSpaceProjectors*>& rsp, const std::vector<matrix>& HVdagCq, ColumnBundle& HCq);
+
+	//! Compute projections of Cq onto the Cartesian derivatives of the projectors, DVdagCq[k] = D(V,k)^Cq for k=0,1,2
+	void projectDeriv(const ColumnBundle& Cq, matrix* DVdagCq) const;
+
+	std::vector<complex> getPhases(const vector3<>& k) const; //!< Bloch phases exp(2 pi i k.x) at each sphere point for k in reciprocal lattice coordinates
+
+	//! Set rows of spinor component s of column b in VdagCq (with leading dimension ldVdagCq) given the real-space wavefunction ICbs
+	//! (using the projector derivatives projData in the layout of proj instead of the projectors, if non-null)
+	void projectColumn(const complex* phase, const complex* ICbs, int b, int s, int nSpinor, complex* VdagCq, int ldVdagCq, const double* projData=0) const;
+
+	//! Accumulate column b, spinor component s of the projected gradient HVdagCq (with leading dimension ldHVdagCq) to the real-space gradient HICbs
+	void projectGradColumn(const complex* phase, const complex* HVdagCq, int ldHVdagCq, int b, int s, int nSpinor, complex* HICbs) const;
+
+private:
+	const GridInfo& gInfo; //!< wavefunction grid
+	int nProj; //!< number of projectors per atom
+	double rCut; //!< sphere radius
+	std::vector<complex> lPhase; //!< (-i)^l for each projector
+	AtomicSpheres spheres; //!< grid points around each atom
+	std::vector<std::vector<RadialFunctionG>> radial; //!< filtered radial functions in real space
+	std::vector<double> proj; //!< dV times projector at each point (for atom a: proj[nProj*spheres.atomStart[a] + iProj*nPointsAtom + iPoint])
+	mutable std::vector<double> projDeriv[3]; //!< Cartesian derivatives of proj (same layout), initialized on first use by projectDeriv
+	
+	void initDerivatives() const; //!< initialize projDeriv
+	friend void RealSpaceProjectors_projectDeriv_sub(int colStart, int colStop, const ColumnBundle* Cq, const RealSpaceProjectors* rsp, const std::vector<complex>* phase, complex** DVdagCqData, int ldDVdagCq);
+};
+
+/**
+Real-space evaluation of the ultrasoft augmentation density of one species.
+The pseudized augmentation functions Q_ij^l(r) are band-limited to the FFT grid
+using the masked-function method, and the augmentation charge of each atom is
+accumulated only on the grid points within a sphere around that atom, instead of
+on the full reciprocal-space grid for each atom. In MPI mode, the atoms are
+divided between processes (the density is summed over processes subsequently).
+Forces are computed from derivatives of the same filtered augmentation functions,
+so that they are consistent with the energy.
+*/
+class RealSpaceAugmentation
+{
+public:
+	//! Set up spheres for the current atomic positions and lattice of species sp,
+	//! with the sphere radius set to rCutScale times the extent of the augmentation functions
+	RealSpaceAugmentation(const SpeciesInfo& sp, double rCutScale);
+	~RealSpaceAugmentation();
+
+	//! Accumulate augmentation density in spin channel s to n, given the spherical-function
+	//! coefficients nAug (summed over processes) in the layout of SpeciesInfo::nAug
+	void augmentDensity(const matrix& nAug, int s, ScalarField& n) const;
+
+	//! Accumulate gradient w.r.t spherical-function coefficients E_nAug (for this process's atoms),
+	//! given gradient E_n w.r.t spin channel s of the density
+	void augmentDensityGrad(const ScalarField& E_n, int s, matrix& E_nAug) const;
+
+	//! Accumulate forces (in lattice coordinates) on this process's atoms due to the augmentation density
+	//! in spin channel s, given coefficients nAug (summed over processes) and gradient E_n w.r.t that density
+	void augmentForces(const matrix& nAug, const ScalarField& E_n, int s, std::vector<vector3<>>& forces) const;
+
+private:
+	AtomicSpheres spheres; //!< grid points around each atom
+	const GridInfo& gInfo;
+	int atomMineStart, atomMineStop; //!< range of atoms handled by this process
+	int Nlm; //!< number of (l,m) pairs in spherical-function coefficients
+	double detR; //!< unit cell volume (relating spherical-function coefficients to density)
+	std::vector<RadialFunctionG> Qfiltered; //!< filtered augmentation functions in real space, ordered by index in SpeciesInfo::Qradial
+	std::vector<int> Ql; //!< angular momentum of each augmentation function
+
+	static void augmentDensity_sub(size_t iStart, size_t iStop, const RealSpaceAugmentation* rsa, const complex* nAugData, int s, double* nSphere);
+	static void augmentDensityGrad_sub(size_t iStart, size_t iStop, const RealSpaceAugmentation* rsa, const double* E_nData, int s, complex* E_nAugData);
+	static void augmentForces_sub(size_t iStart, size_t iStop, const RealSpaceAugmentation* rsa, const complex* nAugData, const double* E_nData, int s, vector3<>* forces);
+};
+
+//! @}
+#endif // JDFTX_ELECTRONIC_REALSPACEPROJECTORS_H
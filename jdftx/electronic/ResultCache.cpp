@@ -0,0 +1,360 @@
+/*-------------------------------------------------------------------
+Copyright 2026 JDFTx contributors
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#include <electronic/ResultCache.h>
+#include <electronic/Everything.h>
+#include <electronic/SpeciesInfo.h>
+#include <electronic/ColumnBundle.h>
+#include <core/Util.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <fstream>
+#include <cfloat>
+
+const std::vector<string>& getPseudopotentialPrefixes(); //implemented in ion_species.cpp
+
+//64-bit FNV-1a hash
+struct Hasher
+{	uint64_t h;
+	Hasher(uint64_t h=14695981039346656037ULL) : h(h) {}
+	void add(const void* data, size_t nBytes)
+	{	const unsigned char* bytes = (const unsigned char*)data;
+		for(size_t i=0; i<nBytes; i++) { h ^= bytes[i]; h *= 1099511628211ULL; }
+	}
+	template<typename T> void add(const T& x) { add(&x, sizeof(T)); }
+	void add(const string& s) { add(s.size()); add(s.data(), s.size()); }
+	string hex() const { char buf[32]; sprintf(buf, "%016llx", (unsigned long long)h); return string(buf); }
+};
+
+inline long long rounded(double x) { return llround(x*1e8); }
+
+//Contents of a file as a string (empty if unreadable)
+inline string readFile(string fname)
+{	std::ifstream ifs(fname.c_str(), std::ios::binary);
+	if(!ifs.is_open()) return string();
+	ostringstream oss; oss << ifs.rdbuf();
+	return oss.str();
+}
+
+//Results stored for one geometry
+struct CacheEntry
+{	double threshold; //electronic convergence threshold used
+	Energies ener;
+	std::vector< vector3<> > pos; //lattice coordinates of all atoms (species-major)
+	bool hasForces, hasStress;
+	std::vector< vector3<> > forces; //lattice-coordinate forces of all atoms (same order as pos)
+	matrix3<> stress;
+
+	CacheEntry() : threshold(0.), hasForces(false), hasStress(false) {}
+
+	//Initialize from current state:
+	CacheEntry(const Everything& e, double threshold, bool haveForces)
+	: threshold(threshold), ener(e.ener), hasForces(haveForces), hasStress(haveForces && e.iInfo.computeStress), stress(e.iInfo.stress)
+	{	for(unsigned sp=0; sp<e.iInfo.species.size(); sp++)
+			for(unsigned atom=0; atom<e.iInfo.species[sp]->atpos.size(); atom++)
+			{	pos.push_back(e.iInfo.species[sp]->atpos[atom]);
+				if(hasForces) forces.push_back(e.iInfo.forces[sp][atom]);
+			}
+	}
+
+	string format() const
+	{	ostringstream oss; oss.precision(17); oss << std::scientific;
+		oss << "threshold " << threshold << '\n';
+		oss << "TS " << ener.TS << "\nmuN " << ener.muN << "\nEband " << ener.Eband << '\n';
+		for(const auto& c: ener.E) oss << "E " << c.first << ' ' << c.second << '\n';
+		oss << "positions " << pos.size() << '\n';
+		for(const vector3<>& x: pos) oss << x[0] << ' ' << x[1] << ' ' << x[2] << '\n';
+		oss << "forces " << forces.size() << '\n';
+		for(const vector3<>& f: forces) oss << f[0] << ' ' << f[1] << ' ' << f[2] << '\n';
+		oss << "stress " << (hasStress ? 1 : 0) << '\n';
+		if(hasStress) for(int i=0; i<3; i++) oss << stress(i,0) << ' ' << stress(i,1) << ' ' << stress(i,2) << '\n';
+		return oss.str();
+	}
+
+	bool parse(const string& contents)
+	{	istringstream iss(contents);
+		string key;
+		while(iss >> key)
+		{	if(key == "threshold") iss >> threshold;
+			else if(key == "TS") iss >> ener.TS;
+			else if(key == "muN") iss >> ener.muN;
+			else if(key == "Eband") iss >> ener.Eband;
+			else if(key == "E") { string name; double val; iss >> name >> val; ener.E[name] = val; }
+			else if(key == "positions" || key == "forces")
+			{	size_t n = 0; iss >> n;
+				std::vector< vector3<> >& v = (key == "positions") ? pos : forces;
+				v.resize(n);
+				for(vector3<>& x: v) iss >> x[0] >> x[1] >> x[2];
+				if(key == "forces") hasForces = n;
+			}
+			else if(key == "stress")
+			{	int flag = 0; iss >> flag; hasStress = flag;
+				if(hasStress) for(int i=0; i<3; i++) for(int j=0; j<3; j++) iss >> stress(i,j);
+			}
+			else return false;
+			if(iss.fail()) return false;
+		}
+		return pos.size();
+	}
+
+	//Maximum Cartesian displacement of any atom relative to the current positions (minimum image)
+	double maxDisplacement(const Everything& e) const
+	{	double dMax = 0.; unsigned i = 0;
+		for(const auto& sp: e.iInfo.species)
+			for(const vector3<>& x: sp->atpos)
+			{	if(i >= pos.size()) return DBL_MAX;
+				vector3<> dx = x - pos[i++];
+				for(int k=0; k<3; k++) dx[k] -= floor(0.5 + dx[k]);
+				dMax = std::max(dMax, (e.gInfo.R * dx).length());
+			}
+		return (i == pos.size()) ? dMax : DBL_MAX;
+	}
+};
+
+
+ResultCache::ResultCache(string dirname, double nearTolerance, bool saveState)
+: dirname(dirname), nearTolerance(nearTolerance), saveState(saveState), inputHash(0), nExact(0), nNear(0), nMiss(0)
+{
+}
+
+void ResultCache::setup(const Everything& e)
+{	logPrintf("\n---------- Setting up result cache ----------\n");
+	if(e.eVars.fluidParams.fluidType != FluidNone)
+		die("Result cache is not supported with fluids (fluid state is not cached).\n\n");
+	if(mpiWorld->isHead())
+	{	Hasher hasher;
+		//Basis and grid:
+		hasher.add(e.cntrl.Ecut);
+		hasher.add(e.cntrl.EcutRho);
+		hasher.add(e.gInfo.S);
+		//Functional:
+		hasher.add(e.exCorr.getName());
+		hasher.add(e.exCorr.exxFactor());
+		//Electrons and k-points:
+		hasher.add(e.eInfo.nElectrons);
+		hasher.add(e.eInfo.nBands);
+		hasher.add(int(e.eInfo.spinType));
+		hasher.add(int(e.eInfo.fillingsUpdate));
+		hasher.add(int(e.eInfo.smearingType));
+		hasher.add(e.eInfo.smearingWidth);
+		hasher.add(e.eInfo.mu);
+		hasher.add(e.eInfo.muLoop);
+		hasher.add(e.eInfo.Bz);
+		hasher.add(e.eInfo.Minitial); //target magnetization when constrained, and initial magnetization otherwise
+		for(const QuantumNumber& qnum: e.eInfo.qnums)
+		{	hasher.add(qnum.k);
+			hasher.add(qnum.weight);
+			hasher.add(qnum.spin);
+		}
+		//Coulomb truncation / embedding, electric field, vdW and external potentials:
+		const CoulombParams& cp = e.coulombParams;
+		hasher.add(int(cp.geometry));
+		hasher.add(cp.iDir);
+		hasher.add(cp.Rc);
+		hasher.add(cp.ionMargin);
+		hasher.add(cp.embed);
+		hasher.add(cp.embedCenter);
+		hasher.add(cp.embedFluidMode);
+		hasher.add(cp.Efield);
+		hasher.add(int(cp.exchangeRegularization));
+		hasher.add(e.iInfo.ljOverride);
+		hasher.add(e.iInfo.vdWenable);
+		hasher.add(int(e.iInfo.vdWstyle));
+		hasher.add(e.iInfo.vdWscale);
+		for(const ScalarField& V: e.eVars.Vexternal)
+			if(V) hasher.add(V->data(), sizeof(double)*V->nElem);
+		if(e.eVars.rhoExternal)
+			hasher.add(e.eVars.rhoExternal->data(), sizeof(complex)*e.eVars.rhoExternal->nElem);
+		//Species, +U and pseudopotential contents:
+		for(const auto& sp: e.iInfo.species)
+		{	hasher.add(sp->name);
+			for(const vector3<>& M: sp->initialMagneticMoments)
+				hasher.add(M);
+			for(const SpeciesInfo::PlusU& Uparams: sp->plusU)
+			{	hasher.add(Uparams.n);
+				hasher.add(Uparams.l);
+				hasher.add(Uparams.UminusJ);
+			}
+			string contents;
+			for(const string& prefix: getPseudopotentialPrefixes())
+			{	contents = readFile(prefix + sp->potfilename);
+				if(contents.length()) break;
+			}
+			hasher.add(contents);
+		}
+		inputHash = hasher.h;
+		mkdir(dirname.c_str(), 0755);
+	}
+	mpiWorld->bcast(inputHash);
+	logPrintf("Caching results in '%s' with input hash %s.\n", dirname.c_str(), Hasher(inputHash).hex().c_str());
+	if(nearTolerance > 0.)
+		logPrintf("Cached states within %lg bohrs will be used as initial guesses.\n", nearTolerance);
+}
+
+string ResultCache::entryDir(const Everything& e) const
+{	Hasher hasher(inputHash);
+	for(int i=0; i<3; i++) for(int j=0; j<3; j++)
+		hasher.add(rounded(e.gInfo.R(i,j)));
+	return dirname + "/" + hasher.hex();
+}
+
+string ResultCache::positionsHash(const Everything& e) const
+{	Hasher hasher;
+	for(const auto& sp: e.iInfo.species)
+	{	hasher.add(sp->atpos.size());
+		for(const vector3<>& x: sp->atpos)
+			for(int k=0; k<3; k++)
+			{	long long xRounded = rounded(x[k]) % 100000000LL; //wrap to [0,1) after rounding
+				if(xRounded < 0) xRounded += 100000000LL;
+				hasher.add(xRounded);
+			}
+	}
+	return hasher.hex();
+}
+
+double ResultCache::threshold(const Everything& e) const
+{	return e.cntrl.scf ? e.scfParams.energyDiffThreshold : e.elecMinParams.energyDiffThreshold;
+}
+
+bool ResultCache::loadState(Everything& e, const string& prefix) const
+{	string fnameWfns = prefix + ".wfns", fnameHaux = prefix + ".Haux";
+	bool available = false;
+	if(mpiWorld->isHead())
+		available = (fileSize(fnameWfns.c_str()) > 0)
+			&& (e.eInfo.fillingsUpdate != ElecInfo::FillingsHsub || fileSize(fnameHaux.c_str()) > 0);
+	mpiWorld->bcast(available);
+	if(!available) return false;
+	logPrintf("\nResultCache: reading wavefunctions from '%s'\n", fnameWfns.c_str()); logFlush();
+	e.eInfo.read(e.eVars.C, fnameWfns.c_str());
+	for(int q=e.eInfo.qStart; q<e.eInfo.qStop; q++)
+		e.eVars.orthonormalize(q);
+	if(e.eInfo.fillingsUpdate == ElecInfo::FillingsHsub)
+	{	e.eInfo.read(e.eVars.Haux_eigs, fnameHaux.c_str());
+		e.eVars.HauxInitialized = true;
+	}
+	e.eVars.isRandom = false;
+	return true;
+}
+
+bool ResultCache::lookup(Everything& e, bool needForces)
+{	string dir = entryDir(e);
+	string prefix = dir + "/" + positionsHash(e);
+
+	//Check for an exact hit:
+	string contents;
+	if(mpiWorld->isHead()) contents = readFile(prefix + ".results");
+	mpiWorld->bcast(contents);
+	CacheEntry entry;
+	if(contents.length() && entry.parse(contents)
+		&& entry.maxDisplacement(e) < 1e-6
+		&& entry.threshold <= threshold(e)
+		&& (entry.hasForces || !needForces)
+		&& (entry.hasStress || !(needForces && e.iInfo.computeStress)))
+	{	//Only use the hit if the electronic state can be restored (callers and output depend on it, eg. dipoles in vibrations):
+		if(loadState(e, prefix))
+		{	logPrintf("ResultCache: exact hit in '%s'; skipping electronic minimization.\n", prefix.c_str());
+			e.eVars.elecEnergyAndGrad(e.ener, 0, 0, true); //update densities, potentials and subspace Hamiltonian
+			e.ener = entry.ener;
+			if(needForces)
+			{	e.iInfo.forces.init(e.iInfo);
+				unsigned i = 0;
+				for(unsigned sp=0; sp<e.iInfo.forces.size(); sp++)
+					for(vector3<>& f: e.iInfo.forces[sp])
+						f = entry.forces[i++];
+				if(e.iInfo.computeStress) e.iInfo.stress = entry.stress;
+			}
+			nExact++;
+			return true;
+		}
+		logPrintf("\nResultCache: results in '%s' have no stored electronic state; recomputing.\n", prefix.c_str());
+	}
+
+	//Otherwise find nearest cached state:
+	if(nearTolerance > 0.)
+	{	string nearest; double dMin = nearTolerance;
+		if(mpiWorld->isHead())
+		{	DIR* dp = opendir(dir.c_str());
+			if(dp)
+			{	const string suffix = ".results";
+				while(struct dirent* entryFile = readdir(dp))
+				{	string fname = entryFile->d_name;
+					if(fname.length()<=suffix.length() || fname.compare(fname.length()-suffix.length(), suffix.length(), suffix)) continue;
+					string entryPrefix = dir + "/" + fname.substr(0, fname.length()-suffix.length());
+					CacheEntry nearEntry;
+					if(!nearEntry.parse(readFile(dir + "/" + fname))) continue;
+					if(fileSize((entryPrefix + ".wfns").c_str()) <= 0) continue; //no state stored
+					double d = nearEntry.maxDisplacement(e);
+					if(d < dMin) { dMin = d; nearest = entryPrefix; }
+				}
+				closedir(dp);
+			}
+		}
+		mpiWorld->bcast(nearest);
+		mpiWorld->bcast(dMin);
+		if(nearest.length())
+		{	logPrintf("\nResultCache: near hit (max displacement %lg bohrs); using cached state as initial guess.\n", dMin);
+			if(loadState(e, nearest))
+			{	nNear++;
+				return false;
+			}
+		}
+	}
+	nMiss++;
+	return false;
+}
+
+void ResultCache::store(const Everything& e, bool haveForces) const
+{	string dir = entryDir(e);
+	string prefix = dir + "/" + positionsHash(e);
+	//Unique suffix for temporary files (so that concurrent writers never clash):
+	string tmpSuffix;
+	if(mpiWorld->isHead())
+	{	mkdir(dir.c_str(), 0755);
+		ostringstream oss; oss << ".tmp" << getpid();
+		tmpSuffix = oss.str();
+	}
+	mpiWorld->bcast(tmpSuffix);
+
+	//Write the state first (so that a complete state is available whenever the results file is):
+	if(saveState)
+	{	e.eInfo.write(e.eVars.C, (prefix + ".wfns" + tmpSuffix).c_str());
+		if(e.eInfo.fillingsUpdate == ElecInfo::FillingsHsub)
+			e.eInfo.write(e.eVars.Haux_eigs, (prefix + ".Haux" + tmpSuffix).c_str());
+		if(mpiWorld->isHead())
+		{	rename((prefix + ".wfns" + tmpSuffix).c_str(), (prefix + ".wfns").c_str());
+			if(e.eInfo.fillingsUpdate == ElecInfo::FillingsHsub)
+				rename((prefix + ".Haux" + tmpSuffix).c_str(), (prefix + ".Haux").c_str());
+		}
+	}
+
+	//Write results:
+	if(mpiWorld->isHead())
+	{	string fname = prefix + ".results";
+		FILE* fp = fopen((fname + tmpSuffix).c_str(), "w");
+		if(!fp) { logPrintf("ResultCache: could not write '%s'.\n", fname.c_str()); return; }
+		fputs(CacheEntry(e, threshold(e), haveForces).format().c_str(), fp);
+		fclose(fp);
+		rename((fname + tmpSuffix).c_str(), fname.c_str());
+	}
+}
+
+void ResultCache::printStats() const
+{	logPrintf("ResultCache: %d exact hits, %d near hits and %d misses.\n", nExact, nNear, nMiss);
+}
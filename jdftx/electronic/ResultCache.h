@@ -0,0 +1,73 @@
+/*-------------------------------------------------------------------
+Copyright 2026 JDFTx contributors
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#ifndef JDFTX_ELECTRONIC_RESULTCACHE_H
+#define JDFTX_ELECTRONIC_RESULTCACHE_H
+
+#include <core/string.h>
+#include <stdint.h>
+
+class Everything;
+
+//! @addtogroup IonicSystem
+//! @{
+//! @file ResultCache.h Class ResultCache
+
+/**
+On-disk cache of converged results (energies, forces and stress) for repeated ionic geometries,
+shared between runs (and between process groups / images within a run) through a directory.
+Entries are stored in a subdirectory named by a hash of the electronic input (lattice vectors, cutoffs,
+grid, exchange-correlation functional, k-points, electron count, fillings and magnetization settings,
+Coulomb truncation / embedding and electric field, vdW, +U and lj-override settings, external potentials,
+and the contents of all pseudopotential files), in files named by a hash of the atomic positions
+(rounded to 1e-8 in lattice coordinates). Only results whose electronic minimization converged are stored.
+An exact hit (same positions, converged at least as tightly as currently required, with a stored
+electronic state) skips the electronic minimization and force calculation altogether. Otherwise, the converged electronic state
+of the nearest cached geometry within nearTolerance (if stored) is used as the initial guess.
+*/
+class ResultCache
+{
+public:
+	ResultCache(string dirname, double nearTolerance, bool saveState);
+	void setup(const Everything& e); //!< hash the geometry-independent part of the input
+
+	//! Look up the current ionic positions (called after IonInfo::update).
+	//! Returns true on an exact hit, in which case the electronic state, energies, IonInfo::forces (if needForces)
+	//! and IonInfo::stress (if required) have been restored; entries without a stored electronic state are
+	//! treated as misses. On a near hit, the electronic state is initialized from the cached one and false is returned.
+	bool lookup(Everything& e, bool needForces);
+	void store(const Everything& e, bool haveForces) const; //!< store results at current positions (after convergence)
+	void printStats() const; //!< print hit statistics
+
+	const string dirname; //!< top-level cache directory
+	const double nearTolerance; //!< maximum displacement of any atom [bohrs] for using a cached state as the initial guess
+	const bool saveState; //!< whether to store wavefunctions (and auxiliary Hamiltonian eigenvalues) along with results
+
+private:
+	uint64_t inputHash; //!< hash of geometry-independent input (excluding lattice vectors)
+	int nExact, nNear, nMiss; //!< hit statistics
+
+	string entryDir(const Everything& e) const; //!< subdirectory for current lattice vectors
+	string positionsHash(const Everything& e) const; //!< hash of current positions
+	double threshold(const Everything& e) const; //!< current electronic convergence threshold
+	bool loadState(Everything& e, const string& prefix) const; //!< read electronic state from files starting with prefix (if available)
+};
+
+//! @}
+#endif // JDFTX_ELECTRONIC_RESULTCACHE_H
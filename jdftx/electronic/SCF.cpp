@@ -44,6 +44,7 @@ inline ScalarFieldArray operator*(const RealKernel& K, const ScalarFieldArray& x
 SCF::SCF(Everything& e): Pulay<SCFvariable>(e.scfParams), e(e), kerkerMix(e.gInfo), diisMetric(e.gInfo)
 {	SCFparams& sp = e.scfParams;
 	mixTau = e.exCorr.needsKEdensity();
+	compact = sp.historyCompact;
 	
 	//Determine minimum Gsq (used for preconditioning):
 	double GminSq = DBL_MAX;
@@ -62,6 +63,33 @@ SCF::SCF(Everything& e): Pulay<SCFvariable>(e.scfParams), e(e), kerkerMix(e.gInf
 	applyFuncGsq(e.gInfo, setKernels, GminSq, sp.mixedVariable==SCFparams::MV_Density, sp.mixFraction,
 		pow(sp.qKerker,2), pow(sp.qMetric,2), qKappaSq, kerkerMix.data(), diisMetric.data());
 	
+	//Select G-vectors within the density sphere for the compact history:
+	if(compact)
+	{	const GridInfo& gInfo = e.gInfo;
+		double Gcut = std::max(2*gInfo.Gmax, gInfo.GmaxRho);
+		double GcutSq = Gcut ? Gcut*Gcut : DBL_MAX;
+		const vector3<int>& S = gInfo.S;
+		int S2 = S[2]/2 + 1; //inner dimension of half grid
+		const double* kerkerData = kerkerMix.data();
+		const double* metricData = diisMetric.data();
+		vector3<int> iG; int i=0;
+		for(int i0=0; i0<S[0]; i0++)
+		for(int i1=0; i1<S[1]; i1++)
+		for(int i2=0; i2<S2; i2++)
+		{	iG[0] = (2*i0>S[0]) ? i0-S[0] : i0;
+			iG[1] = (2*i1>S[1]) ? i1-S[1] : i1;
+			iG[2] = i2;
+			if(gInfo.GGT.metric_length_squared(iG) <= GcutSq)
+			{	sphereIndex.push_back(i);
+				sphereWeight.push_back((i2==0 || (2*i2==S[2])) ? 1. : 2.); //self-conjugate planes (Nyquist plane only for even S[2])
+				sphereKerker.push_back(kerkerData[i]);
+				sphereMetric.push_back(metricData[i]);
+			}
+			i++;
+		}
+		SpillArray::setMemoryLimit(size_t(sp.historyMemory * 1048576.));
+	}
+	
 	//Load history if available:
 	if(sp.historyFilename.length())
 	{	loadState(sp.historyFilename.c_str());
@@ -77,6 +105,11 @@ void SCF::minimize()
 	logPrintf("Will mix electronic %s%s at each iteration.\n",
 		(mixTau ? "and kinetic " : ""),
 		(sp.mixedVariable==SCFparams::MV_Density ? "density" : "potential"));
+	if(compact)
+	{	logPrintf("Storing history compactly in %lu of %lu G-vectors (density sphere)", sphereIndex.size(), size_t(e.gInfo.nG));
+		if(sp.historyMemory) logPrintf(", spilling beyond %lg MB to scratch files", sp.historyMemory);
+		logPrintf(".\n");
+	}
 	
 	string Elabel = e.elecMinParams.energyLabel;
 	if(!e.exCorr.hasEnergy())
@@ -103,17 +136,19 @@ void SCF::minimize()
 			die("Convergence parameter energyDiffThreshold must be > 0 in exact exchange calculations.\n");
 		e.exx->prepareHamiltonian(e.exCorr.exxRange(), e.eVars.F, e.eVars.C); logPrintf("\n");
 		double Eprev = eVars.elecEnergyAndGrad(e.ener, 0, 0, true); mpiWorld->bcast(Eprev); //Initial energy
+		bool outerConverged = false;
 		for(int iOuter=0; iOuter<e.cntrl.nOuterVxx; iOuter++)
 		{	Pulay<SCFvariable>::minimize(Eprev, extraNames, extraThresh); //Optimize using Pulay mixer
 			double E = eVars.elecEnergyAndGrad(e.ener, 0, 0, true); mpiWorld->bcast(E); //update energy
 			double dE = E - Eprev;
 			logPrintf("VxxLoop: Iter: %2i   %s: %+.15lf   d%s: %+.3e\n",
 				iOuter, sp.energyLabel, E, sp.energyLabel, dE);
-			if(fabs(dE) < outerThreshold) break;
+			if(fabs(dE) < outerThreshold) { outerConverged = true; break; }
 			//Update orbitals for next outer loop iteration:
 			e.exx->prepareHamiltonian(e.exCorr.exxRange(), e.eVars.F, e.eVars.C); logPrintf("\n");
 			Eprev = E;
 		}
+		converged = converged && outerConverged; //final inner loop and outer loop must both have converged
 	}
 	else
 	{	//Single Pulay loop:
@@ -142,6 +177,11 @@ double SCF::cycle(double dEprev, std::vector<double>& extraValues)
 	
 	//Cache required quantities:
 	std::vector<diagMatrix> eigsPrev = e.eVars.Hsub_eigs;
+	if(compact)
+	{	SCFvariable vIn = getVariableFull();
+		nIn = vIn.n;
+		tauIn = vIn.tau;
+	}
 	
 	//Band-structure minimize:
 	if(not sp.verbose) { logSuspend(); e.elecMinParams.fpLog = nullLog; } // Silence eigensolver output
@@ -178,13 +218,23 @@ void SCF::report(int iter)
 
 
 void SCF::axpy(double alpha, const SCFvariable& X, SCFvariable& Y) const
-{	//Density:
-	Y.n.resize(e.eVars.n.size());
-	::axpy(alpha, X.n, Y.n);
-	//KE density:
-	if(mixTau)
-	{	Y.tau.resize(e.eVars.n.size());
-		::axpy(alpha, X.tau, Y.tau);
+{	if(compact)
+	{	//Density and KE density:
+		if(!Y.compact.size()) { Y.compact = SpillArray(nCompact()); Y.compact.zero(); }
+		const double* Xdata = X.compact.data();
+		double* Ydata = Y.compact.data();
+		for(size_t i=0; i<Y.compact.size(); i++)
+			Ydata[i] += alpha * Xdata[i];
+	}
+	else
+	{	//Density:
+		Y.n.resize(e.eVars.n.size());
+		::axpy(alpha, X.n, Y.n);
+		//KE density:
+		if(mixTau)
+		{	Y.tau.resize(e.eVars.n.size());
+			::axpy(alpha, X.tau, Y.tau);
+		}
 	}
 	//Atomic density matrices:
 	if(e.eInfo.hasU)
@@ -196,11 +246,23 @@ void SCF::axpy(double alpha, const SCFvariable& X, SCFvariable& Y) const
 
 double SCF::dot(const SCFvariable& X, const SCFvariable& Y) const
 {	double ret = 0.;
-	//Density:
-	ret += e.gInfo.dV * ::dot(X.n, Y.n);
-	//KE density:
-	if(mixTau)
-		ret += e.gInfo.dV * ::dot(X.tau, Y.tau);
+	if(compact)
+	{	//Density and KE density:
+		const double* Xdata = X.compact.data();
+		const double* Ydata = Y.compact.data();
+		size_t nSphere = sphereIndex.size();
+		for(size_t c=0; c<X.compact.size(); c+=2*nSphere)
+			for(size_t i=0; i<nSphere; i++)
+				ret += sphereWeight[i] * (Xdata[c+2*i]*Ydata[c+2*i] + Xdata[c+2*i+1]*Ydata[c+2*i+1]);
+		ret *= e.gInfo.detR;
+	}
+	else
+	{	//Density:
+		ret += e.gInfo.dV * ::dot(X.n, Y.n);
+		//KE density:
+		if(mixTau)
+			ret += e.gInfo.dV * ::dot(X.tau, Y.tau);
+	}
 	//Atomic density matrices:
 	if(e.eInfo.hasU)
 	{	for(size_t i=0; i<X.rhoAtom.size(); i++)
@@ -233,14 +295,27 @@ void SCF::readVariable(SCFvariable& v, FILE* fp) const
 	{	e.iInfo.rhoAtom_initZero(v.rhoAtom);
 		for(matrix& m: v.rhoAtom) m.read(fp);
 	}
+	//Compress if necessary:
+	if(compact)
+	{	v.compact = compress(v.n, v.tau);
+		v.n.clear();
+		v.tau.clear();
+	}
 }
 
 void SCF::writeVariable(const SCFvariable& v, FILE* fp) const
-{	//Density:
-	for(const ScalarField& X: v.n) saveRawBinary(X, fp);
+{	//Expand if necessary (file format is always on the full grid):
+	ScalarFieldArray n = v.n, tau = v.tau;
+	if(compact)
+	{	n.resize(e.eVars.n.size());
+		if(mixTau) tau.resize(e.eVars.n.size());
+		expand(v.compact, n, tau);
+	}
+	//Density:
+	for(const ScalarField& X: n) saveRawBinary(X, fp);
 	//KE density:
 	if(mixTau)
-	{	for(const ScalarField& X: v.tau) saveRawBinary(X, fp);
+	{	for(const ScalarField& X: tau) saveRawBinary(X, fp);
 	}
 	//Atomic density matrices:
 	if(e.eInfo.hasU)
@@ -283,6 +358,67 @@ namespace Magnetization
 }
 
 SCFvariable SCF::getVariable() const
+{	SCFvariable v = getVariableFull();
+	if(compact)
+	{	v.compact = compress(v.n, v.tau);
+		v.n.clear();
+		v.tau.clear();
+	}
+	return v;
+}
+
+void SCF::setVariable(const SCFvariable& v)
+{	if(!compact) { setVariableFull(v); return; }
+	//Linearly mix components outside the sphere, starting from the full input and output of the current cycle:
+	SCFvariable vFull = getVariableFull(); //output
+	for(int iTau=0; iTau<(mixTau ? 2 : 1); iTau++)
+	{	ScalarFieldArray& xOut = iTau ? vFull.tau : vFull.n;
+		const ScalarFieldArray& xIn = iTau ? tauIn : nIn;
+		for(size_t s=0; s<xOut.size(); s++)
+		{	double mixFraction = s ? e.scfParams.mixFractionMag : e.scfParams.mixFraction;
+			xOut[s] = xIn[s] + mixFraction * (xOut[s] - xIn[s]);
+		}
+	}
+	//Replace components within the sphere by the mixed ones:
+	expand(v.compact, vFull.n, vFull.tau);
+	vFull.rhoAtom = v.rhoAtom;
+	setVariableFull(vFull);
+}
+
+size_t SCF::nCompact() const
+{	return 2 * sphereIndex.size() * e.eVars.n.size() * (mixTau ? 2 : 1);
+}
+
+SpillArray SCF::compress(const ScalarFieldArray& n, const ScalarFieldArray& tau) const
+{	SpillArray result(nCompact());
+	double* resultData = result.data();
+	for(int iTau=0; iTau<(mixTau ? 2 : 1); iTau++)
+		for(const ScalarField& x: (iTau ? tau : n))
+		{	const complex* xTildeData = J(x)->data();
+			for(int index: sphereIndex)
+			{	*(resultData++) = xTildeData[index].real();
+				*(resultData++) = xTildeData[index].imag();
+			}
+		}
+	return result;
+}
+
+void SCF::expand(const SpillArray& compact, ScalarFieldArray& n, ScalarFieldArray& tau) const
+{	const double* compactData = compact.data();
+	for(int iTau=0; iTau<(mixTau ? 2 : 1); iTau++)
+		for(ScalarField& x: (iTau ? tau : n))
+		{	ScalarFieldTilde xTilde = x ? J(x) : ScalarFieldTilde(ScalarFieldTildeData::alloc(e.gInfo));
+			if(!x) xTilde->zero();
+			complex* xTildeData = xTilde->data();
+			for(int index: sphereIndex)
+			{	xTildeData[index] = complex(compactData[0], compactData[1]);
+				compactData += 2;
+			}
+			x = I(xTilde);
+		}
+}
+
+SCFvariable SCF::getVariableFull() const
 {	bool mixDensity = (e.scfParams.mixedVariable==SCFparams::MV_Density);
 	SCFvariable v;
 	//Density:
@@ -296,7 +432,7 @@ SCFvariable SCF::getVariable() const
 	return v;
 }
 
-void SCF::setVariable(const SCFvariable& v)
+void SCF::setVariableFull(const SCFvariable& v)
 {	bool mixDensity = (e.scfParams.mixedVariable==SCFparams::MV_Density);
 	//Density:
 	(mixDensity ? e.eVars.n : e.eVars.Vscloc) = Magnetization::toSpinDensity(v.n);
@@ -314,15 +450,29 @@ void SCF::setVariable(const SCFvariable& v)
 SCFvariable SCF::precondition(const SCFvariable& v) const
 {	SCFvariable vOut;
 	double magEnhance = e.scfParams.mixFractionMag / e.scfParams.mixFraction;
-	//Density:
-	vOut.n = kerkerMix * v.n;
-	for(size_t s=1; s<vOut.n.size(); s++)
-		vOut.n[s] *= magEnhance;
-	//KE density:
-	if(mixTau)
-	{	vOut.tau = kerkerMix * v.tau;
-		for(size_t s=1; s<vOut.tau.size(); s++)
-			vOut.tau[s] *= magEnhance;
+	if(compact)
+	{	//Density and KE density:
+		vOut.compact = SpillArray(v.compact.size());
+		const double* vData = v.compact.data();
+		double* vOutData = vOut.compact.data();
+		size_t nSphere = sphereIndex.size(), nSpin = e.eVars.n.size();
+		for(size_t c=0; c<v.compact.size(); c+=2*nSphere)
+		{	double scale = ((c/(2*nSphere)) % nSpin) ? magEnhance : 1.; //magnetization components
+			for(size_t i=0; i<2*nSphere; i++)
+				vOutData[c+i] = (scale * sphereKerker[i/2]) * vData[c+i];
+		}
+	}
+	else
+	{	//Density:
+		vOut.n = kerkerMix * v.n;
+		for(size_t s=1; s<vOut.n.size(); s++)
+			vOut.n[s] *= magEnhance;
+		//KE density:
+		if(mixTau)
+		{	vOut.tau = kerkerMix * v.tau;
+			for(size_t s=1; s<vOut.tau.size(); s++)
+				vOut.tau[s] *= magEnhance;
+		}
 	}
 	//Atomic density matrices:
 	if(e.eInfo.hasU)
@@ -335,11 +485,23 @@ SCFvariable SCF::precondition(const SCFvariable& v) const
 
 SCFvariable SCF::applyMetric(const SCFvariable& v) const
 {	SCFvariable vOut;
-	//Density:
-	vOut.n = diisMetric * v.n;
-	//KE density:
-	if(mixTau)
-		vOut.tau = diisMetric * v.tau;
+	if(compact)
+	{	//Density and KE density:
+		vOut.compact = SpillArray(v.compact.size());
+		const double* vData = v.compact.data();
+		double* vOutData = vOut.compact.data();
+		size_t nSphere = sphereIndex.size();
+		for(size_t c=0; c<v.compact.size(); c+=2*nSphere)
+			for(size_t i=0; i<2*nSphere; i++)
+				vOutData[c+i] = sphereMetric[i/2] * vData[c+i];
+	}
+	else
+	{	//Density:
+		vOut.n = diisMetric * v.n;
+		//KE density:
+		if(mixTau)
+			vOut.tau = diisMetric * v.tau;
+	}
 	//Atomic density matrices:
 	if(e.eInfo.hasU)
 		vOut.rhoAtom = v.rhoAtom;
@@ -22,6 +22,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <core/Pulay.h>
 #include <core/ScalarFieldArray.h>
+#include <core/SpillArray.h>
 
 //! @addtogroup ElecSystem
 //! @{
@@ -33,6 +34,7 @@ struct SCFvariable
 {	ScalarFieldArray n; //!< electron density (or potential)
 	ScalarFieldArray tau; //!< KE density (or potential) [mGGA only]
 	std::vector<matrix> rhoAtom; //!< atomic density matrices (or corresponding potential) [DFT+U only]
+	SpillArray compact; //!< G-sphere components of n and tau, which are then left empty [SCFparams::historyCompact only]
 };
 
 //! @brief Self-Consistent Field method for converging electronic state
@@ -66,6 +68,17 @@ private:
 	bool mixTau; //!< whether KE needs to be mixed
 	RealKernel kerkerMix, diisMetric; //!< convolution kernels for kerker preconditioning and the DIIS overlap metric
 	
+	//Compact history (SCFparams::historyCompact):
+	bool compact; //!< whether n and tau are mixed as G-sphere components in SCFvariable::compact
+	std::vector<int> sphereIndex; //!< index into reciprocal-space (half) grid of each G-vector within the density sphere
+	std::vector<double> sphereWeight, sphereKerker, sphereMetric; //!< dot-product weight (accounting for Hermitian symmetry), kerkerMix and diisMetric for each G-vector in the sphere
+	ScalarFieldArray nIn, tauIn; //!< full input n and tau of the current cycle (to mix components outside the sphere)
+	size_t nCompact() const; //!< number of doubles in SCFvariable::compact
+	SpillArray compress(const ScalarFieldArray& n, const ScalarFieldArray& tau) const; //!< G-sphere components of n and tau
+	void expand(const SpillArray& compact, ScalarFieldArray& n, ScalarFieldArray& tau) const; //!< replace G-sphere components of n and tau (which may be null) from compact
+	SCFvariable getVariableFull() const; //!< getVariable() with n and tau on the full grid
+	void setVariableFull(const SCFvariable&); //!< setVariable() with n and tau on the full grid
+	
 	double eigDiffRMS(const std::vector<diagMatrix>&, const std::vector<diagMatrix>&) const; //!< weighted RMS difference between two sets of eigenvalues
 };
 
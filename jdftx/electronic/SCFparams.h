@@ -45,6 +45,8 @@ struct SCFparams : public PulayParams
 	
 	bool verbose; //!< Whether the inner eigensolver will print progress
 	double mixFractionMag;  //!< Mixing fraction for magnetization density / potential
+	bool historyCompact; //!< Whether to store and mix only the G-sphere components (within the density cutoff) of the history
+	double historyMemory; //!< Memory limit (MB per process) for the history, beyond which older entries spill to scratch files (0 = unlimited)
 	
 	SCFparams()
 	{	nEigSteps = 2; //for Davidson; the default for CG is 40 (and set by the command)
@@ -54,6 +56,8 @@ struct SCFparams : public PulayParams
 		qKappa = -1.;
 		verbose = false;
 		mixFractionMag = 1.5;
+		historyCompact = false;
+		historyMemory = 0.;
 	}
 };
 
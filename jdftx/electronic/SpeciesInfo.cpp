@@ -23,6 +23,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <electronic/Everything.h>
 #include <electronic/symbols.h>
 #include <electronic/ColumnBundle.h>
+#include <electronic/ProjectorCache.h>
 #include <fluid/Euler.h>
 #include <core/matrix.h>
 #include <core/LatticeUtils.h>
@@ -36,7 +37,9 @@ void SpeciesInfo::sync_atpos()
 	//Update managed version of atpos:
 	atposManaged = ManagedArray<vector3<>>(atpos); //it will get transferred to GPU if/when necessary
 	//Invalidate cached projectors:
-	cachedV.clear();
+	if(projectorCache) projectorCache->clear(this);
+	realSpaceProjectors = 0;
+	realSpaceAugmentation = 0;
 }
 
 inline bool isParallel(vector3<> x, vector3<> y)
@@ -119,7 +122,8 @@ SpeciesInfo::SpeciesInfo()
 }
 
 SpeciesInfo::~SpeciesInfo()
-{	if(atpos.size())
+{	if(projectorCache) projectorCache->clear(this);
+	if(atpos.size())
 	{
 		VlocRadial.free();
 		nCoreRadial.free();
@@ -251,6 +255,7 @@ void SpeciesInfo::setup(const Everything &everything)
 		}
 	}
 	
+	projectorCache = e->iInfo.projectorCache;
 	sync_atpos();
 	
 	Rprev = e->gInfo.R; //remember initial lattice vectors, so that updateLatticeDependent can check if an update is necessary
@@ -398,7 +403,9 @@ void SpeciesInfo::updateLatticeDependent()
 		nCoreRadial.updateGmax(0, nGridLoc);
 		tauCoreRadial.updateGmax(0, nGridLoc);
 		for(auto& Qijl: Qradial) Qijl.second.updateGmax(Qijl.first.l, nGridLoc);
-		cachedV.clear(); //clear any cached projectors
+		projectorCache->clear(this); //clear any cached projectors
+		realSpaceProjectors = 0;
+		realSpaceAugmentation = 0;
 	}
 	
 	//Update Qradial indices, matrix and nagIndex if not previously init'd, or if R has changed:
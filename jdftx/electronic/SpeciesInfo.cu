@@ -85,7 +85,7 @@ template<int Nlm> __global__ void nAugment_kernel(int zBlock, const vector3<int>
 	int nCoeff, double dGinv, const double* nRadial, const vector3<> atpos, complex* n)
 {	COMPUTE_halfGindices
 	if(i<iGstart || i>=iGstop) return;
-	nAugment_calc<Nlm>(i, iG, G, nCoeff, dGinv, nRadial, atpos, n);
+	nAugment_calc<Nlm>(i, iG, G, nCoeff, dGinv, nRadial, cis((-2*M_PI)*dot(atpos,iG)), n);
 }
 template<int Nlm> void nAugment_gpu(const vector3<int> S, const matrix3<>& G, int iGstart, int iGstop,
 	int nCoeff, double dGinv, const double* nRadial, const vector3<>& atpos, complex* n)
@@ -179,24 +179,26 @@ void getSG_gpu(const vector3<int> S, int nAtoms, const vector3<>* atpos, double
 __global__
 void updateLocal_kernel(int zBlock, const vector3<int> S, const matrix3<> GGT,
 	complex *Vlocps,  complex *rhoIon, complex *nChargeball, complex *nCore, complex* tauCore,
-	int nAtoms, const vector3<>* atpos, double invVol, const RadialFunctionG VlocRadial,
+	int nAtoms, const vector3<>* atpos, const vector3<>* atposOld, double invVol, const RadialFunctionG VlocRadial,
 	double Z, const RadialFunctionG nCoreRadial, const RadialFunctionG tauCoreRadial,
 	double Zchargeball, double wChargeballSq)
 {
 	COMPUTE_halfGindices
+	complex SG = getSG_calc(iG, nAtoms, atpos);
+	if(atposOld) SG -= getSG_calc(iG, nAtoms, atposOld);
 	updateLocal_calc(i, iG, GGT, Vlocps, rhoIon, nChargeball,
-		nCore, tauCore, nAtoms, atpos, invVol, VlocRadial,
+		nCore, tauCore, SG * invVol, VlocRadial,
 		Z, nCoreRadial, tauCoreRadial, Zchargeball, wChargeballSq);
 }
 void updateLocal_gpu(const vector3<int> S, const matrix3<> GGT,
 	complex *Vlocps,  complex *rhoIon, complex *nChargeball, complex *nCore, complex* tauCore,
-	int nAtoms, const vector3<>* atpos, double invVol, const RadialFunctionG& VlocRadial,
+	int nAtoms, const vector3<>* atpos, const vector3<>* atposOld, double invVol, const RadialFunctionG& VlocRadial,
 	double Z, const RadialFunctionG& nCoreRadial, const RadialFunctionG& tauCoreRadial,
 	double Zchargeball, double wChargeballSq)
 {	GpuLaunchConfigHalf3D glc(updateLocal_kernel, S);
 	for(int zBlock=0; zBlock<glc.zBlockMax; zBlock++)
 		updateLocal_kernel<<<glc.nBlocks,glc.nPerBlock>>>(zBlock, S, GGT, Vlocps, rhoIon, nChargeball,
-			nCore, tauCore, nAtoms, atpos, invVol, VlocRadial,
+			nCore, tauCore, nAtoms, atpos, atposOld, invVol, VlocRadial,
 			Z, nCoreRadial, tauCoreRadial, Zchargeball, wChargeballSq);
 	gpuErrorCheck();
 }
@@ -30,6 +30,9 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 class ColumnBundle;
 class QuantumNumber;
 class Basis;
+class RealSpaceProjectors;
+class RealSpaceAugmentation;
+class ProjectorCache;
 
 //! @addtogroup IonicSystem
 //! @{
@@ -95,6 +98,11 @@ public:
 	std::shared_ptr<ColumnBundle> getV(const ColumnBundle& Cq, const vector3<>* derivDir=0, const int stressDir=-1) const;
 	int nProjectors() const { return MnlAll.nRows() * atpos.size(); } //!< total number of projectors for all atoms in this species (number of columns in result of getV)
 	
+	//! Get real-space projectors (see Control::realSpaceProjectors) on the wavefunction grid gInfo (that of the basis),
+	//! created on demand and invalidated along with cached projectors.
+	//! Returns null for purely local pseudopotentials, or when the real-space radial projectors are unavailable.
+	const RealSpaceProjectors* getRealSpaceProjectors(const GridInfo& gInfo) const;
+	
 	//! Return non-local energy for this species and quantum number q and optionally accumulate
 	//! projected electronic gradient in HVdagCq (if non-null)
 	double EnlAndGrad(const QuantumNumber& qnum, const diagMatrix& Fq, const matrix& VdagCq, matrix& HVdagCq) const;
@@ -142,9 +150,12 @@ public:
 	int atomicOrbitalOffset(unsigned iAtom, unsigned n, int l, int m, int s) const; //!< offset of specified atomic orbital in output of current species (when not using the fixed n and l version)
 		//!< s is 0/1 for up/dn spinors in non-relativistic case, s=0/1 is for j=l+/-0.5 and mj=m+/-0.5 in relativistic case
 
-	//! Add contributions from this species to Vlocps, rhoIon, nChargeball and nCore/tauCore (if any)
-	void updateLocal(ScalarFieldTilde& Vlocps, ScalarFieldTilde& rhoIon, ScalarFieldTilde& nChargeball,
-		ScalarFieldTilde& nCore, ScalarFieldTilde& tauCore) const; 
+	//! Add contributions from this species to Vlocps, rhoIon, nChargeball and nCore/tauCore (if any).
+	//! If atposOld is non-null, only add the change in contributions of atoms that moved from atposOld
+	//! (in which case the outputs must already contain the contributions at atposOld).
+	//! Returns the number of atoms whose contributions were computed.
+	int updateLocal(ScalarFieldTilde& Vlocps, ScalarFieldTilde& rhoIon, ScalarFieldTilde& nChargeball,
+		ScalarFieldTilde& nCore, ScalarFieldTilde& tauCore, const std::vector<vector3<>>* atposOld=0) const; 
 	
 	//! Return the local forces (due to Vlocps, rhoIon, nChargeball and nCore/tauCore)
 	std::vector< vector3<> > getLocalForces(const ScalarFieldTilde& ccgrad_Vlocps, const ScalarFieldTilde& ccgrad_rhoIon,
@@ -175,7 +186,10 @@ private:
 	std::vector<matrix> Qint; //!< overlap augmentation matrix (indexed by l, empty if no augmentation)
 	matrix QintAll; //!< block matrix containing Qint for all l,m 
 	
-	std::map<std::pair<vector3<>,const Basis*>, std::shared_ptr<ColumnBundle> > cachedV; //cached projectors (identified by k-point and basis pointer)
+	std::shared_ptr<ProjectorCache> projectorCache; //shared cache of projectors (identified by species, k-point and basis pointer)
+	std::shared_ptr<RealSpaceProjectors> realSpaceProjectors; //real-space projectors (created on demand by getRealSpaceProjectors)
+	std::shared_ptr<RealSpaceAugmentation> realSpaceAugmentation; //real-space augmentation (created on demand by getRealSpaceAugmentation)
+	const RealSpaceAugmentation* getRealSpaceAugmentation() const; //null if real-space augmentation is disabled or unavailable
 	
 	struct QijIndex
 	{	int l1, p1; //!< Angular momentum and projector index for channel i
@@ -250,9 +264,13 @@ private:
 	friend class IonicMinimizer;
 	friend class IonInfo;
 	friend class PCM;
+	friend class RealSpaceProjectors;
+	friend class RealSpaceAugmentation;
 	friend class Phonon;
 	friend class VanDerWaalsD2;
 	friend class DefectSupercell;
+	friend class DFPT;
+	friend class ResultCache;
 	friend class WannierMinimizer;
 };
 
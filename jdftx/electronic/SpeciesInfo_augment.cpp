@@ -21,6 +21,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <electronic/SpeciesInfo_internal.h>
 #include <electronic/Everything.h>
 #include <electronic/ColumnBundle.h>
+#include <electronic/RealSpaceProjectors.h>
 #include <core/matrix.h>
 
 //------- additional SpeciesInfo functions for ultrasoft pseudopotentials (density and overlap augmentation) -------
@@ -172,6 +173,13 @@ void SpeciesInfo::augmentDensityGrid(ScalarFieldArray& n) const
 	const GridInfo &gInfo = e->gInfo;
 	double dGinv = 1./gInfo.dGradial;
 	matrix nAugTot = nAug; mpiWorld->allReduceData(nAugTot, MPIUtil::ReduceSum); //collect radial functions from all processes, and split by G-vectors below
+	const RealSpaceAugmentation* rsa = getRealSpaceAugmentation();
+	if(rsa) //real-space augmentation (split by atoms instead)
+	{	for(unsigned s=0; s<n.size(); s++)
+			rsa->augmentDensity(nAugTot, s, n[s]);
+		watch.stop();
+		return;
+	}
 	matrix nAugRadial = QradialMat * nAugTot; //transform from radial functions to spline coeffs
 	double* nAugRadialData = (double*)nAugRadial.dataPref();
 	for(unsigned s=0; s<n.size(); s++)
@@ -190,6 +198,21 @@ void SpeciesInfo::augmentDensityGridGrad(const ScalarFieldArray& E_n, std::vecto
 	augmentDensityGrid_COMMON_INIT
 	if(!nAug) augmentDensityInit();
 	const GridInfo &gInfo = e->gInfo;
+	const RealSpaceAugmentation* rsa = getRealSpaceAugmentation();
+	if(rsa)
+	{	assert(!Eaug_RRT); //stress not supported with real-space augmentation (excluded in IonInfo::setup)
+		E_nAug = zeroes(Qradial.size(), e->eInfo.nDensities * atpos.size() * Nlm);
+		for(unsigned s=0; s<E_n.size(); s++)
+			rsa->augmentDensityGrad(E_n[s], s, E_nAug);
+		if(forces) //forces on this process's atoms (summed over processes by caller)
+		{	matrix nAugTot = nAug; mpiWorld->allReduceData(nAugTot, MPIUtil::ReduceSum);
+			for(unsigned s=0; s<E_n.size(); s++)
+				rsa->augmentForces(nAugTot, E_n[s], s, *forces);
+		}
+		mpiWorld->allReduceData(E_nAug, MPIUtil::ReduceSum);
+		watch.stop();
+		return;
+	}
 	double dGinv = 1./gInfo.dGradial;
 	matrix E_nAugRadial = zeroes(nCoeffHlf, e->eInfo.nDensities * atpos.size() * Nlm);
 	double* E_nAugRadialData = (double*)E_nAugRadial.dataPref();
@@ -227,6 +250,16 @@ void SpeciesInfo::augmentDensityGridGrad(const ScalarFieldArray& E_n, std::vecto
 	watch.stop();
 }
 
+const RealSpaceAugmentation* SpeciesInfo::getRealSpaceAugmentation() const
+{	if(!e->cntrl.realSpaceAugmentation) return 0;
+	if(!realSpaceAugmentation)
+	{	for(const auto& Qijl: Qradial)
+			if(!Qijl.second.rFunc) return 0; //real-space augmentation functions unavailable: use reciprocal space
+		((SpeciesInfo*)this)->realSpaceAugmentation = std::make_shared<RealSpaceAugmentation>(*this, e->cntrl.realSpaceAugmentationRcut);
+	}
+	return realSpaceAugmentation.get();
+}
+
 void SpeciesInfo::augmentDensitySphericalGrad(const QuantumNumber& qnum, const matrix& VdagCq, matrix& HVdagCq) const
 {	static StopWatch watch("augmentDensitySphericalGrad"); watch.start();
 	augmentDensity_COMMON_INIT
@@ -21,6 +21,8 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <electronic/SpeciesInfo_internal.h>
 #include <electronic/Everything.h>
 #include <electronic/ColumnBundle.h>
+#include <electronic/RealSpaceProjectors.h>
+#include <electronic/ProjectorCache.h>
 #include <core/matrix.h>
 
 //------- primary SpeciesInfo functions involved in simple energy and gradient calculations (with norm-conserving pseudopotentials) -------
@@ -31,16 +33,10 @@ double SpeciesInfo::EnlAndGrad(const QuantumNumber& qnum, const diagMatrix& Fq,
 {	static StopWatch watch("EnlAndGrad"); watch.start();
 	if(!atpos.size()) return 0.; //unused species
 	if(!MnlAll) return 0.; //purely local psp
-	int nProj = MnlAll.nRows();
 	
-	matrix MVdagC = zeroes(VdagCq.nRows(), VdagCq.nCols());
-	double Enlq = 0.0;
-	for(unsigned atom=0; atom<atpos.size(); atom++)
-	{	matrix atomVdagC = VdagCq(atom*nProj,(atom+1)*nProj, 0,VdagCq.nCols());
-		matrix MatomVdagC = MnlAll * atomVdagC;
-		MVdagC.set(atom*nProj,(atom+1)*nProj, 0,VdagCq.nCols(), MatomVdagC);
-		Enlq += trace(Fq * dagger(atomVdagC) * MatomVdagC).real();
-	}
+	//Apply Mnl to all atoms in place (without extracting per-atom blocks), and only compute diagonal of energy matrix:
+	matrix MVdagC = tiledBlockMatrix(MnlAll, atpos.size()) * VdagCq;
+	double Enlq = dot(Fq, diagDot(VdagCq, MVdagC));
 	HVdagCq += MVdagC;
 	watch.stop();
 	return Enlq;
@@ -196,11 +192,27 @@ void SpeciesInfo::rhoAtom_getV(const ColumnBundle& Cq, const matrix* U_rhoAtomPt
 #undef UparamLOOP
 #undef U_rho_PACK
 
-void SpeciesInfo::updateLocal(ScalarFieldTilde& Vlocps, ScalarFieldTilde& rhoIon, ScalarFieldTilde& nChargeball,
-	ScalarFieldTilde& nCore, ScalarFieldTilde& tauCore) const
-{	if(!atpos.size()) return; //unused species
+int SpeciesInfo::updateLocal(ScalarFieldTilde& Vlocps, ScalarFieldTilde& rhoIon, ScalarFieldTilde& nChargeball,
+	ScalarFieldTilde& nCore, ScalarFieldTilde& tauCore, const std::vector<vector3<>>* atposOld) const
+{	if(!atpos.size()) return 0; //unused species
 	((SpeciesInfo*)this)->updateLatticeDependent(); //update lattice dependent quantities (if lattice vectors have changed)
 	const GridInfo& gInfo = e->gInfo;
+	
+	//Select moved atoms for incremental update:
+	ManagedArray<vector3<>> atposMovedNew, atposMovedOld;
+	if(atposOld)
+	{	assert(atposOld->size() == atpos.size());
+		std::vector<vector3<>> posNew, posOld;
+		for(size_t atom=0; atom<atpos.size(); atom++)
+			if(!(atpos[atom] == atposOld->at(atom)))
+			{	posNew.push_back(atpos[atom]);
+				posOld.push_back(atposOld->at(atom));
+			}
+		if(!posNew.size()) return 0; //no atoms of this species moved
+		atposMovedNew = ManagedArray<vector3<>>(posNew);
+		atposMovedOld = ManagedArray<vector3<>>(posOld);
+	}
+	int nAtoms = atposOld ? atposMovedNew.nData() : atpos.size();
 
 	//Prepare optional outputs:
 	complex *nChargeballData=0, *nCoreData=0, *tauCoreData=0;
@@ -212,8 +224,9 @@ void SpeciesInfo::updateLocal(ScalarFieldTilde& Vlocps, ScalarFieldTilde& rhoIon
 	double invVol = 1.0/gInfo.detR;
 	callPref(::updateLocal)(gInfo.S, gInfo.GGT,
 		Vlocps->dataPref(), rhoIon->dataPref(), nChargeballData, nCoreData, tauCoreData,
-		atpos.size(), atposManaged.dataPref(), invVol, VlocRadial,
+		nAtoms, atposOld ? atposMovedNew.dataPref() : atposManaged.dataPref(), atposOld ? atposMovedOld.dataPref() : 0, invVol, VlocRadial,
 		Z, nCoreRadial, tauCoreRadial, Z_chargeball, std::pow(width_chargeball,2));
+	return nAtoms;
 }
 
 
@@ -275,6 +288,9 @@ void SpeciesInfo::accumNonlocalForces(const ColumnBundle& Cq, const matrix& Vdag
 {
 	//Cartesian gradient of VdagC:
 	matrix DVdagC[3]; 
+	const RealSpaceProjectors* rsp = e->cntrl.realSpaceProjectors ? getRealSpaceProjectors(*(Cq.basis->gInfo)) : 0;
+	if(rsp) rsp->projectDeriv(Cq, DVdagC); //consistent with the real-space projections in VdagC
+	else
 	{	auto V = getV(Cq);
 		for(int k=0; k<3; k++)
 			DVdagC[k] = D(*V,k)^Cq;
@@ -320,14 +336,13 @@ void SpeciesInfo::accumNonlocalForces(const ColumnBundle& Cq, const matrix& Vdag
 std::shared_ptr<ColumnBundle> SpeciesInfo::getV(const ColumnBundle& Cq, const vector3<>* derivDir, const int stressDir) const
 {	const QuantumNumber& qnum = *(Cq.qnum);
 	const Basis& basis = *(Cq.basis);
-	std::pair<vector3<>,const Basis*> cacheKey = std::make_pair(qnum.k, &basis);
 	int nProj = MnlAll.nRows() / e->eInfo.spinorLength();
 	if(!nProj) return 0; //purely local psp
 	//First check cache
-	if(e->cntrl.cacheProjectors && (!derivDir) && (!stressDir))
-	{	auto iter = cachedV.find(cacheKey);
-		if(iter != cachedV.end()) //found
-			return iter->second; //return cached value
+	bool useCache = e->cntrl.cacheProjectors && (!derivDir) && (stressDir<0);
+	if(useCache)
+	{	std::shared_ptr<ColumnBundle> V = projectorCache->find(this, qnum.k, &basis);
+		if(V) return V; //return cached value
 	}
 	//No cache / not found in cache; compute:
 	std::shared_ptr<ColumnBundle> V = std::make_shared<ColumnBundle>(nProj*atpos.size(), basis.nbasis, &basis, &qnum, isGpuEnabled()); //not a spinor regardless of spin type
@@ -342,7 +357,17 @@ std::shared_ptr<ColumnBundle> SpeciesInfo::getV(const ColumnBundle& Cq, const ve
 				iProj++;
 			}
 	//Add to cache if necessary:
-	if(e->cntrl.cacheProjectors && (!derivDir) && (!stressDir))
-		((SpeciesInfo*)this)->cachedV[cacheKey] = V;
+	if(useCache) projectorCache->add(this, qnum.k, &basis, V);
 	return V;
 }
+
+const RealSpaceProjectors* SpeciesInfo::getRealSpaceProjectors(const GridInfo& gInfo) const
+{	if(!atpos.size() || !MnlAll) return 0; //unused species or purely local psp
+	if(!realSpaceProjectors || &(realSpaceProjectors->getGrid()) != &gInfo)
+	{	for(const auto& VnlRadialL: VnlRadial)
+			for(const RadialFunctionG& Vnl: VnlRadialL)
+				if(!Vnl.rFunc) return 0; //real-space radial functions unavailable: use reciprocal-space projectors
+		((SpeciesInfo*)this)->realSpaceProjectors = std::make_shared<RealSpaceProjectors>(*this, gInfo, e->cntrl.realSpaceProjectorsRcut);
+	}
+	return realSpaceProjectors.get();
+}
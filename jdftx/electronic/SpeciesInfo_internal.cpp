@@ -24,24 +24,121 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/BlasExtra.h>
 #include <algorithm>
 #include <atomic>
+#include <memory>
+
+//Separable structure factor tables:
+StructureFactorTable::StructureFactorTable(int nAtoms, const vector3<>* pos, const vector3<>& k, const vector3<int>& iGmin, const vector3<int>& iGmax)
+: nAtoms(nAtoms), iGmin(iGmin)
+{	for(int dir=0; dir<3; dir++)
+	{	int nG = iGmax[dir] - iGmin[dir] + 1;
+		tableRe[dir].resize(nG * nAtoms);
+		tableIm[dir].resize(nG * nAtoms);
+		for(int jG=0; jG<nG; jG++)
+		{	double kpGdir = k[dir] + (iGmin[dir] + jG);
+			for(int atom=0; atom<nAtoms; atom++)
+			{	complex phase = cis((-2*M_PI) * pos[atom][dir] * kpGdir);
+				tableRe[dir][jG*nAtoms+atom] = phase.real();
+				tableIm[dir][jG*nAtoms+atom] = phase.imag();
+			}
+		}
+	}
+}
+
+void StructureFactorTable::compute(const vector3<int>& iG, double* SFre, double* SFim) const
+{	vector3<size_t> offs = offsets(iG);
+	const double* re0 = tableRe[0].data()+offs[0]; const double* im0 = tableIm[0].data()+offs[0];
+	const double* re1 = tableRe[1].data()+offs[1]; const double* im1 = tableIm[1].data()+offs[1];
+	const double* re2 = tableRe[2].data()+offs[2]; const double* im2 = tableIm[2].data()+offs[2];
+	for(int atom=0; atom<nAtoms; atom++) //contiguous, branch-free loop over atoms (vectorizes)
+	{	double re01 = re0[atom]*re1[atom] - im0[atom]*im1[atom];
+		double im01 = re0[atom]*im1[atom] + im0[atom]*re1[atom];
+		SFre[atom] = re01*re2[atom] - im01*im2[atom];
+		SFim[atom] = re01*im2[atom] + im01*re2[atom];
+	}
+}
+
+complex StructureFactorTable::operator()(const vector3<int>& iG, int atom) const
+{	vector3<size_t> offs = offsets(iG);
+	complex result(1., 0.);
+	for(int dir=0; dir<3; dir++)
+		result *= complex(tableRe[dir][offs[dir]+atom], tableIm[dir][offs[dir]+atom]);
+	return result;
+}
+
+complex StructureFactorTable::sum(const vector3<int>& iG) const
+{	vector3<size_t> offs = offsets(iG);
+	const double* re0 = tableRe[0].data()+offs[0]; const double* im0 = tableIm[0].data()+offs[0];
+	const double* re1 = tableRe[1].data()+offs[1]; const double* im1 = tableIm[1].data()+offs[1];
+	const double* re2 = tableRe[2].data()+offs[2]; const double* im2 = tableIm[2].data()+offs[2];
+	double SGre = 0., SGim = 0.;
+	for(int atom=0; atom<nAtoms; atom++) //vectorized reduction over atoms
+	{	double re01 = re0[atom]*re1[atom] - im0[atom]*im1[atom];
+		double im01 = re0[atom]*im1[atom] + im0[atom]*re1[atom];
+		SGre += re01*re2[atom] - im01*im2[atom];
+		SGim += re01*im2[atom] + im01*re2[atom];
+	}
+	return complex(SGre, SGim);
+}
+
 
 //Initialize non-local projector from a radial function at a particular l,m (or its k derivatives)
+//(Structure factors of all atoms at each G are obtained from sfTable, rather than from a sincos per atom)
+template<int l, int m>
+void Vnl_sub(size_t nStart, size_t nStop, int atomStride, int nAtoms, const vector3<> k, const vector3<int>* iGarr,
+	const matrix3<> G, const vector3<>* pos, const RadialFunctionG& VnlRadial, const StructureFactorTable* sfTable,
+	const vector3<>* derivDir, const vector3<> RTdir, int iDir, int jDir, complex* V)
+{
+	std::vector<double> SFre(nAtoms), SFim(nAtoms); //structure factors of all atoms at current G
+	std::vector<double> posRTdir; //phase derivative of each atom along derivDir
+	if(derivDir)
+	{	posRTdir.resize(nAtoms);
+		for(int atom=0; atom<nAtoms; atom++)
+			posRTdir[atom] = dot(pos[atom], RTdir);
+	}
+	for(size_t n=nStart; n<nStop; n++)
+	{	const vector3<int>& iG = iGarr[n];
+		vector3<> kpG = k + iG; //k+G in reciprocal lattice coordinates
+		sfTable->compute(iG, SFre.data(), SFim.data());
+		complex* Vn = V + n;
+		if(iDir >= 0) //stress component
+		{	double prefac_ij = VnlStress_prefac<l,m>(kpG, G, VnlRadial, iDir, jDir);
+			for(int atom=0; atom<nAtoms; atom++)
+				Vn[atom*atomStride] = complex(prefac_ij*SFre[atom], prefac_ij*SFim[atom]);
+		}
+		else if(derivDir) //derivative w.r.t Cartesian k
+		{	double prefac, prefac_qDir;
+			VnlPrime_prefac<l,m>(kpG, G, VnlRadial, *derivDir, prefac, prefac_qDir);
+			for(int atom=0; atom<nAtoms; atom++) //S * (prefac_qDir - i prefac pos.RTdir)
+				Vn[atom*atomStride] = complex(SFre[atom], SFim[atom]) * complex(prefac_qDir, -prefac*posRTdir[atom]);
+		}
+		else //value
+		{	double prefac = Vnl_prefac<l,m>(kpG, G, VnlRadial);
+			for(int atom=0; atom<nAtoms; atom++)
+				Vn[atom*atomStride] = complex(prefac*SFre[atom], prefac*SFim[atom]);
+		}
+	}
+}
 template<int l, int m>
 void Vnl(int nbasis, int atomStride, int nAtoms, const vector3<> k, const vector3<int>* iGarr,
 	const matrix3<> G, const vector3<>* pos, const RadialFunctionG& VnlRadial, complex* V,
 	const vector3<>* derivDir, const int stressDir)
 {
+	int iDir = -1, jDir = -1;
 	if(stressDir >= 0) //stress component
 	{	assert(stressDir < 9);
-		int iDir = stressDir / 3;
-		int jDir = stressDir - 3*iDir;
-		threadedLoop(VnlStress_calc<l,m>, nbasis, atomStride, nAtoms, k, iGarr, G, pos, VnlRadial, iDir, jDir, V);
+		iDir = stressDir / 3;
+		jDir = stressDir - 3*iDir;
 	}
-	else if(derivDir) //derivative w.r.t Cartesian k
-	{	const vector3<> RTdir = (2*M_PI)*(*derivDir * inv(G));
-		threadedLoop(VnlPrime_calc<l,m>, nbasis, atomStride, nAtoms, k, iGarr, G, pos, VnlRadial, *derivDir, RTdir, V);
-	}
-	else threadedLoop(Vnl_calc<l,m>, nbasis, atomStride, nAtoms, k, iGarr, G, pos, VnlRadial, V);
+	const vector3<> RTdir = derivDir ? (2*M_PI)*(*derivDir * inv(G)) : vector3<>();
+	//Tabulate structure factors over the range of G-vectors in basis:
+	vector3<int> iGmin, iGmax;
+	for(int n=0; n<nbasis; n++)
+		for(int dir=0; dir<3; dir++)
+		{	iGmin[dir] = std::min(iGmin[dir], iGarr[n][dir]);
+			iGmax[dir] = std::max(iGmax[dir], iGarr[n][dir]);
+		}
+	StructureFactorTable sfTable(nAtoms, pos, k, iGmin, iGmax);
+	threadLaunch(Vnl_sub<l,m>, nbasis, atomStride, nAtoms, k, iGarr, G, pos, VnlRadial, &sfTable, derivDir, RTdir, iDir, jDir, V);
 }
 void Vnl(int nbasis, int atomStride, int nAtoms, int l, int m, const vector3<> k, const vector3<int>* iGarr,
 	const matrix3<> G, const vector3<>* pos, const RadialFunctionG& VnlRadial, complex* V,
@@ -51,15 +148,16 @@ void Vnl(int nbasis, int atomStride, int nAtoms, int l, int m, const vector3<> k
 
 //Augment electron density by spherical functions
 template<int Nlm> void nAugment_sub(size_t diStart, size_t diStop, const vector3<int> S, const matrix3<>& G, int iGstart,
-	int nCoeff, double dGinv, const double* nRadial, const vector3<>& atpos, complex* n)
+	int nCoeff, double dGinv, const double* nRadial, const StructureFactorTable* sfTable, complex* n)
 {	size_t iStart = iGstart + diStart;
 	size_t iStop = iGstart + diStop;
-	THREAD_halfGspaceLoop( (nAugment_calc<Nlm>)(i, iG, G, nCoeff, dGinv, nRadial, atpos, n); )
+	THREAD_halfGspaceLoop( (nAugment_calc<Nlm>)(i, iG, G, nCoeff, dGinv, nRadial, (*sfTable)(iG), n); )
 }
 template<int Nlm> void nAugment(const vector3<int> S, const matrix3<>& G, int iGstart, int iGstop,
 	int nCoeff, double dGinv, const double* nRadial, const vector3<>& atpos, complex* n)
 {
-	threadLaunch(nAugment_sub<Nlm>, iGstop-iGstart, S, G, iGstart, nCoeff, dGinv, nRadial, atpos, n);
+	StructureFactorTable sfTable(1, &atpos, vector3<>(), StructureFactorTable::gridMin(S), StructureFactorTable::gridMax(S));
+	threadLaunch(nAugment_sub<Nlm>, iGstop-iGstart, S, G, iGstart, nCoeff, dGinv, nRadial, &sfTable, n);
 }
 void nAugment(int Nlm, const vector3<int> S, const matrix3<>& G, int iGstart, int iGstop,
 	int nCoeff, double dGinv, const double* nRadial, const vector3<>& atpos, complex* n)
@@ -125,33 +223,37 @@ void nAugmentGrad(int Nlm, const vector3<int> S, const matrix3<>& G,
 
 //Structure factor
 void getSG_sub(size_t iStart, size_t iStop, const vector3<int> S,
-	int nAtoms, const vector3<>* atpos, double invVol, complex* SG)
-{	THREAD_halfGspaceLoop( SG[i] = invVol * getSG_calc(iG, nAtoms, atpos); )
+	const StructureFactorTable* sfTable, double invVol, complex* SG)
+{	THREAD_halfGspaceLoop( SG[i] = invVol * sfTable->sum(iG); )
 }
 void getSG(const vector3<int> S, int nAtoms, const vector3<>* atpos, double invVol, complex* SG)
-{	threadLaunch(getSG_sub, S[0]*S[1]*(S[2]/2+1), S, nAtoms, atpos, invVol, SG);
+{	StructureFactorTable sfTable(nAtoms, atpos, vector3<>(), StructureFactorTable::gridMin(S), StructureFactorTable::gridMax(S));
+	threadLaunch(getSG_sub, S[0]*S[1]*(S[2]/2+1), S, &sfTable, invVol, SG);
 }
 
 //Local pseudopotential, ionic charge, chargeball and partial cores (CPU thread and launcher)
 void updateLocal_sub(size_t iStart, size_t iStop, const vector3<int> S, const matrix3<> GGT,
 	complex *Vlocps,  complex *rhoIon, complex *nChargeball, complex *nCore, complex* tauCore,
-	int nAtoms, const vector3<>* atpos, double invVol, const RadialFunctionG& VlocRadial,
+	const StructureFactorTable* sfTable, const StructureFactorTable* sfTableOld, double invVol, const RadialFunctionG& VlocRadial,
 	double Z, const RadialFunctionG& nCoreRadial, const RadialFunctionG& tauCoreRadial,
 	double Zchargeball, double wChargeballSq)
 {	THREAD_halfGspaceLoop(
 		updateLocal_calc(i, iG, GGT,
 			Vlocps, rhoIon, nChargeball, nCore, tauCore,
-			nAtoms, atpos, invVol, VlocRadial,
+			(sfTableOld ? sfTable->sum(iG) - sfTableOld->sum(iG) : sfTable->sum(iG)) * invVol, VlocRadial,
 			Z, nCoreRadial, tauCoreRadial, Zchargeball, wChargeballSq); )
 }
 void updateLocal(const vector3<int> S, const matrix3<> GGT,
 	complex *Vlocps,  complex *rhoIon, complex *nChargeball, complex *nCore, complex* tauCore,
-	int nAtoms, const vector3<>* atpos, double invVol, const RadialFunctionG& VlocRadial,
+	int nAtoms, const vector3<>* atpos, const vector3<>* atposOld, double invVol, const RadialFunctionG& VlocRadial,
 	double Z, const RadialFunctionG& nCoreRadial, const RadialFunctionG& tauCoreRadial,
 	double Zchargeball, double wChargeballSq)
-{	threadLaunch(updateLocal_sub, S[0]*S[1]*(S[2]/2+1), S, GGT,
+{	StructureFactorTable sfTable(nAtoms, atpos, vector3<>(), StructureFactorTable::gridMin(S), StructureFactorTable::gridMax(S));
+	std::shared_ptr<StructureFactorTable> sfTableOld;
+	if(atposOld) sfTableOld = std::make_shared<StructureFactorTable>(nAtoms, atposOld, vector3<>(), StructureFactorTable::gridMin(S), StructureFactorTable::gridMax(S));
+	threadLaunch(updateLocal_sub, S[0]*S[1]*(S[2]/2+1), S, GGT,
 		Vlocps, rhoIon, nChargeball, nCore, tauCore,
-		nAtoms, atpos, invVol, VlocRadial,
+		&sfTable, sfTableOld.get(), invVol, VlocRadial,
 		Z, nCoreRadial, tauCoreRadial, Zchargeball, wChargeballSq);
 }
 
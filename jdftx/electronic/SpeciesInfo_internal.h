@@ -29,29 +29,32 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/RadialFunction.h>
 #include <core/SphericalHarmonics.h>
 #include <stdint.h>
+#include <vector>
 
+//! Radial and angular prefactor of Vnl at specific l and m for wavevector kpG = k+G (in reciprocal lattice coordinates)
+template<int l, int m> __hostanddev__
+double Vnl_prefac(const vector3<>& kpG, const matrix3<>& G, const RadialFunctionG& VnlRadial)
+{	vector3<> qvec = kpG * G; //k+G in cartesian coordinates
+	double q = qvec.length();
+	vector3<> qhat = qvec * (q ? 1.0/q : 0.0); //the unit vector along qvec (set qhat to 0 for q=0 (doesn't matter))
+	return Ylm<l,m>(qhat) * VnlRadial(q); //prefactor to structure factor
+}
 //! Compute Vnl at specific l and m for several atomic positions
 template<int l, int m> __hostanddev__
 void Vnl_calc(int n, int atomStride, int nAtoms, const vector3<>& k, const vector3<int>* iGarr,
 	const matrix3<>& G, const vector3<>* pos, const RadialFunctionG& VnlRadial, complex* Vnl)
 {
 	vector3<> kpG = k + iGarr[n]; //k+G in reciprocal lattice coordinates:
-	vector3<> qvec = kpG * G; //k+G in cartesian coordinates
-	double q = qvec.length();
-	vector3<> qhat = qvec * (q ? 1.0/q : 0.0); //the unit vector along qvec (set qhat to 0 for q=0 (doesn't matter))
-	double prefac = Ylm<l,m>(qhat) * VnlRadial(q); //prefactor to structure factor
+	double prefac = Vnl_prefac<l,m>(kpG, G, VnlRadial);
 	//Loop over columns (multiple atoms at same l,m):
 	for(int atom=0; atom<nAtoms; atom++)
 		Vnl[atom*atomStride+n] = prefac * cis((-2*M_PI)*dot(pos[atom],kpG));
 }
-//! Derivative of Vnl with respect to cartesian direction dir
+//! Prefactors of Vnl and its derivative along Cartesian direction dir at specific l and m for wavevector kpG
 template<int l, int m> __hostanddev__
-void VnlPrime_calc(int n, int atomStride, int nAtoms, const vector3<>& k, const vector3<int>* iGarr,
-	const matrix3<>& G, const vector3<>* pos, const RadialFunctionG& VnlRadial,
-	const vector3<>& dir, const vector3<>& RTdir, complex* Vprime)
-{
-	vector3<> kpG = k + iGarr[n]; //k+G in reciprocal lattice coordinates:
-	vector3<> qvec = kpG * G; //k+G in cartesian coordinates
+void VnlPrime_prefac(const vector3<>& kpG, const matrix3<>& G, const RadialFunctionG& VnlRadial,
+	const vector3<>& dir, double& prefac, double& prefac_qDir)
+{	vector3<> qvec = kpG * G; //k+G in cartesian coordinates
 	double q = qvec.length();
 	double qInv = (q ? 1.0/q : 0.0); //regularized 1/q
 	vector3<> qhat = qvec * qInv; //unit vector || qvec (set to 0 for q=0 (doesn't matter))
@@ -62,7 +65,18 @@ void VnlPrime_calc(int n, int atomStride, int nAtoms, const vector3<>& k, const
 	//Radial function and its derivative:
 	double Vradial = VnlRadial(q);
 	double Vradial_qDir = VnlRadial.deriv(q) * qhatDir;
-	double prefac = Y*Vradial, prefac_qDir = Y_qDir*Vradial + Y*Vradial_qDir;
+	prefac = Y*Vradial;
+	prefac_qDir = Y_qDir*Vradial + Y*Vradial_qDir;
+}
+//! Derivative of Vnl with respect to cartesian direction dir
+template<int l, int m> __hostanddev__
+void VnlPrime_calc(int n, int atomStride, int nAtoms, const vector3<>& k, const vector3<int>* iGarr,
+	const matrix3<>& G, const vector3<>* pos, const RadialFunctionG& VnlRadial,
+	const vector3<>& dir, const vector3<>& RTdir, complex* Vprime)
+{
+	vector3<> kpG = k + iGarr[n]; //k+G in reciprocal lattice coordinates:
+	double prefac, prefac_qDir;
+	VnlPrime_prefac<l,m>(kpG, G, VnlRadial, dir, prefac, prefac_qDir);
 	//Loop over columns (multiple atoms at same l,m):
 	for(int atom=0; atom<nAtoms; atom++)
 	{	complex S = cis((-2*M_PI)*dot(pos[atom],kpG));
@@ -70,14 +84,10 @@ void VnlPrime_calc(int n, int atomStride, int nAtoms, const vector3<>& k, const
 		Vprime[atom*atomStride+n] = prefac_qDir*S + prefac*S_qDir;
 	}
 }
-//! Derivative of Vnl with respect to lattice vectors (V_RRT) for specified iDir,jDir Cartesian components
+//! Prefactor of the (iDir,jDir) component of the lattice derivative of Vnl at specific l and m for wavevector kpG
 template<int l, int m> __hostanddev__
-void VnlStress_calc(int n, int atomStride, int nAtoms, const vector3<>& k, const vector3<int>* iGarr,
-	const matrix3<>& G, const vector3<>* pos, const RadialFunctionG& VnlRadial,
-	int iDir, int jDir, complex* V_RRT_ij)
-{
-	vector3<> kpG = k + iGarr[n]; //k+G in reciprocal lattice coordinates:
-	vector3<> qvec = kpG * G; //k+G in cartesian coordinates
+double VnlStress_prefac(const vector3<>& kpG, const matrix3<>& G, const RadialFunctionG& VnlRadial, int iDir, int jDir)
+{	vector3<> qvec = kpG * G; //k+G in cartesian coordinates
 	double q = qvec.length();
 	double qInv = (q ? 1.0/q : 0.0); //regularized 1/q
 	vector3<> qhat = qvec * qInv; //unit vector || qvec (set to 0 for q=0 (doesn't matter))
@@ -86,11 +96,57 @@ void VnlStress_calc(int n, int atomStride, int nAtoms, const vector3<>& k, const
 	double Vradial = VnlRadial(q), VradialPrime = VnlRadial.deriv(q);
 	//q-gradient of Vradial * Y:
 	double VYprime_j = Vradial*Yprime[jDir]*qInv + qhat[jDir] * (VradialPrime*Y - Vradial*qInv*dot(Yprime, qhat));
-	double prefac_ij = -qvec[iDir] * VYprime_j; //for ij component of stress tensor
+	return -qvec[iDir] * VYprime_j; //for ij component of stress tensor
+}
+//! Derivative of Vnl with respect to lattice vectors (V_RRT) for specified iDir,jDir Cartesian components
+template<int l, int m> __hostanddev__
+void VnlStress_calc(int n, int atomStride, int nAtoms, const vector3<>& k, const vector3<int>* iGarr,
+	const matrix3<>& G, const vector3<>* pos, const RadialFunctionG& VnlRadial,
+	int iDir, int jDir, complex* V_RRT_ij)
+{
+	vector3<> kpG = k + iGarr[n]; //k+G in reciprocal lattice coordinates:
+	double prefac_ij = VnlStress_prefac<l,m>(kpG, G, VnlRadial, iDir, jDir);
 	//Loop over columns (multiple atoms at same l,m):
 	for(int atom=0; atom<nAtoms; atom++)
 		V_RRT_ij[atom*atomStride+n] = prefac_ij * cis((-2*M_PI)*dot(pos[atom],kpG));
 }
+
+//! Separable structure factors e^{-2 pi i pos.(k+G)} = prod_j e^{-2 pi i pos_j (k_j+G_j)}, with the
+//! per-dimension factors tabulated once per atom, so that each (atom,G) pair costs two complex
+//! multiplies instead of a sincos. The tables store real and imaginary parts separately with atoms
+//! contiguous, so that compute() and sum() vectorize over atoms. (CPU only: GPU kernels use cis directly.)
+class StructureFactorTable
+{
+public:
+	//! Tabulate phases for nAtoms positions pos (lattice coordinates) at k-point k, for iGmin <= iG <= iGmax
+	StructureFactorTable(int nAtoms, const vector3<>* pos, const vector3<>& k, const vector3<int>& iGmin, const vector3<int>& iGmax);
+	
+	//! Set SFre and SFim (each of length nAtoms) to the real and imaginary parts of the structure factor of each atom at iG
+	void compute(const vector3<int>& iG, double* SFre, double* SFim) const;
+	
+	//! Structure factor of one atom at iG
+	complex operator()(const vector3<int>& iG, int atom=0) const;
+	
+	//! Total structure factor summed over atoms at iG
+	complex sum(const vector3<int>& iG) const;
+	
+	//! Table range that covers the symmetry-reduced or full G-space of a grid of sample counts S
+	static vector3<int> gridMin(const vector3<int>& S) { return vector3<int>(-(S[0]/2), -(S[1]/2), -(S[2]/2)); }
+	static vector3<int> gridMax(const vector3<int>& S) { return vector3<int>(S[0]/2, S[1]/2, S[2]/2); }
+	
+private:
+	int nAtoms;
+	vector3<int> iGmin;
+	std::vector<double> tableRe[3], tableIm[3]; //!< tabulated phases at index (iG[dir]-iGmin[dir])*nAtoms + atom
+	
+	//! Pointer offsets into the tables for iG
+	inline vector3<size_t> offsets(const vector3<int>& iG) const
+	{	vector3<size_t> offs;
+		for(int dir=0; dir<3; dir++) offs[dir] = size_t(iG[dir]-iGmin[dir]) * nAtoms;
+		return offs;
+	}
+};
+
 //! Driver routine for calculating Vnl for all basis functions
 //! If derivDir is non-null, then calculate derivative with respect to Cartesian k oprojected along *derivDir
 //! If stressDir is >=0, then calculate (i,j) component of dVnl/dR . RT where stressDir = 3*i+j
@@ -160,11 +216,11 @@ struct nAugmentFunctor
 };
 template<int Nlm> __hostanddev__
 void nAugment_calc(int i, const vector3<int>& iG, const matrix3<>& G,
-	int nCoeff, double dGinv, const double* nRadial, const vector3<>& atpos, complex* n)
+	int nCoeff, double dGinv, const double* nRadial, const complex& SG, complex* n)
 {
 	nAugmentFunctor functor(iG*G, nCoeff, dGinv, nRadial);
 	staticLoopYlm<Nlm>(&functor);
-	n[i] += functor.n * cis((-2*M_PI)*dot(atpos,iG));
+	n[i] += functor.n * SG; //SG = cis(-2 pi atpos.iG) is the structure factor of the atom
 }
 void nAugment(int Nlm,
 	const vector3<int> S, const matrix3<>& G, int iGstart, int iGstop,
@@ -279,17 +335,15 @@ void getSG_gpu(const vector3<int> S, int nAtoms, const vector3<>* atpos, double
 #endif
 
 //! Calculate local pseudopotential, ionic density and chargeball due to one species at a given G-vector
+//! (SGinvVol is the structure factor of this species at iG, scaled by 1/detR)
 __hostanddev__ void updateLocal_calc(int i, const vector3<int>& iG, const matrix3<>& GGT,
 	complex *Vlocps, complex *rhoIon, complex *nChargeball, complex* nCore, complex* tauCore,
-	int nAtoms, const vector3<>* atpos, double invVol, const RadialFunctionG& VlocRadial,
+	const complex& SGinvVol, const RadialFunctionG& VlocRadial,
 	double Z, const RadialFunctionG& nCoreRadial, const RadialFunctionG& tauCoreRadial,
 	double Zchargeball, double wChargeballSq)
 {
 	double Gsq = GGT.metric_length_squared(iG);
 
-	//Compute structure factor (scaled by 1/detR):
-	complex SGinvVol = getSG_calc(iG, nAtoms, atpos) * invVol;
-
 	//Short-ranged part of Local potential (long-ranged part added on later in IonInfo.cpp):
 	Vlocps[i] += SGinvVol * VlocRadial(sqrt(Gsq));
 
@@ -304,15 +358,17 @@ __hostanddev__ void updateLocal_calc(int i, const vector3<int>& iG, const matrix
 	if(nCore) nCore[i] += SGinvVol * nCoreRadial(sqrt(Gsq));
 	if(tauCore) tauCore[i] += SGinvVol * tauCoreRadial(sqrt(Gsq));
 }
+//! Driver for updateLocal_calc: if atposOld is non-null, accumulate only the change in the contributions
+//! of nAtoms atoms that moved from atposOld to atpos (used for incremental updates in IonInfo::update)
 void updateLocal(const vector3<int> S, const matrix3<> GGT,
 	complex *Vlocps,  complex *rhoIon, complex *n_chargeball, complex* n_core, complex* tauCore,
-	int nAtoms, const vector3<>* atpos, double invVol, const RadialFunctionG& VlocRadial,
+	int nAtoms, const vector3<>* atpos, const vector3<>* atposOld, double invVol, const RadialFunctionG& VlocRadial,
 	double Z, const RadialFunctionG& nCoreRadial, const RadialFunctionG& tauCoreRadial,
 	double Zchargeball, double wChargeballSq);
 #ifdef GPU_ENABLED
 void updateLocal_gpu(const vector3<int> S, const matrix3<> GGT,
 	complex *Vlocps,  complex *rhoIon, complex *n_chargeball, complex* n_core, complex* tauCore,
-	int nAtoms, const vector3<>* atpos, double invVol, const RadialFunctionG& VlocRadial,
+	int nAtoms, const vector3<>* atpos, const vector3<>* atposOld, double invVol, const RadialFunctionG& VlocRadial,
 	double Z, const RadialFunctionG& nCoreRadial, const RadialFunctionG& tauCoreRadial,
 	double Zchargeball, double wChargeballSq);
 #endif
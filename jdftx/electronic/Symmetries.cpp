@@ -27,6 +27,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/LatticeUtils.h>
 #include <core/GridInfo.h>
 #include <core/Thread.h>
+#include <core/BlasExtra_internal.h>
 #include <fluid/Euler.h>
 
 static const int lMaxSpherical = 3;
@@ -202,6 +203,91 @@ void Symmetries::symmetrize(std::vector<complexScalarFieldTilde>& x) const
 	}
 }
 
+//Symmetrize orbits iStart to iStop (each pointing to an equivalence class in symmIndex) of all components in x:
+void reduceSymmetrize_sub(size_t iStart, size_t iStop, const int* orbitClass, int nSym, const int* symmIndex, const int* symmMult,
+	const complex* phase, const matrix3<>* rotSpin, const std::vector<complex*>* x)
+{	for(size_t iOrbit=iStart; iOrbit<iStop; iOrbit++)
+	{	int c = orbitClass[iOrbit];
+		if(x->size()==4) //vector-spin: components symmetrized together
+			eblas_symmetrize_phase_rot_calc(c, nSym, symmIndex, symmMult, phase, rotSpin, complexPtr4(*x));
+		else
+			for(complex* xj: *x)
+				eblas_symmetrize_phase_calc(c, nSym, symmIndex, symmMult, phase, xj);
+	}
+}
+
+void Symmetries::reduceSymmetrize(ScalarFieldArray& x) const
+{	for(ScalarField& x_s: x) nullToZero(x_s, e->gInfo);
+	int nProcs = mpiWorld->nProcesses();
+	if(sym.size()==1 || nProcs==1 || isGpuEnabled()) //no symmetrization, nothing to distribute, or data on GPU
+	{	for(ScalarField& x_s: x) x_s->allReduceData(mpiWorld, MPIUtil::ReduceSum);
+		symmetrize(x);
+		return;
+	}
+	static StopWatch watch("reduceSymmetrize"); watch.start();
+	//Divide orbits over processes, balancing the number of G-vectors:
+	int iProc = mpiWorld->iProcess();
+	size_t nOrbitPoints = orbitIndex.size();
+	std::vector<int> procStart(nProcs+1); //first orbit of each process
+	for(int p=0; p<=nProcs; p++)
+		procStart[p] = std::lower_bound(orbitStart.begin(), orbitStart.end(), int((nOrbitPoints*p)/nProcs)) - orbitStart.begin();
+	size_t blockSize = 0; //G-vectors per process in the packed buffers (padded to the maximum)
+	for(int p=0; p<nProcs; p++)
+		blockSize = std::max(blockSize, size_t(orbitStart[procStart[p+1]] - orbitStart[procStart[p]]));
+	int kStart = orbitStart[procStart[iProc]], kStop = orbitStart[procStart[iProc+1]]; //own range in orbitIndex
+	
+	//Transform and pack partial sums by orbit, and start their reduce-scatter:
+	int nComponents = x.size();
+	std::vector<complexScalarFieldTilde> xTilde(nComponents);
+	std::vector<complex*> xData(nComponents);
+	std::vector<std::vector<complex>> buf(nComponents, std::vector<complex>(blockSize*nProcs)); //packed data of all processes
+	std::vector<std::vector<complex>> bufMine(nComponents, std::vector<complex>(blockSize)); //reduced data of own orbits
+	std::vector<MPIUtil::Request> requests(nComponents);
+	for(int j=0; j<nComponents; j++)
+	{	xTilde[j] = J(Complex(x[j]));
+		xData[j] = xTilde[j]->data();
+		for(int p=0; p<nProcs; p++)
+		{	complex* out = buf[j].data() + p*blockSize;
+			for(int k=orbitStart[procStart[p]]; k<orbitStart[procStart[p+1]]; k++)
+				*(out++) = xData[j][orbitIndex[k]];
+		}
+		mpiWorld->reduceScatter(buf[j].data(), bufMine[j].data(), blockSize, MPIUtil::ReduceSum, &requests[j]);
+	}
+	mpiWorld->waitAll(requests);
+	
+	//Symmetrize own orbits (in place in the full grids, which are otherwise only partial sums):
+	for(int j=0; j<nComponents; j++)
+	{	const complex* in = bufMine[j].data();
+		for(int k=kStart; k<kStop; k++)
+			xData[j][orbitIndex[k]] = *(in++);
+	}
+	int nSym = sym.size();
+	threadLaunch(reduceSymmetrize_sub, procStart[iProc+1]-procStart[iProc], orbitClass.data()+procStart[iProc], nSym,
+		symmIndex.data(), symmMult.data(), symmIndexPhase.data(), symmRotSpin.data(), &xData);
+	
+	//Gather symmetrized orbits from all processes:
+	for(int j=0; j<nComponents; j++)
+	{	complex* out = buf[j].data() + iProc*blockSize;
+		for(int k=kStart; k<kStop; k++)
+			*(out++) = xData[j][orbitIndex[k]];
+		mpiWorld->allGather(buf[j].data(), blockSize, &requests[j]);
+	}
+	
+	//Unpack orbits and their conjugates (x is real), and transform back:
+	for(int j=0; j<nComponents; j++)
+	{	MPIUtil::wait(requests[j]);
+		for(int p=0; p<nProcs; p++)
+		{	const complex* in = buf[j].data() + p*blockSize;
+			for(int k=orbitStart[procStart[p]]; k<orbitStart[procStart[p+1]]; k++)
+			{	complex xk = *(in++);
+				xData[j][orbitIndex[k]] = xk;
+				xData[j][orbitIndexConj[k]] = xk.conj();
+			}
+		}
+		x[j] = Real(I(xTilde[j]));
+	}
+	watch.stop();
+}
 
 //Symmetrize forces:
 void Symmetries::symmetrize(IonicGradient& f) const
@@ -518,6 +604,33 @@ void Symmetries::initSymmIndex()
 			}
 		)
 	}
+	//Select one orbit of each pair related by G -> -G, for reduceSymmetrize:
+	{	const vector3<int>& S = gInfo.S;
+		int nSym = sym.size(), nClasses = symmMultVec.size();
+		std::vector<int> classOf(gInfo.nr);
+		for(int c=0; c<nClasses; c++)
+			for(int j=0; j<nSym; j++)
+				classOf[symmIndexVec[c*nSym+j]] = c;
+		auto conjIndex = [&](int i) //full-grid index of -G, given that of G
+		{	vector3<int> iG(i/(S[1]*S[2]), (i/S[2])%S[1], i%S[2]);
+			for(int k=0; k<3; k++) iG[k] = positiveRemainder(-iG[k], S[k]);
+			return gInfo.fullRindex(iG);
+		};
+		orbitClass.clear();
+		orbitStart.assign(1, 0);
+		orbitIndex.clear();
+		orbitIndexConj.clear();
+		for(int c=0; c<nClasses; c++)
+		{	if(classOf[conjIndex(symmIndexVec[c*nSym])] < c) continue; //conjugate orbit already included
+			std::set<int> orbit(symmIndexVec.begin()+c*nSym, symmIndexVec.begin()+(c+1)*nSym);
+			orbitClass.push_back(c);
+			for(int i: orbit)
+			{	orbitIndex.push_back(i);
+				orbitIndexConj.push_back(conjIndex(i));
+			}
+			orbitStart.push_back(orbitIndex.size());
+		}
+	}
 	//Initialize Cartesian rotation matrices:
 	std::vector<matrix3<>> symmRotSpinVec(sym.size());
 	for(unsigned iRot=0; iRot<sym.size(); iRot++)
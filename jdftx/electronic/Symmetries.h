@@ -51,6 +51,14 @@ public:
 	void symmetrize(ScalarFieldArray&) const; //!< symmetrize an array of scalar fields in real space representing spin density / potentials
 	void symmetrize(ScalarFieldTildeArray&) const; //!< symmetrize an array of scalar fields in reciprocal space representing spin density / potentials
 	void symmetrize(std::vector<complexScalarFieldTilde>&) const; //!< symmetrize an array of complex scalar fields in reciprocal space representing spin density / potentials
+	
+	//! Sum partial spin densities / potentials x over mpiWorld and symmetrize them (equivalent to allReduce of each component followed by symmetrize).
+	//! The symmetry orbits in G-space are partitioned over processes: the partial sums are reduce-scattered so that each process receives
+	//! and symmetrizes only its own orbits, and the symmetrized orbits are then all-gathered. Only one orbit of each pair related by
+	//! G -> -G is communicated (the other follows from the reality of x), so that the communication volume equals that of an allReduce
+	//! in real space, while the symmetrization is no longer repeated on every process. Communication of each component is non-blocking,
+	//! and overlaps the Fourier transforms and packing of the other components.
+	void reduceSymmetrize(ScalarFieldArray& x) const;
 	void symmetrize(struct IonicGradient&) const; //!< symmetrize forces
 	void symmetrize(matrix3<>&) const; //!< symmetrize a tensor in Cartesian coordinates
 	void symmetrizeSpherical(matrix&, const class SpeciesInfo* specie) const; //!< symmetrize matrices in Ylm basis per atom of species sp (accounting for atom maps)
@@ -92,6 +100,11 @@ private:
 	IndexArray symmMult; //multiplicity (how many times each element is repeated) in each equivalence class
 	ManagedArray<complex> symmIndexPhase; //phase factor for entry at each index
 	ManagedArray<matrix3<>> symmRotSpin; //nSym Cartesian (pseudo-vector) rotation matrices for spin-density symmetrization
+	//Orbits used by reduceSymmetrize (one of each pair of orbits related by G -> -G):
+	std::vector<int> orbitClass; //equivalence class (in symmIndex) of each orbit
+	std::vector<int> orbitStart; //start of each orbit in orbitIndex (with an extra entry for the end)
+	std::vector<int> orbitIndex; //distinct G-space indices in each orbit
+	std::vector<int> orbitIndexConj; //G-space index of -G for each entry of orbitIndex
 	void initSymmIndex();
 	
 	//Atom maps:
@@ -19,12 +19,14 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <electronic/Vibrations.h>
 #include <electronic/IonicMinimizer.h>
+#include <electronic/ProcessGroupScope.h>
+#include <electronic/DFPT.h>
 #include <electronic/Everything.h>
 #include <core/LatticeUtils.h>
 #include <core/Units.h>
 
 Vibrations::Vibrations() : dr(0.01), centralDiff(false), useConstraints(false),
-translationSym(true), rotationSym(false), omegaMin(2e-4), T(298*Kelvin), omegaResolution(1e-4)
+translationSym(true), rotationSym(false), omegaMin(2e-4), T(298*Kelvin), omegaResolution(1e-4), processGroups(false), dfpt(false)
 {
 }
 
@@ -36,6 +38,7 @@ void Vibrations::setup(Everything* e)
 		translationSym = false;
 		rotationSym = false;
 	}
+	if(dfpt) DFPT::checkCompatibility(*e);
 }
 
 inline void setPtest(size_t iStart, size_t iStop, const vector3<int>& S, std::vector<double*> Ptest, vector3<> split)
@@ -160,12 +163,14 @@ void Vibrations::calculate()
 	threadLaunch(setPtest, e->gInfo.nr, e->gInfo.S, Ptest.data(), getSplit());
 
 	//Get forces in unperturbed configuration
-	int nConfigurations = 1 + nPrimary * (centralDiff ? 2 : 1);
+	bool useGroups = processGroups && ProcessGroupScope::available(*e); //whether to distribute perturbations over process groups
+	int nGroups = useGroups ? mpiGroup->procDivision.nGroups : 1;
+	int nConfigurations = 1 + ceildiv(nPrimary, nGroups) * ((centralDiff && !dfpt) ? 2 : 1); //per group (progress reported for group 0)
 	int iConfiguration = 0;
 	IonicMinimizer imin(*e);
 	IonicGradient grad0;
 	imin.compute(&grad0, 0);
-	vector3<> Pel0 = getPel(); //electronic dipole moment
+	vector3<> Pel0 = getPel(e->eVars.get_nTot()); //electronic dipole moment
 	logPrintf("Completed %d of %d configurations.\n", ++iConfiguration, nConfigurations);
 	
 	//Compute force matrix:
@@ -174,29 +179,49 @@ void Vibrations::calculate()
 	{	diagMatrix mult(nModes, 0.); //multiplicity in entries due to symmetrization
 		IonicGradient dPrev; dPrev.init(e->iInfo); //previous displacement (initially zero)
 		complex *Kdata = K.data(), *dPdata = dP.data();
+		std::shared_ptr<ProcessGroupScope> groups;
+		if(useGroups)
+		{	logPrintf("Distributing %d perturbations over %d process groups (progress reported for group 0).\n", nPrimary, nGroups);
+			groups = std::make_shared<ProcessGroupScope>(*e); //each group starts from the unperturbed wavefunctions
+		}
+		std::shared_ptr<DFPT> dfptSolver;
+		if(dfpt)
+		{	logPrintf("Computing force matrix using linear response (DFPT).\n");
+			dfptSolver = std::make_shared<DFPT>(*e);
+		}
+		int iPrimary = 0;
 		for(const Mode& mode: modes) if(mode.isPrimary) //Loop over modes in irredicuble wedge
-		{	//Create ionic gradient object corresponding to mode:
+		{	if(groups && !groups->isMine(iPrimary++)) continue; //handled by another group
+			//Create ionic gradient object corresponding to mode:
 			IonicGradient d; d.init(e->iInfo);
 			d[mode.s][mode.a] = mode.n; //all others zero
-			//Compute forces at perturbed position:
-			IonicGradient gradPlus, gradMinus, Kcur;
-			imin.step(d-dPrev, dr); dPrev=d;
-			imin.compute(&gradPlus, 0);
-			vector3<> PelPlus = getPel(), PelMinus, dPcur; //electronic dipole moment and derivative w.r.t mode
-			logPrintf("Completed %d of %d configurations.\n", ++iConfiguration, nConfigurations);
-	
-			if(centralDiff)
-			{	d *= -1;
-				imin.step(d-dPrev, dr); dPrev=d;
-				imin.compute(&gradMinus, 0);
-				PelMinus = getPel();
+			IonicGradient Kcur; vector3<> dPcur; //force matrix column and electronic dipole derivative w.r.t mode
+			if(dfptSolver) //Linear response:
+			{	ScalarFieldArray dn;
+				Kcur = dfptSolver->gradDerivative(mode.s, mode.a, mode.n, dn);
+				dPcur = getPel(dn.size()==1 ? dn[0] : dn[0]+dn[1]);
 				logPrintf("Completed %d of %d configurations.\n", ++iConfiguration, nConfigurations);
-				Kcur = (gradPlus - gradMinus) * (0.5/dr);
-				dPcur = (PelPlus - PelMinus) * (0.5/dr);
 			}
-			else
-			{	Kcur = (gradPlus - grad0) * (1./dr);
-				dPcur = (PelPlus - Pel0) * (1./dr);
+			else //Compute forces at perturbed position(s):
+			{	IonicGradient gradPlus, gradMinus;
+				imin.step(d-dPrev, dr); dPrev=d;
+				imin.compute(&gradPlus, 0);
+				vector3<> PelPlus = getPel(e->eVars.get_nTot()), PelMinus; //electronic dipole moments
+				logPrintf("Completed %d of %d configurations.\n", ++iConfiguration, nConfigurations);
+	
+				if(centralDiff)
+				{	d *= -1;
+					imin.step(d-dPrev, dr); dPrev=d;
+					imin.compute(&gradMinus, 0);
+					PelMinus = getPel(e->eVars.get_nTot());
+					logPrintf("Completed %d of %d configurations.\n", ++iConfiguration, nConfigurations);
+					Kcur = (gradPlus - gradMinus) * (0.5/dr);
+					dPcur = (PelPlus - PelMinus) * (0.5/dr);
+				}
+				else
+				{	Kcur = (gradPlus - grad0) * (1./dr);
+					dPcur = (PelPlus - Pel0) * (1./dr);
+				}
 			}
 			dPcur -= species[mode.s]->Z * mode.n; //ionic contribution to dipole derivative
 			
@@ -227,6 +252,16 @@ void Vibrations::calculate()
 		}
 		IonicGradient d; d.init(e->iInfo); //all zeroes
 		imin.step(d-dPrev, dr); dPrev=d; //Restore original ionic positions
+		dfptSolver.reset();
+		
+		//Collect contributions from all groups:
+		if(groups)
+		{	groups.reset(); //restores mpiWorld and the state of group 0 on all processes
+			if(mpiGroup->iProcess()) { K.zero(); dP.zero(); mult.assign(nModes, 0.); } //count each group once
+			mpiWorld->allReduceData(K, MPIUtil::ReduceSum);
+			mpiWorld->allReduceData(dP, MPIUtil::ReduceSum);
+			mpiWorld->allReduceData(mult, MPIUtil::ReduceSum);
+		}
 		
 		//Invert multiplicity matrixZero out  modes to be set by translational symmetry:
 		for(int i=0; i<nModes; i++)
@@ -440,9 +475,9 @@ IonicGradient Vibrations::getCMcoords() const
 	return r;
 }
 
-vector3<> Vibrations::getPel() const
+vector3<> Vibrations::getPel(const ScalarField& nTot) const
 {	vector3<> Pel;
 	for(int k=0; k<3; k++)
-		Pel[k] = e->gInfo.dV * dot(Ptest[k], e->eVars.get_nTot());
+		Pel[k] = e->gInfo.dV * dot(Ptest[k], nTot);
 	return e->gInfo.R * Pel; //convert to Cartesian coordinates
 }
@@ -39,6 +39,8 @@ public:
 	double omegaMin; //!< frequency cutoff for free energy calculation and detailed mode print out
 	double T; //!< ionic temperature used for entropy and free energy estimation
 	double omegaResolution; //!< frequency resolution used for identifying and reporting degeneracies
+	bool processGroups; //!< whether to distribute perturbed configurations over process groups
+	bool dfpt; //!< whether to compute the force matrix using linear response (DFPT) instead of finite differences
 	
 	Vibrations();
 	void setup(Everything* e);
@@ -49,7 +51,7 @@ private:
 	vector3<> getSplit() const; //get optimum latttice coordinates for splitting periodicity in a molecular geometry
 	struct IonicGradient getCMcoords() const; //get cartesian coordinates of all atoms relative to molecule center of mass
 	VectorField Ptest; //vector field that measures dipole moment in lattice coordinates
-	vector3<> getPel() const; //get electronic dipole moment at current state in cartesian coordinates
+	vector3<> getPel(const ScalarField& nTot) const; //get electronic dipole moment of electron density nTot in cartesian coordinates
 };
 
 //! @}
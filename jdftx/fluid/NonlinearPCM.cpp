@@ -22,6 +22,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <fluid/LinearPCM.h>
 #include <fluid/PCM_internal.h>
 #include <core/ScalarFieldIO.h>
+#include <core/ScalarFieldExpr.h>
 #include <core/Util.h>
 
 //Utility functions to extract/set the members of a MuEps
@@ -158,9 +159,9 @@ void NonlinearPCM::set_internal(const ScalarFieldTilde& rhoExplicitTilde, const
 		else initZero(mu, gInfo); //initialization logic does not work well with hard sphere limit
 		//eps:
 		VectorField eps = (-pMol/fsp.T) * I(gradient(linearPCM->state));
-		ScalarField E = sqrt(eps[0]*eps[0] + eps[1]*eps[1] + eps[2]*eps[2]);
-		ScalarField Ecomb = 0.5*((dielectricEval->alpha-3.) + E);
-		ScalarField epsByE = inv(E) * (Ecomb + sqrt(Ecomb*Ecomb + 3.*E));
+		ScalarField E = sqrt(lazy(eps[0])*eps[0] + lazy(eps[1])*eps[1] + lazy(eps[2])*eps[2]);
+		auto Ecomb = 0.5*((dielectricEval->alpha-3.) + lazy(E));
+		ScalarField epsByE = inv(lazy(E)) * (Ecomb + sqrt(Ecomb*Ecomb + 3.*E));
 		eps *= epsByE; //enhancement due to correlations
 		//collect:
 		setMuEps(state, mu, clone(mu), eps);
@@ -19,6 +19,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <electronic/Everything.h>
 #include <core/ScalarFieldIO.h>
+#include <core/ScalarFieldExpr.h>
 #include <core/VectorField.h>
 #include <core/SphericalHarmonics.h>
 #include <fluid/SaLSA.h>
@@ -226,7 +227,7 @@ void SaLSA::set_internal(const ScalarFieldTilde& rhoExplicitTilde, const ScalarF
 		siteShape[iSite] = I(Sf[iSite] * J(shape[0]));
 	
 	//Update the inhomogeneity factor of the preconditioner
-	epsInv = inv(1. + (epsBulk-1.)*shape[0]);
+	epsInv = inv(1. + (epsBulk-1.)*lazy(shape[0]));
 	
 	//Initialize the state if it hasn't been loaded:
 	if(!state) nullToZero(state, gInfo);
@@ -25,28 +25,28 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <electronic/LatticeMinimizer.h>
 #include <electronic/Vibrations.h>
 #include <electronic/IonicDynamics.h>
+#include <electronic/NEB.h>
+#include <electronic/ResultCache.h>
 #include <fluid/FluidSolver.h>
 #include <core/Util.h>
 #include <commands/parser.h>
 
-//Program entry point
-int main(int argc, char** argv)
-{	//Parse command line, initialize system and logs:
-	Everything e; //the parent data structure for, well, everything
-	InitParams ip("Performs Joint Density Functional Theory calculations.", &e);
-	initSystemCmdline(argc, argv, ip);
-	
-	//Parse input file and setup
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+//Run the calculation specified by input using e (on the current mpiWorld)
+void runCalculation(Everything& e, const std::vector< std::pair<string,string> >& input, const InitParams& ip)
+{	//Parse input file and setup
 	ElecVars& eVars = e.eVars;
-	parse(readInputFile(ip.inputFilename), e, ip.printDefaults);
+	parse(input, e, ip.printDefaults);
 	if(ip.dryRun) eVars.skipWfnsInit = true;
 	e.setup();
 	e.dump(DumpFreq_Init, 0);
 	Citations::print();
 	if(ip.dryRun)
 	{	logPrintf("Dry run successful: commands are valid and initialization succeeded.\n");
-		finalizeSystem();
-		return 0;
+		return;
 	}
 	else logPrintf("Initialization completed successfully at t[s]: %9.2lf\n\n", clock_sec());
 	logFlush();
@@ -73,7 +73,8 @@ int main(int argc, char** argv)
 			die("Fixed Hamiltonian calculations with EXX require occupied wavefunctions to be read in (use initial-state or wavefunction commands).\n");
 		e.iInfo.augmentDensityGridGrad(eVars.Vscloc); //update Vscloc atom projections for ultrasoft psp's 
 		logPrintf("\n----------- Band structure minimization -------------\n"); logFlush();
-		bandMinimize(e); // Do the band-structure minimization
+		if(e.cntrl.bandBatchSize) bandMinimizeBatched(e); // Band-structure minimization streamed in batches of states
+		else bandMinimize(e); // Do the band-structure minimization
 		//Update fillings if necessary:
 		if(e.eInfo.fillingsUpdate == ElecInfo::FillingsHsub)
 		{	//Calculate mu from nElectrons:
@@ -94,6 +95,11 @@ int main(int argc, char** argv)
 		IonicDynamics idyn(e);
 		idyn.run();
 	}
+	else if(e.nebParams.nImages)
+	{	//Nudged elastic band (images evaluated concurrently in process groups)
+		NEB neb(e, input);
+		neb.minimize(e.ionicMinParams);
+	}
 	else if(e.latticeMinParams.nIterations)
 	{	//Lattice minimization loop (which invokes the ionic minimization loop)
 		LatticeMinimizer lmin(e);
@@ -107,6 +113,147 @@ int main(int argc, char** argv)
 
 	//Final dump:
 	e.dump(DumpFreq_End, 0);
+	e.iInfo.projectorCache->printStats();
+	if(e.resultCache) e.resultCache->printStats();
+}
+
+//Claim a task of the farm by atomically creating its claim file (returns false if already claimed by another group)
+inline bool claimTask(const string& farmDir, int iTask)
+{	ostringstream oss; oss << farmDir << '/' << iTask << ".claim";
+	int fd = open(oss.str().c_str(), O_CREAT | O_EXCL | O_WRONLY, 0644);
+	if(fd < 0) return false;
+	close(fd);
+	return true;
+}
+
+inline string farmMarker(const string& farmDir, int iTask, const char* suffix)
+{	ostringstream oss; oss << farmDir << '/' << iTask << suffix;
+	return oss.str();
+}
+
+//Task-farm mode: run each input file listed in ip.farmManifest within one of the process groups (-G).
+//Each group works through its own contiguous block of the manifest (so that similar consecutive tasks
+//share FFT plans and other per-process state), and then steals unclaimed tasks from the other blocks.
+//Tasks are claimed using exclusively-created files in <manifest>.farm/, which also record completed tasks
+//so that an interrupted farm may be resubmitted and only runs the remaining tasks.
+void runFarm(const InitParams& ip)
+{	//Read manifest (one input file per line; blank lines and comments starting with # are ignored):
+	std::vector<string> taskInputs;
+	if(mpiWorld->isHead())
+	{	ifstream ifs(ip.farmManifest.c_str());
+		if(!ifs.is_open()) die_alone("Could not open farm manifest '%s' for reading.\n", ip.farmManifest.c_str());
+		string line;
+		while(getline(ifs, line))
+		{	istringstream iss(line);
+			string fname; iss >> fname;
+			if(fname.length() && fname[0]!='#') taskInputs.push_back(fname);
+		}
+	}
+	int nTasks = taskInputs.size();
+	mpiWorld->bcast(nTasks);
+	taskInputs.resize(nTasks);
+	for(string& fname: taskInputs) mpiWorld->bcast(fname);
+	
+	//Prepare claim directory, removing stale claims of tasks that did not complete:
+	string farmDir = ip.farmManifest + ".farm";
+	if(mpiWorld->isHead())
+	{	mkdir(farmDir.c_str(), 0755);
+		for(int iTask=0; iTask<nTasks; iTask++)
+			if(fileSize(farmMarker(farmDir, iTask, ".done").c_str()) < 0)
+				unlink(farmMarker(farmDir, iTask, ".claim").c_str());
+	}
+	mpiWorld->bcast(nTasks); //sync before any claims
+	
+	//Run tasks within each group, with the group appearing as a standalone run (single group) to each task:
+	int nGroups = mpiGroup->procDivision.nGroups, iGroup = mpiGroup->procDivision.iGroup;
+	logPrintf("\n---------- Task farm: %d tasks from '%s' over %d process groups ----------\n", nTasks, ip.farmManifest.c_str(), nGroups);
+	logFlush();
+	std::vector<double> taskTime(nTasks, 0.), taskGroup(nTasks, 0.);
+	MPIUtil* mpiWorldSaved = mpiWorld;
+	MPIUtil* mpiGroupSaved = mpiGroup;
+	MPIUtil* mpiGroupHeadSaved = mpiGroupHead;
+	mpiWorld = mpiGroup = new MPIUtil(0,0, MPIUtil::ProcDivision(mpiGroupSaved, 1));
+	mpiGroupHead = new MPIUtil(0,0, MPIUtil::ProcDivision(mpiGroupSaved, 0, mpiGroupSaved->iProcess()));
+	FILE* globalLogSaved = globalLog;
+	string inputBasenameSaved = inputBasename;
+	int iTaskStart = (nTasks * iGroup) / nGroups; //start of own block
+	for(int jTask=0; jTask<nTasks; jTask++)
+	{	int iTask = (iTaskStart + jTask) % nTasks;
+		//Claim task on group head and share with group:
+		bool claimed = false;
+		if(mpiWorld->isHead())
+			claimed = (fileSize(farmMarker(farmDir, iTask, ".done").c_str()) < 0) && claimTask(farmDir, iTask);
+		mpiWorld->bcast(claimed);
+		if(!claimed) continue;
+		if(globalLogSaved != nullLog)
+		{	fprintf(globalLogSaved, "Task %d (%s) started on group %d at t[s]: %9.2lf\n", iTask, taskInputs[iTask].c_str(), iGroup, clock_sec());
+			fflush(globalLogSaved);
+		}
+		//Separate log named after input file:
+		const string& inputFilename = taskInputs[iTask];
+		setInputBasename(inputFilename);
+		if(mpiWorld->isHead())
+		{	size_t lastDot = inputFilename.find_last_of(".");
+			size_t lastSlash = inputFilename.find_last_of("\\/");
+			string logFilename = ((lastDot!=string::npos && (lastSlash==string::npos || lastDot>lastSlash))
+				? inputFilename.substr(0, lastDot) : inputFilename) + ".out";
+			globalLog = fopen(logFilename.c_str(), "w");
+			if(!globalLog)
+			{	globalLog = globalLogSaved;
+				die_alone("Could not open log file '%s' for task %d.\n", logFilename.c_str(), iTask);
+			}
+		}
+		//Run:
+		double tStart = clock_sec();
+		{	Everything e;
+			runCalculation(e, readInputFile(inputFilename), ip);
+		}
+		taskTime[iTask] = clock_sec() - tStart;
+		taskGroup[iTask] = iGroup;
+		logPrintf("Task completed in %.2lf s.\n", taskTime[iTask]);
+		//Restore log and mark task as done:
+		if(mpiWorld->isHead())
+		{	fclose(globalLog);
+			FILE* fp = fopen(farmMarker(farmDir, iTask, ".done").c_str(), "w");
+			if(fp) fclose(fp);
+		}
+		globalLog = globalLogSaved;
+	}
+	inputBasename = inputBasenameSaved;
+	delete mpiGroupHead;
+	delete mpiGroup;
+	mpiWorld = mpiWorldSaved;
+	mpiGroup = mpiGroupSaved;
+	mpiGroupHead = mpiGroupHeadSaved;
+	
+	//Summary (contributed by group heads alone):
+	if(!mpiGroup->isHead())
+	{	std::fill(taskTime.begin(), taskTime.end(), 0.);
+		std::fill(taskGroup.begin(), taskGroup.end(), 0.);
+	}
+	mpiWorld->allReduceData(taskTime, MPIUtil::ReduceSum);
+	mpiWorld->allReduceData(taskGroup, MPIUtil::ReduceSum);
+	logPrintf("\n# Task farm summary: task, group, time [s] (time 0 => completed in an earlier run)\n");
+	std::vector<double> groupTime(nGroups, 0.);
+	for(int iTask=0; iTask<nTasks; iTask++)
+	{	logPrintf("FarmTask %5d %4d %10.2lf  %s\n", iTask, int(taskGroup[iTask]), taskTime[iTask], taskInputs[iTask].c_str());
+		groupTime[int(taskGroup[iTask])] += taskTime[iTask];
+	}
+	double tMax = 0., tSum = 0.;
+	for(double t: groupTime) { tMax = std::max(tMax, t); tSum += t; }
+	if(tMax > 0.) logPrintf("Farm load balance (mean / max group busy time): %.3lf\n", tSum/(nGroups*tMax));
+}
+
+//Program entry point
+int main(int argc, char** argv)
+{	//Parse command line, initialize system and logs:
+	Everything e; //the parent data structure for, well, everything
+	InitParams ip("Performs Joint Density Functional Theory calculations.", &e);
+	ip.allowFarm = true;
+	initSystemCmdline(argc, argv, ip);
+	
+	if(ip.farmManifest.length()) runFarm(ip);
+	else runCalculation(e, readInputFile(ip.inputFilename), ip);
 	
 	finalizeSystem();
 	return 0;
@@ -20,37 +20,59 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <phonon/Phonon.h>
 #include <core/Units.h>
 #include <core/WignerSeitz.h>
+#include <electronic/ProcessGroupScope.h>
+#include <electronic/DFPT.h>
 
 void Phonon::dump()
-{	//Zero force matrix and electron-phonon matrix elements:
+{	//Run pending supercell calculations concurrently over process groups, and then collect all results below:
+	if(farmPerturbations && !dryRun)
+	{	runPerturbationsGrouped();
+		collectPerturbations = true;
+	}
+	
+	//Zero force matrix and electron-phonon matrix elements:
 	IonicGradient zeroForce; zeroForce.init(eSupTemplate.iInfo);
 	dgrad.assign(modes.size(), zeroForce);
 	dHsub.assign(modes.size(), std::vector<matrix>(nSpins));
 	
-	//Accumulate contributions to force matrix and electron-phonon matrix elements for each irreducible perturbation:
-	unsigned iPertStart = (iPerturbation>=0) ? iPerturbation : 0;
-	unsigned iPertStop  = (iPerturbation>=0) ? iPerturbation+1 : perturbations.size();
-	std::vector<int> nStatesPert(perturbations.size());
-	for(unsigned iPert=iPertStart; iPert<iPertStop; iPert++)
-	{	logPrintf("########### Perturbed supercell calculation %u of %d #############\n", iPert+1, int(perturbations.size()));
-		ostringstream oss; oss << "phonon." << iPert+1 << ".$@#!"; //placeholder for $VAR
-		string fnamePattern = e.dump.getFilename(oss.str()); //(because dump variable name cannot contain $VAR)
-		fnamePattern.replace(fnamePattern.find("$@#!"), 4, "$VAR"); //replace placeholder with $VAR
-		processPerturbation(perturbations[iPert], fnamePattern);
-		nStatesPert[iPert] = eSup->eInfo.nStates;
-		logPrintf("\n"); logFlush();
+	if(dfpt)
+	{	//Linear-response force matrix at Gamma (supercell is the unit cell; see setup):
+		if(dryRun)
+		{	logPrintf("Dry run: %d modes to compute using linear response (DFPT).\n", int(modes.size()));
+			return;
+		}
+		logPrintf("########### Linear-response (DFPT) force matrix #############\n");
+		DFPT dfptSolver(e);
+		for(size_t iMode=0; iMode<modes.size(); iMode++)
+		{	ScalarFieldArray dn;
+			dgrad[iMode] = dfptSolver.gradDerivative(modes[iMode].sp, modes[iMode].at, modes[iMode].dir, dn);
+			logPrintf("Completed mode %d of %d.\n", int(iMode+1), int(modes.size())); logFlush();
+		}
+		logPrintf("\n");
 	}
-	if(dryRun)
-	{	logPrintf("\nParameter summary for supercell calculations:\n");
+	else
+	{	//Accumulate contributions to force matrix and electron-phonon matrix elements for each irreducible perturbation:
+		unsigned iPertStart = (iPerturbation>=0) ? iPerturbation : 0;
+		unsigned iPertStop  = (iPerturbation>=0) ? iPerturbation+1 : perturbations.size();
+		std::vector<int> nStatesPert(perturbations.size());
 		for(unsigned iPert=iPertStart; iPert<iPertStop; iPert++)
-			logPrintf("\tPerturbation: %u  nStates: %d\n", iPert+1, nStatesPert[iPert]);
-		logPrintf("Use option iPerturbation of command phonon to run each supercell calculation separately.\n");
-		return;
-	}
-	if(iPerturbation>=0)
-	{	logPrintf("Completed supercell calculation for iPerturbation %d.\n", iPerturbation+1);
-		logPrintf("After completing all supercells, rerun with option collectPerturbations in command phonon.\n");
-		return;
+		{	logPrintf("########### Perturbed supercell calculation %u of %d #############\n", iPert+1, int(perturbations.size()));
+			processPerturbation(perturbations[iPert], perturbationFilePattern(iPert));
+			nStatesPert[iPert] = eSup->eInfo.nStates;
+			logPrintf("\n"); logFlush();
+		}
+		if(dryRun)
+		{	logPrintf("\nParameter summary for supercell calculations:\n");
+			for(unsigned iPert=iPertStart; iPert<iPertStop; iPert++)
+				logPrintf("\tPerturbation: %u  nStates: %d\n", iPert+1, nStatesPert[iPert]);
+			logPrintf("Use option iPerturbation of command phonon to run each supercell calculation separately.\n");
+			return;
+		}
+		if(iPerturbation>=0)
+		{	logPrintf("Completed supercell calculation for iPerturbation %d.\n", iPerturbation+1);
+			logPrintf("After completing all supercells, rerun with option collectPerturbations in command phonon.\n");
+			return;
+		}
 	}
 	
 	//Process force matrix:
@@ -224,6 +246,84 @@ void Phonon::dump()
 	logPrintf("\n");
 }
 
+string Phonon::perturbationFilePattern(int iPert) const
+{	ostringstream oss; oss << "phonon." << iPert+1 << ".$@#!"; //placeholder for $VAR
+	string fnamePattern = e.dump.getFilename(oss.str()); //(because dump variable name cannot contain $VAR)
+	fnamePattern.replace(fnamePattern.find("$@#!"), 4, "$VAR"); //replace placeholder with $VAR
+	return fnamePattern;
+}
+
+bool Phonon::perturbationDone(int iPert) const
+{	string fname = perturbationFilePattern(iPert);
+	fname.replace(fname.find("$VAR"), 4, "dforces");
+	size_t nAtomsSup = 0;
+	for(const auto& sp: eSupTemplate.iInfo.species)
+		nAtomsSup += sp->atpos.size();
+	int done = (fileSize(fname.c_str()) == off_t(3*sizeof(double)*nAtomsSup)); //dforces is written last, so complete size implies completed perturbation
+	mpiWorld->bcast(done);
+	return done;
+}
+
+void Phonon::runPerturbationsGrouped()
+{	//Find perturbations without saved results:
+	std::vector<int> pending;
+	for(int iPert=0; iPert<int(perturbations.size()); iPert++)
+		if(!perturbationDone(iPert))
+			pending.push_back(iPert);
+	logPrintf("\n%d of %d supercell calculations previously completed.\n", int(perturbations.size()-pending.size()), int(perturbations.size()));
+	if(!pending.size()) return;
+	
+	//Estimate relative costs: number of supercell states is inversely proportional to the stabilizer group of the perturbation
+	const auto& atomMap = eSupTemplate.symm.getAtomMap();
+	std::vector<double> cost(perturbations.size());
+	for(int iPert: pending)
+	{	const Perturbation& pert = perturbations[iPert];
+		int nStab = 0;
+		for(unsigned iSym=0; iSym<symSupCart.size(); iSym++)
+			if(atomMap[pert.sp][pert.at][iSym]==pert.at && (pert.dir - symSupCart[iSym]*pert.dir).length_squared() < symmThresholdSq)
+				nStab++;
+		cost[iPert] = 1./std::max(nStab, 1);
+	}
+	std::stable_sort(pending.begin(), pending.end(), [&cost](int i1, int i2) { return cost[i1] > cost[i2]; });
+	
+	//Assign each perturbation (in decreasing order of cost) to the least loaded group:
+	int nGroups = mpiGroup->procDivision.nGroups;
+	int iGroup = mpiGroup->procDivision.iGroup;
+	std::vector<double> groupCost(nGroups, 0.);
+	std::vector<std::vector<int>> groupPerts(nGroups);
+	for(int iPert: pending)
+	{	int g = std::min_element(groupCost.begin(), groupCost.end()) - groupCost.begin();
+		groupCost[g] += cost[iPert];
+		groupPerts[g].push_back(iPert);
+	}
+	logPrintf("Distributing %d supercell calculations over %d process groups (output shown for group 0):\n", int(pending.size()), nGroups);
+	for(int g=0; g<nGroups; g++)
+	{	logPrintf("\tGroup %d (relative cost %.2lf): perturbations", g, groupCost[g]/groupCost[0]);
+		for(int iPert: groupPerts[g]) logPrintf(" %d", iPert+1);
+		logPrintf("\n");
+	}
+	logFlush();
+	
+	//Run supercell calculations of this group:
+	{	ProcessGroupScope groupScope; //supercells are set up and solved within each group
+		for(int iPert: groupPerts[iGroup])
+		{	logPrintf("########### Perturbed supercell calculation %d of %d #############\n", iPert+1, int(perturbations.size()));
+			iPerturbation = iPert; //only compute and save results (accumulated when collected subsequently)
+			processPerturbation(perturbations[iPert], perturbationFilePattern(iPert));
+			logPrintf("\n"); logFlush();
+		}
+		iPerturbation = -1;
+		eSup = 0; //cleanup supercell, which is tied to the group communicator
+	}
+	
+	//Wait for all groups, and check results:
+	int nPending = pending.size();
+	mpiWorld->allReduce(nPending, MPIUtil::ReduceMax); //synchronization point
+	for(int iPert: pending)
+		if(!perturbationDone(iPert))
+			die("Results of supercell calculation for perturbation %d not found.\n", iPert+1);
+}
+
 vector3<int> Phonon::getCell(int unit) const
 {	vector3<int> cell;
 	cell[2] = unit % sup[2]; unit /= sup[2];
@@ -62,7 +62,9 @@ public:
 	
 	int iPerturbation; //!< if >=0, only run one supercell calculation
 	bool collectPerturbations; //!< if true, collect results of previously computed perturbations (skips supercell SCF/Minimize)
+	bool farmPerturbations; //!< if true, distribute pending supercell calculations over process groups and then collect all results
 	bool saveHsub; //!< whether to compute / output electron-phonon matrix elements
+	bool dfpt; //!< if true, compute the Gamma-point force matrix using linear response (DFPT) in the unit cell (requires supercell 1 1 1)
 	
 	Phonon();
 	void setup(bool printDefaults); //!< setup unit cell and basis modes for perturbations
@@ -100,6 +102,13 @@ private:
 	//!Run supercell calculation for specified perturbation (using fnamePattern to load/restore required properties)
 	void processPerturbation(const Perturbation& pert, string fnamePattern);
 	
+	string perturbationFilePattern(int iPert) const; //!< filename pattern (containing $VAR) for files of specified perturbation
+	bool perturbationDone(int iPert) const; //!< whether results (dforces) of specified perturbation have been saved completely
+	
+	//!Run supercell calculations for perturbations without saved results, concurrently in each process group.
+	//!The perturbations are assigned to groups in decreasing order of estimated cost, each to the least loaded group.
+	void runPerturbationsGrouped();
+	
 	//!Set unperturbed state of supercell from unit cell and retrieve unperturbed subspace Hamiltonian at supercell Gamma point (for all bands)
 	std::vector<diagMatrix> setSupState();
 	
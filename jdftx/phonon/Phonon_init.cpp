@@ -20,6 +20,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <phonon/Phonon.h>
 #include <electronic/ElecMinimizer.h>
 #include <electronic/ColumnBundleTransform.h>
+#include <electronic/DFPT.h>
 #include <commands/parser.h>
 #include <core/Units.h>
 
@@ -28,7 +29,7 @@ PhononEverything::PhononEverything(Phonon& phonon) : phonon(phonon)
 }
 
 Phonon::Phonon()
-: dr(0.1), T(298*Kelvin), Fcut(1e-8), rSmooth(1.), iPerturbation(-1), collectPerturbations(false), saveHsub(true), e(*this), eSupTemplate(*this)
+: dr(0.1), T(298*Kelvin), Fcut(1e-8), rSmooth(1.), iPerturbation(-1), collectPerturbations(false), farmPerturbations(false), saveHsub(true), dfpt(false), e(*this), eSupTemplate(*this)
 {
 }
 
@@ -54,6 +55,14 @@ void Phonon::setup(bool printDefaults)
 	//Ensure phonon command specified:
 	if(!sup.length())
 		die("phonon supercell must be specified using the phonon command.\n");
+	if(dfpt)
+	{	if(sup[0]*sup[1]*sup[2] != 1)
+			die("phonon dfpt computes the Gamma-point force matrix, and requires supercell 1 1 1.\n");
+		if(saveHsub)
+			die("phonon dfpt does not compute electron-phonon matrix elements; specify saveHsub no.\n");
+		if(iPerturbation>=0 || collectPerturbations || farmPerturbations)
+			die("phonon dfpt does not use supercell calculations; remove iPerturbation, collectPerturbations and farmPerturbations.\n");
+	}
 	//Check kpoint and supercell compatibility:
 	if(e.eInfo.qnums.size()>1 || e.eInfo.qnums[0].k.length_squared())
 		die("phonon requires a Gamma-centered uniform kpoint mesh.\n");
@@ -73,6 +82,7 @@ void Phonon::setup(bool printDefaults)
 		e.iInfo.species[sp]->constraints.assign(e.iInfo.species[sp]->atpos.size(), constraintFull);
 	e.setup();
 	if(!e.coulombParams.supercell) e.updateSupercell(true); //force supercell generation
+	if(dfpt) DFPT::checkCompatibility(e);
 
 	nSpins = e.eInfo.nSpins();
 	nSpinor = e.eInfo.spinorLength();
@@ -26,7 +26,9 @@ enum PhononMember
 	PM_dr,
 	PM_iPerturbation,
 	PM_collectPerturbations,
+	PM_farmPerturbations,
 	PM_saveHsub,
+	PM_dfpt,
  	PM_T,
 	PM_Fcut,
 	PM_rSmooth,
@@ -38,7 +40,9 @@ EnumStringMap<PhononMember> phononMemberMap
 	PM_dr, "dr",
 	PM_iPerturbation,"iPerturbation",
 	PM_collectPerturbations, "collectPerturbations",
+	PM_farmPerturbations, "farmPerturbations",
 	PM_saveHsub, "saveHsub",
+	PM_dfpt, "dfpt",
 	PM_T, "T",
 	PM_Fcut, "Fcut",
 	PM_rSmooth, "rSmooth"
@@ -67,9 +71,21 @@ struct CommandPhonon : public Command
 			"   Collect results of previous individual supercell calculations.\n"
 			"   Note that this requires all iPerturbation calculations (listed at\n"
 			"   the end of the phonon dry run) to have already completed.\n"
+			"\n+ farmPerturbations\n\n"
+			"   Run all supercell calculations in this job, distributed over the process\n"
+			"   groups specified by command-line option -G, and then collect the results.\n"
+			"   Perturbations are assigned to groups based on their estimated cost, and those\n"
+			"   with previously saved results (dforces) are skipped, so that an interrupted\n"
+			"   calculation can be resumed by simply rerunning it.\n"
 			"\n+ saveHsub yes|no\n\n"
 			"   Whether to compute / save phononHsub: the electron-phonon matrix elements.\n"
 			"   Default: yes.\n"
+			"\n+ dfpt yes|no\n\n"
+			"   Compute the Gamma-point force matrix using linear response (density-functional\n"
+			"   perturbation theory) in the unit cell, instead of frozen-phonon supercell calculations.\n"
+			"   Requires supercell 1 1 1, saveHsub no and symmetries none, and has the same\n"
+			"   restrictions as dfpt in command vibrations (insulators with norm-conserving\n"
+			"   pseudopotentials and semi-local functionals). Default: no.\n"
 			"\n+ T <T>\n\n"
 			"   Temperature (in Kelvins) used for vibrational free energy estimation (default 298).\n"
 			"\n+ Fcut <Fcut>\n\n"
@@ -108,15 +124,29 @@ struct CommandPhonon : public Command
 						throw string("perturbation number must be positive");
 					if(phonon.collectPerturbations)
 						throw string("cannot use iPerturbation in the same calculation as collectPerturbations");
+					if(phonon.farmPerturbations)
+						throw string("cannot use iPerturbation in the same calculation as farmPerturbations");
 					break;
 				case PM_collectPerturbations:
 					phonon.collectPerturbations = true;
 					if(phonon.iPerturbation>=0)
 						throw string("cannot use iPerturbation in the same calculation as collectPerturbations");
+					if(phonon.farmPerturbations)
+						throw string("cannot use farmPerturbations in the same calculation as collectPerturbations");
+					break;
+				case PM_farmPerturbations:
+					phonon.farmPerturbations = true;
+					if(phonon.iPerturbation>=0)
+						throw string("cannot use iPerturbation in the same calculation as farmPerturbations");
+					if(phonon.collectPerturbations)
+						throw string("cannot use farmPerturbations in the same calculation as collectPerturbations");
 					break;
 				case PM_saveHsub:
 					pl.get(phonon.saveHsub, true, boolMap, "saveHsub", true);
 					break;
+				case PM_dfpt:
+					pl.get(phonon.dfpt, false, boolMap, "dfpt", true);
+					break;
 				case PM_T:
 					pl.get(phonon.T, 0., "T", true);
 					phonon.T *= Kelvin;
@@ -141,7 +171,9 @@ struct CommandPhonon : public Command
 		logPrintf(" \\\n\tdr %lg", phonon.dr);
 		if(phonon.iPerturbation>=0) logPrintf(" \\\n\tiPerturbation %d", phonon.iPerturbation+1); //print 1-based index
 		if(phonon.collectPerturbations) logPrintf(" \\\n\tcollectPerturbations");
+		if(phonon.farmPerturbations) logPrintf(" \\\n\tfarmPerturbations");
 		logPrintf(" \\\n\tsaveHsub %s", boolMap.getString(phonon.saveHsub));
+		logPrintf(" \\\n\tdfpt %s", boolMap.getString(phonon.dfpt));
 		logPrintf(" \\\n\tT %lg", phonon.T/Kelvin);
 		logPrintf(" \\\n\tFcut %lg", phonon.Fcut);
 		logPrintf(" \\\n\trSmooth %lg", phonon.rSmooth);
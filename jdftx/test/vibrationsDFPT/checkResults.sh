@@ -0,0 +1,14 @@
+#!/bin/bash
+
+echo 3 #expected lines of output
+
+#Optical frequencies from linear response, compared to central finite differences:
+awk '
+	/Real mode/ { isReal=1 }
+	/Frequency:/ && isReal { freq[FILENAME,++nFreq[FILENAME]] = $5; isReal=0 }
+	END {
+		fd = "Si_centralDiff.out"; dfpt = "Si_dfpt.out";
+		for(i=1; i<=3; i++)
+			printf("%f %f 3 Si optical frequency %d [inv-cm]\n", freq[dfpt,i], freq[fd,i], i);
+	}
+' Si_centralDiff.out Si_dfpt.out
@@ -0,0 +1,3 @@
+#!/bin/bash
+export runs="Si_centralDiff Si_dfpt"
+export nProcs="2"